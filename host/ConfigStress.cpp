@@ -0,0 +1,129 @@
+// Writes random values to the configuration store on the flash mock, cuts the power at random points of the writes and
+// checks after every reboot that each key has either its old or its new value. Prints the erase count of every sector.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <optional>
+#include <random>
+#include <vector>
+
+#include "ConfigStore.h"
+#include "FlashMock.h"
+
+namespace
+{
+    constexpr std::uint16_t KEY_COUNT{8};
+    constexpr std::size_t MAX_TEST_VALUE_SIZE{300};
+
+    using Value = std::vector<std::uint8_t>;
+
+    bool isEqual(etl::span<const std::uint8_t> stored, const Value& expected)
+    {
+        return (stored.size() == expected.size()) && (std::memcmp(stored.data(), expected.data(), expected.size()) == 0);
+    }
+
+    void printUsage(const char* name)
+    {
+        std::fprintf(stderr,
+            "Usage: %s [-n writes] [-p percent] [-c sectors] [-s seed]\n"
+            "  -n  number of writes (default 100000)\n"
+            "  -p  probability of a power failure during a write in percent (default 5)\n"
+            "  -c  number of flash sectors (default 4)\n"
+            "  -s  seed of the random values (default 1)\n", name);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    unsigned long writes{100000};
+    unsigned long failurePercent{5};
+    unsigned long sectorCount{4};
+    unsigned long seed{1};
+
+    for(int i = 1; i < argc; i++)
+    {
+        unsigned long* const option{(std::strcmp(argv[i], "-n") == 0) ? &writes :
+                                    (std::strcmp(argv[i], "-p") == 0) ? &failurePercent :
+                                    (std::strcmp(argv[i], "-c") == 0) ? &sectorCount :
+                                    (std::strcmp(argv[i], "-s") == 0) ? &seed : nullptr};
+        if((option == nullptr) || (i + 1 >= argc))
+        {
+            printUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        *option = std::strtoul(argv[++i], nullptr, 0);
+    }
+    if((sectorCount < 2) || (failurePercent > 100))
+    {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::mt19937 random{static_cast<std::mt19937::result_type>(seed)};
+    FlashMock flash{sectorCount};
+    std::vector<Value> expected(KEY_COUNT);
+    unsigned long powerFailures{0};
+    unsigned long failedWrites{0};
+    unsigned long errors{0};
+
+    std::optional<ConfigStore> store{std::in_place, flash};
+    store->initialize();
+    for(unsigned long n = 0; n < writes; n++)
+    {
+        const std::uint16_t key{static_cast<std::uint16_t>(random() % KEY_COUNT)};
+        Value value(((random() % 8) == 0) ? 0 : (random() % MAX_TEST_VALUE_SIZE) + 1); // some deletes
+        for(std::uint8_t& byte : value)
+        {
+            byte = static_cast<std::uint8_t>(random());
+        }
+
+        const bool powerFailure{(random() % 100) < failurePercent};
+        if(powerFailure)
+        {
+            flash.schedulePowerFailure(random() % (FlashInterface::SECTOR_SIZE + MAX_TEST_VALUE_SIZE));
+        }
+
+        const bool written{store->write(key, value)};
+        if(!flash.isPowerLost())
+        {
+            flash.powerOn();
+            if(written)
+            {
+                expected[key] = value;
+            }
+            else
+            {
+                failedWrites++; // the value did not fit into an empty sector
+            }
+            continue;
+        }
+
+        // reboot, the interrupted write is either complete or not done at all
+        powerFailures++;
+        flash.powerOn();
+        store.emplace(flash);
+        store->initialize();
+        if(isEqual(store->read(key), value))
+        {
+            expected[key] = value;
+        }
+        for(std::uint16_t k = 0; k < KEY_COUNT; k++)
+        {
+            if(!isEqual(store->read(k), expected[k]))
+            {
+                std::printf("write %lu: key %u has a wrong value after the power failure\n", n, k);
+                errors++;
+                expected[k].assign(store->read(k).begin(), store->read(k).end());
+            }
+        }
+    }
+
+    std::printf("writes: %lu, power failures: %lu, failed writes: %lu, compactions: %lu, errors: %lu\n",
+                writes, powerFailures, failedWrites, static_cast<unsigned long>(store->getSequence()), errors);
+    for(std::size_t sector = 0; sector < sectorCount; sector++)
+    {
+        std::printf("  sector %zu: %lu erases\n", sector, static_cast<unsigned long>(flash.getEraseCount(sector)));
+    }
+    return (errors == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
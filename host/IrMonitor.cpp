@@ -0,0 +1,566 @@
+// Prints the events (and optionally the raw durations) received from the device, the Linux counterpart of usbtest.py.
+// With -m the device is simulated: the trace is decoded by the host build of the decoder and the reports are passed
+// through the mock transport, so the client can be tried without a device.
+
+#include <algorithm>
+#include <atomic>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <vector>
+#include <pthread.h>
+
+#include "ClockSync.h"
+#include "EventFilter.h"
+#include "GestureMatcher.h"
+#include "HostHal.h"
+#include "IrClient.h"
+#include "IrDecoder.h"
+#include "KeyTracker.h"
+#include "MockTransport.h"
+#include "TraceFile.h"
+#ifdef HAVE_LIBUSB
+#include "LibUsbTransport.h"
+#endif
+
+namespace
+{
+    constexpr const char* PROTOCOL_NAMES[]{"NEC", "NEC extended", "Samsung", "Sony", "RC5", "RC6"};
+    constexpr std::uint32_t FRAME_GAP_US{8000};
+    constexpr std::size_t MAX_EVENTS_PER_REPORT{15};
+    constexpr std::size_t MAX_EVENTS_PER_PACKET{3}; // one report per packet of the event endpoint
+    constexpr std::size_t MAX_KEYS_PER_REPORT{21};
+    constexpr std::size_t MAX_KEYS_PER_PACKET{5};
+    constexpr std::size_t MAX_GESTURES_PER_REPORT{31};
+    constexpr std::size_t MAX_GESTURES_PER_PACKET{7};
+    constexpr std::uint64_t RELEASE_WAIT_US{1000000}; // after the trace, until the last key is released
+    constexpr std::size_t MAX_RAW_PER_REPORT{48};
+    constexpr int CLOCK_UPDATE_S{5};
+
+    /// clock (optional): print the host time of the event too
+    void printEvent(const IrClient::Event& event, const ClockSync* clock)
+    {
+        const char* const protocol{(event.protocol < std::size(PROTOCOL_NAMES)) ? PROTOCOL_NAMES[event.protocol] : "unknown"};
+        std::printf("[%10.6f] protocol: %s, address: 0x%02X, command: 0x%02X, code: 0x%08lX, repeated: %u", event.timestampUs / 1e6,
+            protocol, event.address, event.command, static_cast<unsigned long>(event.code), event.repeated);
+        if((clock != nullptr) && clock->isValid())
+        {
+            std::printf(", host time: %.6f (±%ld µs)", clock->toHostUs(event.timestampUs) / 1e6, static_cast<long>(clock->getUncertaintyUs()));
+        }
+        std::printf("\n");
+    }
+
+    void printKey(const IrClient::KeyEvent& event, const ClockSync* clock)
+    {
+        constexpr const char* TYPE_NAMES[]{"", "press", "repeat", "release"};
+        const std::size_t type{static_cast<std::size_t>(event.type)};
+        const char* const protocol{(event.protocol < std::size(PROTOCOL_NAMES)) ? PROTOCOL_NAMES[event.protocol] : "unknown"};
+        std::printf("[%10.6f] %-7s protocol: %s, address: 0x%02X, command: 0x%02X, repeats: %u", event.timestampUs / 1e6,
+            (type < std::size(TYPE_NAMES)) ? TYPE_NAMES[type] : "unknown", protocol, event.address, event.command, event.repeatCount);
+        if((clock != nullptr) && clock->isValid())
+        {
+            std::printf(", host time: %.6f (±%ld µs)", clock->toHostUs(event.timestampUs) / 1e6, static_cast<long>(clock->getUncertaintyUs()));
+        }
+        std::printf("\n");
+    }
+
+    void printGesture(const IrClient::GestureEvent& event, const ClockSync* clock)
+    {
+        std::printf("[%10.6f] gesture %u", event.timestampUs / 1e6, event.id);
+        if((clock != nullptr) && clock->isValid())
+        {
+            std::printf(", host time: %.6f (±%ld µs)", clock->toHostUs(event.timestampUs) / 1e6, static_cast<long>(clock->getUncertaintyUs()));
+        }
+        std::printf("\n");
+    }
+
+    /// Gesture of the command line: id,gap,hold,key[,key...] with key protocol:address:command (hex), L after a key for a long press
+    bool parseGesture(const char* text, GestureEntry& entry)
+    {
+        entry = GestureEntry{};
+        unsigned int id;
+        unsigned int gapMs;
+        unsigned int holdMs;
+        int used;
+        if(std::sscanf(text, "%u,%u,%u%n", &id, &gapMs, &holdMs, &used) != 3)
+        {
+            return false;
+        }
+        entry.id = static_cast<std::uint16_t>(id);
+        entry.maxGapMs = static_cast<std::uint16_t>(gapMs);
+        entry.holdMs = static_cast<std::uint16_t>(holdMs);
+
+        text += used;
+        while((*text == ',') && (entry.stepCount < GestureEntry::MAX_STEPS))
+        {
+            unsigned int protocol;
+            unsigned int address;
+            unsigned int command;
+            if(std::sscanf(text, ",%x:%x:%x%n", &protocol, &address, &command, &used) != 3)
+            {
+                return false;
+            }
+            text += used;
+            if(*text == 'L')
+            {
+                entry.longSteps |= static_cast<std::uint8_t>(1u << entry.stepCount);
+                text++;
+            }
+            entry.keys[entry.stepCount++] = GestureKey{static_cast<IrProtocolId>(protocol), static_cast<std::uint8_t>(command), static_cast<std::uint16_t>(address)};
+        }
+        return (*text == '\0') && (entry.stepCount > 0);
+    }
+
+    /// Code of the command line: protocol:address:command (hex), protocol ff for every protocol
+    bool parseFilter(const char* text, UsbFilterEntry& entry)
+    {
+        unsigned int protocol;
+        unsigned int address;
+        unsigned int command;
+        int used;
+        if((std::sscanf(text, "%x:%x:%x%n", &protocol, &address, &command, &used) != 3) || (text[used] != '\0') || (protocol > 0xFF) || (address > 0xFFFF) || (command > 0xFF))
+        {
+            return false;
+        }
+        entry = UsbFilterEntry{static_cast<std::uint8_t>(protocol), static_cast<std::uint8_t>(command), static_cast<std::uint16_t>(address)};
+        return true;
+    }
+
+    void printPulses(const std::vector<IrClient::Pulse>& pulses, bool pulsesLost)
+    {
+        if(pulsesLost)
+        {
+            std::printf("Lost raw pulses\n");
+        }
+        for(const IrClient::Pulse& pulse : pulses)
+        {
+            std::printf("%c%lu ", pulse.mark ? '+' : '-', static_cast<unsigned long>(pulse.durationUs));
+        }
+        std::printf("\n");
+    }
+
+    /// Simulated device: decodes a trace and sends the reports the firmware would send
+    class MockDevice
+    {
+    public:
+        /// eventEndpoint: send the events on the interrupt endpoint like the device does once the host selected it
+        MockDevice(MockTransport& transport, bool eventEndpoint) :
+        transport_{transport},
+        eventEndpoint_{eventEndpoint}
+        {
+            transport_.setControlHandler([this](bool in, std::uint8_t request, std::uint16_t value, std::uint16_t index, std::vector<std::uint8_t>& data)
+            {
+                return handleRequest(in, request, value, index, data);
+            });
+            decoder_.initialize();
+            keyTracker_.setEventHandler(KeyTracker::EventHandler::create<MockDevice, &MockDevice::handleKey>(*this));
+            gestureMatcher_.setEventHandler(GestureMatcher::EventHandler::create<MockDevice, &MockDevice::handleGesture>(*this));
+        }
+
+        void play(const Trace& trace)
+        {
+            HostHal::reset();
+            for(const IrPulse& pulse : trace.pulses)
+            {
+                if(!pulse.mark && (pulse.durationUs >= FRAME_GAP_US)) // idle, end of the frame
+                {
+                    HostHal::advanceTimeUs(FRAME_GAP_US);
+                    source_.signal(etl::span<const IrPulse>{}, HostHal::getTimeUs());
+                    sendReports();
+                    HostHal::advanceTimeUs(pulse.durationUs - FRAME_GAP_US);
+                }
+                else
+                {
+                    HostHal::advanceTimeUs(pulse.durationUs);
+                }
+                source_.signal(etl::span<const IrPulse>{&pulse, 1}, HostHal::getTimeUs());
+                raw_.push_back(IrClient::Pulse{pulse.mark, pulse.durationUs});
+            }
+            source_.signal(etl::span<const IrPulse>{}, HostHal::getTimeUs() + FRAME_GAP_US);
+            sendReports();
+            HostHal::advanceTimeUs(RELEASE_WAIT_US);
+            sendReports();
+        }
+
+    private:
+        class Source final : public EdgeSourceInterface
+        {
+        public:
+            virtual void initialize(PulseHandler pulseHandler) override { pulseHandler_ = pulseHandler; }
+            void signal(etl::span<const IrPulse> pulses, std::uint64_t endTimeUs) { pulseHandler_(pulses, endTimeUs); }
+        private:
+            PulseHandler pulseHandler_{};
+        };
+
+        MockTransport& transport_;
+        const bool eventEndpoint_;
+        const std::int64_t bootTimeUs_{ClockSync::getHostTimeUs()};
+        Source source_{};
+        IrDecoderAll decoder_{source_};
+        KeyTracker keyTracker_{};
+        std::vector<UsbKeyEventEntry> keys_{};
+        std::uint16_t keySequence_{0};
+        GestureMatcher gestureMatcher_{keyTracker_};
+        std::vector<GestureEntry> gestures_{};
+        std::vector<UsbGestureEntry> gestureEvents_{};
+        std::uint16_t gestureSequence_{0};
+        EventFilter filter_{};
+        std::uint16_t mode_{UsbReportMode::EVENTS};
+        std::uint16_t sequence_{0};
+        std::uint8_t rawSequence_{0};
+        std::vector<IrClient::Pulse> raw_{};
+
+        void sendReports()
+        {
+            std::vector<std::uint8_t> report;
+            if((mode_ & UsbReportMode::RAW) != 0)
+            {
+                for(std::size_t start = 0; start < raw_.size(); start += MAX_RAW_PER_REPORT)
+                {
+                    const std::vector<IrClient::Pulse> pulses{raw_.begin() + start, raw_.begin() + std::min(raw_.size(), start + MAX_RAW_PER_REPORT)};
+                    const UsbRawReportHeader header{static_cast<std::uint8_t>(UsbReportType::RAW), static_cast<std::uint8_t>(pulses.size()),
+                                                    static_cast<std::uint8_t>(pulses.front().mark ? UsbRawFlags::FIRST_IS_MARK : 0), rawSequence_++};
+                    append(report, header);
+                    IrClient::encodeDurations(pulses, report);
+                }
+            }
+            raw_.clear();
+
+            IrDecoder::Data data;
+            std::vector<UsbEventReportEntry> entries;
+            while(decoder_.getData(data))
+            {
+                // the loop of the firmware ran the tasks until this frame, e.g. a key without repeat was released before it
+                keyTracker_.task(data.timestampUs);
+                gestureMatcher_.task(data.timestampUs);
+                keyTracker_.add(data);
+                if(!filter_.accept(data.protocol, data.address, data.command))
+                {
+                    continue;
+                }
+                entries.push_back(UsbEventReportEntry{sequence_++, static_cast<std::uint8_t>(data.protocol),
+                                                      static_cast<std::uint8_t>(data.repeated ? UsbEventFlags::REPEATED : 0),
+                                                      static_cast<std::uint32_t>(data.timestampUs), data.code, data.address, data.command, 0});
+            }
+            keyTracker_.task(HostHal::getTimeUs());
+            gestureMatcher_.task(HostHal::getTimeUs());
+
+            transport_.inject(report.data(), report.size());
+            if((mode_ & UsbReportMode::EVENTS) != 0)
+            {
+                sendEntries(UsbReportType::EVENTS, entries, eventEndpoint_ ? MAX_EVENTS_PER_PACKET : MAX_EVENTS_PER_REPORT);
+            }
+            if((mode_ & UsbReportMode::KEYS) != 0)
+            {
+                sendEntries(UsbReportType::KEYS, keys_, eventEndpoint_ ? MAX_KEYS_PER_PACKET : MAX_KEYS_PER_REPORT);
+            }
+            keys_.clear();
+            if((mode_ & UsbReportMode::GESTURES) != 0)
+            {
+                sendEntries(UsbReportType::GESTURES, gestureEvents_, eventEndpoint_ ? MAX_GESTURES_PER_PACKET : MAX_GESTURES_PER_REPORT);
+            }
+            gestureEvents_.clear();
+        }
+
+        template<typename Entry>
+        void sendEntries(UsbReportType type, const std::vector<Entry>& entries, std::size_t maxCount)
+        {
+            std::vector<std::uint8_t> report;
+            for(std::size_t start = 0; start < entries.size(); start += maxCount)
+            {
+                const std::size_t count{std::min(entries.size() - start, maxCount)};
+                report.clear();
+                append(report, UsbEventReportHeader{static_cast<std::uint8_t>(type), static_cast<std::uint8_t>(count), 0});
+                for(std::size_t i = start; i < start + count; i++)
+                {
+                    append(report, entries[i]);
+                }
+                transport_.inject(report.data(), report.size(), eventEndpoint_ ? IrTransport::EVENT_IN_ENDPOINT : IrTransport::BULK_IN_ENDPOINT);
+            }
+        }
+
+        void handleKey(const KeyTracker::Event& event)
+        {
+            if(filter_.accept(event.protocol, event.address, event.command))
+            {
+                keys_.push_back(UsbKeyEventEntry{keySequence_++, static_cast<std::uint8_t>(event.type), static_cast<std::uint8_t>(event.protocol),
+                                                 event.address, event.command, event.repeatCount, static_cast<std::uint32_t>(event.timestampUs)});
+            }
+            gestureMatcher_.add(event);
+        }
+
+        void handleGesture(const GestureMatcher::Event& event)
+        {
+            gestureEvents_.push_back(UsbGestureEntry{gestureSequence_++, event.id, static_cast<std::uint32_t>(event.timestampUs)});
+        }
+
+        template<typename T>
+        static void append(std::vector<std::uint8_t>& report, const T& value)
+        {
+            // resize + memcpy instead of insert from a byte pointer, GCC 12 warns about the bounds of the latter
+            const std::size_t offset{report.size()};
+            report.resize(offset + sizeof(value));
+            std::memcpy(report.data() + offset, &value, sizeof(value));
+        }
+
+        bool handleRequest(bool in, std::uint8_t request, std::uint16_t value, std::uint16_t index, std::vector<std::uint8_t>& data)
+        {
+            switch(static_cast<VendorRequest>(request))
+            {
+            case VendorRequest::GET_CLOCK:
+            {
+                // the simulated device booted when the mock was created, its clock runs with the one of the host
+                if(!in) return false;
+                const std::uint64_t nowUs{static_cast<std::uint64_t>(ClockSync::getHostTimeUs() - bootTimeUs_)};
+                data.clear();
+                append(data, UsbClockReport{nowUs, nowUs - nowUs % 1000, 1000000, static_cast<std::uint16_t>((nowUs / 1000) & 0x7FF), 0});
+                return true;
+            }
+            case VendorRequest::SET_MODE:
+                mode_ = value;
+                return !in;
+            case VendorRequest::SET_CONFIG:
+                // the simulated device keeps its interfaces
+                if(!in && (value == static_cast<std::uint16_t>(ConfigKey::USB_PERSONALITY))) return data.size() == sizeof(UsbPersonality);
+                // only the gestures are used by the simulation, like on the device the whole table is replaced
+                if(in || (value != static_cast<std::uint16_t>(ConfigKey::GESTURES)) || ((data.size() % sizeof(GestureEntry)) != 0)) return false;
+                gestures_.resize(data.size() / sizeof(GestureEntry));
+                std::memcpy(gestures_.data(), data.data(), data.size());
+                gestureMatcher_.load(etl::span<const GestureEntry>{gestures_.data(), gestures_.size()});
+                return true;
+            case VendorRequest::SET_FILTER:
+                if(in || ((data.size() % sizeof(UsbFilterEntry)) != 0)) return false;
+                if(data.empty())
+                {
+                    filter_.clear();
+                    return true;
+                }
+                return filter_.load(etl::span<const UsbFilterEntry>{reinterpret_cast<const UsbFilterEntry*>(data.data()), data.size() / sizeof(UsbFilterEntry)});
+            case VendorRequest::GET_STATISTICS:
+            {
+                if(!in || (index != 0)) return false;
+                const IrDecoder::Statistics& statistics{decoder_.getStatistics()};
+                const UsbStatisticsReport report{statistics.frames, statistics.repeats, statistics.invalidHeader, statistics.invalidBit,
+                                                 statistics.invalidChecksum, decoder_.getOverflowCount(), 0, 0, statistics.corrected};
+                data.clear();
+                append(data, report);
+                return true;
+            }
+            default:
+                return false;
+            }
+        }
+    };
+
+    void printUsage(const char* name)
+    {
+        std::fprintf(stderr,
+            "Usage: %s [-r] [-k] [-g gesture]... [-f code]... [-i] [-s] [-p personality] [-m trace]\n"
+            "  -r  print the raw durations too\n"
+            "  -k  print key press / repeat / release events instead of every frame\n"
+            "  -g  store a gesture on the device and print it when recognized: id,gap ms,hold ms,key[,key...]\n"
+            "      with up to 4 keys protocol:address:command (hex), L after a key makes it a long press\n"
+            "  -f  report only the events of this code (protocol:address:command hex, protocol ff for any), the device drops the others\n"
+            "  -i  receive the events on the interrupt endpoint (1 ms polling) instead of the bulk stream\n"
+            "  -s  synchronize the clocks and print the host time (steady clock) of the events\n"
+            "  -p  let the device enumerate as \"vendor\" (this interface) or \"irtoy\" (IR Toy for the Linux kernel driver ir_toy) and exit\n"
+            "  -m  simulate the device with the trace instead of using a real one\n", name);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    bool raw{false};
+    bool keys{false};
+    bool eventEndpoint{false};
+    bool synchronize{false};
+    std::vector<GestureEntry> gestures;
+    std::vector<UsbFilterEntry> filter;
+    const char* personality{nullptr};
+    const char* mockTrace{nullptr};
+    for(int i = 1; i < argc; i++)
+    {
+        if(std::strcmp(argv[i], "-r") == 0)
+        {
+            raw = true;
+        }
+        else if(std::strcmp(argv[i], "-k") == 0)
+        {
+            keys = true;
+        }
+        else if((std::strcmp(argv[i], "-g") == 0) && (i + 1 < argc))
+        {
+            GestureEntry entry;
+            if(!parseGesture(argv[++i], entry))
+            {
+                std::fprintf(stderr, "Invalid gesture %s\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+            gestures.push_back(entry);
+        }
+        else if((std::strcmp(argv[i], "-f") == 0) && (i + 1 < argc))
+        {
+            UsbFilterEntry entry;
+            if(!parseFilter(argv[++i], entry))
+            {
+                std::fprintf(stderr, "Invalid code %s\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+            filter.push_back(entry);
+        }
+        else if(std::strcmp(argv[i], "-i") == 0)
+        {
+            eventEndpoint = true;
+        }
+        else if(std::strcmp(argv[i], "-s") == 0)
+        {
+            synchronize = true;
+        }
+        else if((std::strcmp(argv[i], "-p") == 0) && (i + 1 < argc) && ((std::strcmp(argv[i + 1], "vendor") == 0) || (std::strcmp(argv[i + 1], "irtoy") == 0)))
+        {
+            personality = argv[++i];
+        }
+        else if((std::strcmp(argv[i], "-m") == 0) && (i + 1 < argc))
+        {
+            mockTrace = argv[++i];
+        }
+        else
+        {
+            printUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // the device stores the personality and re-enumerates with it
+    const auto setPersonality = [personality](IrClient& client)
+    {
+        const UsbPersonality value{(std::strcmp(personality, "irtoy") == 0) ? UsbPersonality::IR_TOY : UsbPersonality::VENDOR};
+        if(!client.setConfig(static_cast<std::uint16_t>(ConfigKey::USB_PERSONALITY), std::vector<std::uint8_t>{static_cast<std::uint8_t>(value)}))
+        {
+            std::fprintf(stderr, "Unable to change the personality\n");
+            return EXIT_FAILURE;
+        }
+        std::printf("The device enumerates as %s now\n", personality);
+        return EXIT_SUCCESS;
+    };
+
+    const auto setupClient = [raw, keys, &gestures, &filter](IrClient& client, const ClockSync* clock)
+    {
+        client.setEventHandler([clock](const IrClient::Event& event) { printEvent(event, clock); });
+        client.setKeyHandler([clock](const IrClient::KeyEvent& event) { printKey(event, clock); });
+        client.setGestureHandler([clock](const IrClient::GestureEvent& event) { printGesture(event, clock); });
+        client.setRawHandler(&printPulses);
+        client.setLossHandler([](std::uint16_t lostCount, std::uint16_t droppedCount)
+        {
+            std::printf("Lost %u event(s), %u dropped in total\n", lostCount, droppedCount);
+        });
+        if(!gestures.empty())
+        {
+            const std::uint8_t* const bytes{reinterpret_cast<const std::uint8_t*>(gestures.data())};
+            if(!client.setConfig(static_cast<std::uint16_t>(ConfigKey::GESTURES), std::vector<std::uint8_t>{bytes, bytes + gestures.size() * sizeof(GestureEntry)}))
+            {
+                return false;
+            }
+        }
+        if(!client.setFilter(filter)) // an empty filter removes the one of a previous run
+        {
+            return false;
+        }
+        const std::uint16_t mode{static_cast<std::uint16_t>((keys ? UsbReportMode::KEYS : UsbReportMode::EVENTS) | UsbReportMode::KEYBOARD | (raw ? UsbReportMode::RAW : 0) |
+                                                            (gestures.empty() ? 0 : UsbReportMode::GESTURES))};
+        return client.setMode(mode) && client.start();
+    };
+
+    if(mockTrace != nullptr)
+    {
+        Trace trace;
+        if(!loadTrace(mockTrace, trace))
+        {
+            return EXIT_FAILURE;
+        }
+
+        MockTransport transport;
+        MockDevice device{transport, eventEndpoint};
+        IrClient client{transport};
+        ClockSync clock{client};
+        if(personality != nullptr)
+        {
+            return setPersonality(client);
+        }
+        if((synchronize && !clock.update()) || !setupClient(client, synchronize ? &clock : nullptr))
+        {
+            return EXIT_FAILURE;
+        }
+        device.play(trace);
+        transport.flush();
+
+        UsbStatisticsReport statistics;
+        if(client.getStatistics(0, statistics))
+        {
+            std::printf("frames: %lu, repeats: %lu, rejected: %lu\n", static_cast<unsigned long>(statistics.frames), static_cast<unsigned long>(statistics.repeats),
+                static_cast<unsigned long>(statistics.invalidHeader + statistics.invalidBit + statistics.invalidChecksum));
+        }
+        return EXIT_SUCCESS;
+    }
+
+#ifdef HAVE_LIBUSB
+    // the transport thread inherits the blocked signal, so only the main thread handles Ctrl+C
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    LibUsbTransport transport;
+    if(personality != nullptr) // the control requests are also available in the IR Toy personality
+    {
+        if(!transport.open(LibUsbTransport::VID, LibUsbTransport::PID) && !transport.open(LibUsbTransport::IR_TOY_VID, LibUsbTransport::IR_TOY_PID))
+        {
+            std::fprintf(stderr, "Unable to open the device\n");
+            return EXIT_FAILURE;
+        }
+        IrClient client{transport};
+        return setPersonality(client);
+    }
+    if(!transport.open(LibUsbTransport::VID, LibUsbTransport::PID, eventEndpoint))
+    {
+        std::fprintf(stderr, "Unable to open the device\n");
+        return EXIT_FAILURE;
+    }
+    IrClient client{transport};
+    ClockSync clock{client};
+    if(synchronize && !clock.update())
+    {
+        std::fprintf(stderr, "Unable to read the clock of the device\n");
+        return EXIT_FAILURE;
+    }
+    const pthread_t mainThread{pthread_self()};
+    std::atomic<bool> failed{false};
+    client.setErrorHandler([mainThread, &failed](IrTransport::Error error) // ends the wait below like Ctrl+C
+    {
+        std::fprintf(stderr, (error == IrTransport::Error::DISCONNECTED) ? "Device disconnected\n" : "Receiving from the device failed\n");
+        failed = true;
+        pthread_kill(mainThread, SIGTERM);
+    });
+    if(!setupClient(client, synchronize ? &clock : nullptr))
+    {
+        std::fprintf(stderr, "Unable to start the device\n");
+        return EXIT_FAILURE;
+    }
+    std::printf("Device opened, waiting for packets...\n");
+
+    // new samples every few seconds follow the drift and tighten the bounds
+    const timespec timeout{CLOCK_UPDATE_S, 0};
+    while(sigtimedwait(&signals, nullptr, synchronize ? &timeout : nullptr) < 0)
+    {
+        clock.update(4);
+    }
+    client.stop();
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+#else
+    std::fprintf(stderr, "Built without libusb, only -m is available\n");
+    return EXIT_FAILURE;
+#endif
+}
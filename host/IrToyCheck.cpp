@@ -0,0 +1,368 @@
+// Checks the IR Toy personality against the Linux kernel driver ir_toy: a simulated device runs the IrToyProtocol of
+// the firmware behind the mock transport, the other side does what the driver does (reset, version and sample mode
+// commands, every packet received while a command waits is its reply, the others are split in samples which
+// alternate between mark and space, 0xFFFF ends the frame). The traces are replayed through it and the received
+// durations are compared with the trace.
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "IrToyProtocol.h"
+#include "MockTransport.h"
+#include "TraceFile.h"
+
+namespace
+{
+    constexpr std::uint32_t FRAME_GAP_US{8000};        // idle time of the capture, see TraceReplay
+    constexpr std::uint8_t DATA_IN_ENDPOINT{0x82};
+    constexpr std::uint32_t MAX_DEVIATION_US{11};      // half a tick
+    constexpr auto REPLY_TIMEOUT{std::chrono::milliseconds{500}};
+    constexpr unsigned int MIN_FIRMWARE_VERSION{20};   // the driver refuses older IR Toy firmware
+
+    /// The firmware side, polled by the main thread like IrToySerial::task() by the USB task
+    class SimulatedIrToy
+    {
+    public:
+        explicit SimulatedIrToy(MockTransport& transport) :
+        transport_{transport}
+        {}
+
+        /// Capture side, an empty span ends the frame
+        void add(const IrPulse* pulses, std::size_t count)
+        {
+            if(count == 0)
+            {
+                pulses_.push_back(std::nullopt);
+            }
+            pulses_.insert(pulses_.end(), pulses, pulses + count);
+            poll();
+        }
+
+        void poll()
+        {
+            for(const std::vector<std::uint8_t>& data : transport_.takeWritten())
+            {
+                commands_.insert(commands_.end(), data.begin(), data.end());
+            }
+            while(!protocol_.hasReply() && !commands_.empty())
+            {
+                protocol_.receive(commands_.front());
+                commands_.pop_front();
+            }
+
+            // the samples are sent when full, so the pulses are taken until one does not fit
+            while(true)
+            {
+                while(!pulses_.empty() && (pulses_.front() ? protocol_.add(*pulses_.front()) : protocol_.endFrame()))
+                {
+                    pulses_.pop_front();
+                }
+                const etl::span<const std::uint8_t> packet{protocol_.getPacket()};
+                if(packet.empty())
+                {
+                    return;
+                }
+                transport_.inject(packet.data(), packet.size(), DATA_IN_ENDPOINT);
+                protocol_.consumePacket();
+            }
+        }
+
+    private:
+        MockTransport& transport_;
+        IrToyProtocol protocol_{};
+        std::deque<std::uint8_t> commands_{};
+        std::deque<std::optional<IrPulse>> pulses_{};
+    };
+
+    /// The host side with the behavior of the kernel driver
+    class DriverModel
+    {
+    public:
+        using Frame = std::vector<IrPulse>;
+
+        DriverModel(IrTransport& transport, SimulatedIrToy& device) :
+        transport_{transport},
+        device_{device}
+        {}
+
+        /// Reset, read the version and enter the sample mode like the probe of the driver
+        bool setup()
+        {
+            if(!transport_.start([this](std::uint8_t endpoint, const std::uint8_t* data, std::size_t size) { receive(endpoint, data, size); }, nullptr))
+            {
+                return false;
+            }
+
+            static constexpr std::uint8_t RESET[]{0xFF, 0xFF, 0, 0, 0, 0, 0}; // ends a transmission, then resets
+            std::vector<std::uint8_t> reply;
+            if(!command(RESET, sizeof(RESET), false, reply))
+            {
+                return false;
+            }
+
+            if(!command(reinterpret_cast<const std::uint8_t*>("v"), 1, true, reply))
+            {
+                return false;
+            }
+            if((reply.size() != 4) || (reply[0] != 'V'))
+            {
+                return fail("invalid reply to the version command");
+            }
+            const unsigned int firmwareVersion{(reply[2] - '0') * 10u + (reply[3] - '0')};
+            std::printf("hardware version %u, firmware version %u.%u\n", reply[1] - '0', firmwareVersion / 10, firmwareVersion % 10);
+            if(firmwareVersion < MIN_FIRMWARE_VERSION)
+            {
+                return fail("firmware version too old for the driver");
+            }
+
+            if(!command(reinterpret_cast<const std::uint8_t*>("s"), 1, true, reply))
+            {
+                return false;
+            }
+            if((reply.size() != 3) || (reply[0] != 'S'))
+            {
+                return fail("invalid reply to the sample mode command");
+            }
+            std::printf("sample mode protocol %c%c\n", reply[1], reply[2]);
+
+            const std::lock_guard<std::mutex> lock{mutex_};
+            state_ = State::RECEIVE;
+            return true;
+        }
+
+        /// Frames received so far, false if the stream violated the protocol
+        bool takeFrames(std::vector<Frame>& frames)
+        {
+            const std::lock_guard<std::mutex> lock{mutex_};
+            frames = std::move(frames_);
+            frames_.clear();
+            return error_ == nullptr;
+        }
+
+        const char* getError() const { return error_; }
+
+    private:
+        enum class State
+        {
+            IDLE,
+            COMMAND,
+            RECEIVE,
+        };
+
+        IrTransport& transport_;
+        SimulatedIrToy& device_;
+        std::mutex mutex_{};
+        std::condition_variable replied_{};
+        State state_{State::IDLE};
+        std::vector<std::uint8_t> reply_{};
+        bool replyValid_{false};
+        bool pulse_{true};            ///< Level of the next sample
+        Frame frame_{};
+        std::vector<Frame> frames_{};
+        const char* error_{nullptr};
+
+        bool fail(const char* error)
+        {
+            const std::lock_guard<std::mutex> lock{mutex_};
+            error_ = error;
+            return false;
+        }
+
+        bool command(const std::uint8_t* data, std::size_t size, bool expectReply, std::vector<std::uint8_t>& reply)
+        {
+            {
+                const std::lock_guard<std::mutex> lock{mutex_};
+                state_ = expectReply ? State::COMMAND : State::IDLE;
+                replyValid_ = false;
+            }
+            transport_.write(data, size);
+            device_.poll();
+            if(!expectReply)
+            {
+                return true;
+            }
+
+            std::unique_lock<std::mutex> lock{mutex_};
+            if(!replied_.wait_for(lock, REPLY_TIMEOUT, [this]() { return replyValid_; }))
+            {
+                error_ = "no reply to a command";
+                return false;
+            }
+            reply = reply_;
+            return true;
+        }
+
+        void receive(std::uint8_t endpoint, const std::uint8_t* data, std::size_t size)
+        {
+            const std::lock_guard<std::mutex> lock{mutex_};
+            if(endpoint != DATA_IN_ENDPOINT)
+            {
+                error_ = "data on an unexpected endpoint";
+                return;
+            }
+
+            switch(state_)
+            {
+            case State::COMMAND: // the whole packet is the reply
+                reply_.assign(data, data + size);
+                replyValid_ = true;
+                replied_.notify_all();
+                break;
+            case State::RECEIVE:
+                if((size % 2) != 0) // the driver decodes every packet on its own
+                {
+                    error_ = "sample split between packets";
+                    return;
+                }
+                for(std::size_t i = 0; i < size; i += 2)
+                {
+                    const std::uint16_t sample{static_cast<std::uint16_t>((data[i] << 8) | data[i + 1])};
+                    if(sample == IrToyProtocol::END_OF_FRAME)
+                    {
+                        // the driver toggles the level for it too, so it must be in the place of a space
+                        if(pulse_)
+                        {
+                            error_ = "end of frame in the place of a mark";
+                            return;
+                        }
+                        frames_.push_back(std::move(frame_));
+                        frame_.clear();
+                    }
+                    else
+                    {
+                        frame_.push_back(IrPulse{IrToyProtocol::toUs(sample), pulse_});
+                    }
+                    pulse_ = !pulse_;
+                }
+                break;
+            default:
+                error_ = "data without a command";
+                break;
+            }
+        }
+    };
+
+    /// Frames as the capture sees them: from the first mark to the last one, split at the idle time
+    std::vector<DriverModel::Frame> splitFrames(const Trace& trace)
+    {
+        std::vector<DriverModel::Frame> frames{1};
+        for(const IrPulse& pulse : trace.pulses)
+        {
+            if(!pulse.mark && (pulse.durationUs >= FRAME_GAP_US))
+            {
+                if(!frames.back().empty())
+                {
+                    frames.emplace_back();
+                }
+            }
+            else if(pulse.mark || !frames.back().empty())
+            {
+                frames.back().push_back(pulse);
+            }
+        }
+        for(DriverModel::Frame& frame : frames) // the trailing space is replaced by the end of the frame
+        {
+            if(!frame.empty() && !frame.back().mark)
+            {
+                frame.pop_back();
+            }
+        }
+        if(frames.back().empty())
+        {
+            frames.pop_back();
+        }
+        return frames;
+    }
+
+    bool check(const Trace& trace)
+    {
+        MockTransport transport;
+        SimulatedIrToy device{transport};
+        DriverModel driver{transport, device};
+        if(!driver.setup())
+        {
+            std::printf("%s: setup failed: %s\n", trace.name.c_str(), driver.getError());
+            return false;
+        }
+
+        // one pulse per edge, the capture signals the idle time before the long space is complete
+        for(const IrPulse& pulse : trace.pulses)
+        {
+            if(!pulse.mark && (pulse.durationUs >= FRAME_GAP_US))
+            {
+                device.add(nullptr, 0);
+            }
+            device.add(&pulse, 1);
+        }
+        device.add(nullptr, 0);
+        transport.flush();
+
+        std::vector<DriverModel::Frame> frames;
+        if(!driver.takeFrames(frames))
+        {
+            std::printf("%s: invalid stream: %s\n", trace.name.c_str(), driver.getError());
+            return false;
+        }
+
+        const std::vector<DriverModel::Frame> expected{splitFrames(trace)};
+        if(frames.size() != expected.size())
+        {
+            std::printf("%s: %zu frames received, %zu expected\n", trace.name.c_str(), frames.size(), expected.size());
+            return false;
+        }
+        std::size_t samples{0};
+        std::uint32_t maxDeviationUs{0};
+        for(std::size_t i = 0; i < frames.size(); i++)
+        {
+            if(frames[i].size() != expected[i].size())
+            {
+                std::printf("%s: frame %zu has %zu pulses, %zu expected\n", trace.name.c_str(), i, frames[i].size(), expected[i].size());
+                return false;
+            }
+            for(std::size_t j = 0; j < frames[i].size(); j++)
+            {
+                const IrPulse& received{frames[i][j]};
+                const IrPulse& sent{expected[i][j]};
+                const std::uint32_t deviationUs{(received.durationUs > sent.durationUs) ? received.durationUs - sent.durationUs : sent.durationUs - received.durationUs};
+                if((received.mark != sent.mark) || (deviationUs > MAX_DEVIATION_US))
+                {
+                    std::printf("%s: frame %zu pulse %zu: %s %lu µs received, %s %lu µs expected\n", trace.name.c_str(), i, j, received.mark ? "mark" : "space",
+                        static_cast<unsigned long>(received.durationUs), sent.mark ? "mark" : "space", static_cast<unsigned long>(sent.durationUs));
+                    return false;
+                }
+                maxDeviationUs = (deviationUs > maxDeviationUs) ? deviationUs : maxDeviationUs;
+            }
+            samples += frames[i].size() + 1;
+        }
+        std::printf("%s: %zu frames, %zu samples, max. deviation %lu µs: OK\n", trace.name.c_str(), frames.size(), samples, static_cast<unsigned long>(maxDeviationUs));
+        return true;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if(argc < 2)
+    {
+        std::fprintf(stderr, "Usage: %s trace...\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    bool ok{true};
+    for(int i = 1; i < argc; i++)
+    {
+        Trace trace;
+        if(!loadTrace(argv[i], trace))
+        {
+            return EXIT_FAILURE;
+        }
+        ok = check(trace) && ok;
+    }
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,49 @@
+#include "TraceFile.h"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+bool loadTrace(const char* fileName, Trace& trace)
+{
+    std::ifstream file{fileName};
+    if(!file)
+    {
+        std::fprintf(stderr, "Unable to open %s\n", fileName);
+        return false;
+    }
+
+    trace.name = fileName;
+    std::string line;
+    unsigned int lineNumber{0};
+    while(std::getline(file, line))
+    {
+        lineNumber++;
+        std::istringstream fields{line};
+        unsigned int level;
+        std::uint32_t durationUs;
+        if(line.empty() || (line[0] == '#'))
+        {
+            continue;
+        }
+        if(!(fields >> level >> durationUs) || (level > 1))
+        {
+            std::fprintf(stderr, "%s:%u: invalid line \"%s\"\n", fileName, lineNumber, line.c_str());
+            return false;
+        }
+        if(!trace.pulses.empty() && (trace.pulses.back().mark == (level == 1))) // the levels must alternate
+        {
+            trace.pulses.back().durationUs += durationUs;
+        }
+        else
+        {
+            trace.pulses.push_back(IrPulse{durationUs, level == 1});
+        }
+    }
+
+    // the leading space separates the passes, a trailing one would break the alternation when repeating the trace
+    if((trace.pulses.size() > 1) && !trace.pulses.front().mark && !trace.pulses.back().mark)
+    {
+        trace.pulses.pop_back();
+    }
+    return true;
+}
@@ -0,0 +1,16 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "EdgeSourceInterface.h"
+
+// Trace format: one pulse per line "<level> <duration in µs>", level 1 is a mark (carrier present),
+// 0 a space. Empty lines and lines starting with '#' are ignored.
+
+struct Trace
+{
+    std::string name;
+    std::vector<IrPulse> pulses; ///< Alternating levels
+};
+
+/// Load a trace file, prints the error and returns false if it is invalid
+bool loadTrace(const char* fileName, Trace& trace);
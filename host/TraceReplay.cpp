@@ -0,0 +1,207 @@
+// Replays recorded edge traces through the decoder and reports the decoding results and the throughput.
+//
+// Trace format: one pulse per line "<level> <duration in µs>", level 1 is a mark (carrier present),
+// 0 a space. Empty lines and lines starting with '#' are ignored.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "HostHal.h"
+#include "IrDecoder.h"
+#include "TraceFile.h"
+
+namespace
+{
+    // same idle time as the PIO capture uses to signal the end of a frame
+    constexpr std::uint32_t FRAME_GAP_US{8000};
+
+    class ReplaySource final : public EdgeSourceInterface
+    {
+    public:
+        virtual void initialize(PulseHandler pulseHandler) override
+        {
+            pulseHandler_ = pulseHandler;
+        }
+
+        void deliver(const IrPulse* pulses, std::size_t count, std::uint64_t endTimeUs)
+        {
+            if((count > 0) && pulseHandler_.is_valid())
+            {
+                pulseHandler_(etl::span<const IrPulse>{pulses, count}, endTimeUs);
+            }
+        }
+
+        /// End of frame detected by the capture (idle time reached)
+        void idle(std::uint64_t timeUs)
+        {
+            if(pulseHandler_.is_valid())
+            {
+                pulseHandler_(etl::span<const IrPulse>{}, timeUs);
+            }
+        }
+
+    private:
+        PulseHandler pulseHandler_{};
+    };
+
+    void printData(const IrDecoder::Data& data)
+    {
+        static constexpr const char* PROTOCOL_NAMES[]{"NEC", "NEC extended", "Samsung", "Sony", "RC5", "RC6"};
+        std::printf("  %-12s address: 0x%04X, command: 0x%02X, code: 0x%08lX, repeated: %u\n", PROTOCOL_NAMES[static_cast<std::size_t>(data.protocol)],
+            data.address, data.command, static_cast<unsigned long>(data.code), data.repeated);
+    }
+
+    /// Feed the trace like the capture would, returns the number of decoded events
+    std::size_t replay(const Trace& trace, ReplaySource& source, IrDecoderAll& decoder, bool batched, bool verbose)
+    {
+        std::size_t events{0};
+        IrDecoder::Data data;
+        const auto drain = [&]()
+        {
+            while(decoder.getData(data))
+            {
+                events++;
+                if(verbose) printData(data);
+            }
+        };
+
+        if(!batched) // one pulse per edge interrupt like EdgeSourceGpio
+        {
+            for(const IrPulse& pulse : trace.pulses)
+            {
+                if(!pulse.mark && (pulse.durationUs >= FRAME_GAP_US)) // the idle alarm fires before the space is complete
+                {
+                    HostHal::advanceTimeUs(FRAME_GAP_US);
+                    source.idle(HostHal::getTimeUs());
+                    drain();
+                    HostHal::advanceTimeUs(pulse.durationUs - FRAME_GAP_US);
+                }
+                else
+                {
+                    HostHal::advanceTimeUs(pulse.durationUs);
+                }
+                source.deliver(&pulse, 1, HostHal::getTimeUs());
+                drain();
+            }
+        }
+        else // one batch per frame like EdgeSourcePio
+        {
+            std::size_t batchStart{0};
+            for(std::size_t i = 0; i < trace.pulses.size(); i++)
+            {
+                const IrPulse& pulse{trace.pulses[i]};
+                if(!pulse.mark && (pulse.durationUs >= FRAME_GAP_US))
+                {
+                    const std::uint64_t batchEndUs{HostHal::getTimeUs()};
+                    HostHal::advanceTimeUs(FRAME_GAP_US);
+                    source.deliver(&trace.pulses[batchStart], i - batchStart, batchEndUs);
+                    source.idle(HostHal::getTimeUs());
+                    drain();
+                    HostHal::advanceTimeUs(pulse.durationUs - FRAME_GAP_US);
+                    batchStart = i;
+                }
+                else
+                {
+                    HostHal::advanceTimeUs(pulse.durationUs);
+                }
+            }
+            source.deliver(&trace.pulses[batchStart], trace.pulses.size() - batchStart, HostHal::getTimeUs());
+            drain();
+        }
+        return events;
+    }
+
+    void printUsage(const char* name)
+    {
+        std::fprintf(stderr,
+            "Usage: %s [-n iterations] [-b] [-v] trace...\n"
+            "  -n  number of times every trace is replayed (default 1000)\n"
+            "  -b  deliver the pulses in one batch per frame (PIO capture) instead of per edge\n"
+            "  -v  print the decoded events of the first iteration\n", name);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    unsigned long iterations{1000};
+    bool batched{false};
+    bool verbose{false};
+    std::vector<Trace> traces;
+
+    for(int i = 1; i < argc; i++)
+    {
+        if((std::strcmp(argv[i], "-n") == 0) && (i + 1 < argc))
+        {
+            iterations = std::strtoul(argv[++i], nullptr, 0);
+        }
+        else if(std::strcmp(argv[i], "-b") == 0)
+        {
+            batched = true;
+        }
+        else if(std::strcmp(argv[i], "-v") == 0)
+        {
+            verbose = true;
+        }
+        else if(argv[i][0] == '-')
+        {
+            printUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        else
+        {
+            traces.emplace_back();
+            if(!loadTrace(argv[i], traces.back()))
+            {
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    if(traces.empty() || (iterations == 0))
+    {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::printf("Mode: %s, iterations: %lu\n", batched ? "batch per frame" : "pulse per edge", iterations);
+    for(const Trace& trace : traces)
+    {
+        HostHal::reset();
+        ReplaySource source;
+        IrDecoderAll decoder{source};
+        decoder.initialize();
+
+        if(verbose)
+        {
+            std::printf("%s:\n", trace.name.c_str());
+        }
+
+        std::size_t events{0};
+        const auto start{std::chrono::steady_clock::now()};
+        for(unsigned long i = 0; i < iterations; i++)
+        {
+            events += replay(trace, source, decoder, batched, verbose && (i == 0));
+        }
+        const auto end{std::chrono::steady_clock::now()};
+
+        const double elapsedNs{static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count())};
+        const double edges{static_cast<double>(trace.pulses.size()) * static_cast<double>(iterations)};
+        const IrDecoder::Statistics& statistics{decoder.getStatistics()};
+
+        std::printf("%s: %zu pulses\n", trace.name.c_str(), trace.pulses.size());
+        std::printf("  events per pass: %zu (frames: %lu, repeats: %lu)\n", events / iterations,
+            static_cast<unsigned long>(statistics.frames / iterations), static_cast<unsigned long>(statistics.repeats / iterations));
+        std::printf("  rejected per pass: header: %lu, bit: %lu, checksum: %lu\n",
+            static_cast<unsigned long>(statistics.invalidHeader / iterations), static_cast<unsigned long>(statistics.invalidBit / iterations),
+            static_cast<unsigned long>(statistics.invalidChecksum / iterations));
+        std::printf("  corrected per pass: %lu\n", static_cast<unsigned long>(statistics.corrected / iterations));
+        std::printf("  queue overflows: %lu\n", static_cast<unsigned long>(decoder.getOverflowCount()));
+        std::printf("  %.2f ns/edge, %.0f edges/s\n", elapsedNs / edges, edges * 1e9 / elapsedNs);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,108 @@
+#include "ClockSync.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+std::int64_t ClockSync::getHostTimeUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool ClockSync::update(std::size_t count)
+{
+    bool updated{false};
+    for(std::size_t i = 0; i < count; i++)
+    {
+        UsbClockReport report;
+        const std::int64_t beforeUs{getHostTimeUs()};
+        if(!client_.getClock(report) || (report.setupTimeUs == 0))
+        {
+            continue;
+        }
+        const std::int64_t afterUs{getHostTimeUs()};
+
+        const std::lock_guard<std::mutex> lock{mutex_};
+        if((report.framePeriodNs != 0) && samples_.empty())
+        {
+            rate_ = 1e6 / report.framePeriodNs;
+        }
+        else if(report.framePeriodNs != 0) // the period is measured over 1 s, smooth it a bit more
+        {
+            rate_ += (1e6 / report.framePeriodNs - rate_) / 8;
+        }
+        samples_.push_back(Sample{beforeUs, afterUs, report.setupTimeUs});
+        if(samples_.size() > MAX_SAMPLES)
+        {
+            samples_.pop_front();
+        }
+        updated = true;
+    }
+
+    if(updated)
+    {
+        const std::lock_guard<std::mutex> lock{mutex_};
+        calculate();
+    }
+    return updated;
+}
+
+void ClockSync::calculate()
+{
+    // bounds of the host time at the reference, every sample is moved there with the rate
+    referenceDeviceUs_ = samples_.back().deviceUs;
+    std::int64_t minOffsetUs{INT64_MIN};
+    std::int64_t maxOffsetUs{INT64_MAX};
+    for(const Sample& sample : samples_)
+    {
+        const std::int64_t deltaUs{std::llround((static_cast<double>(referenceDeviceUs_) - static_cast<double>(sample.deviceUs)) * rate_)};
+        minOffsetUs = std::max(minOffsetUs, sample.hostBeforeUs + deltaUs);
+        maxOffsetUs = std::min(maxOffsetUs, sample.hostAfterUs + deltaUs);
+    }
+
+    if(minOffsetUs > maxOffsetUs) // the samples contradict each other (rate changed or the device was reset), start again
+    {
+        const Sample latest{samples_.back()};
+        samples_.clear();
+        samples_.push_back(latest);
+        minOffsetUs = latest.hostBeforeUs;
+        maxOffsetUs = latest.hostAfterUs;
+    }
+    minOffsetUs_ = minOffsetUs;
+    maxOffsetUs_ = maxOffsetUs;
+}
+
+bool ClockSync::isValid() const
+{
+    const std::lock_guard<std::mutex> lock{mutex_};
+    return !samples_.empty();
+}
+
+std::int64_t ClockSync::toHostUs(std::uint64_t deviceUs) const
+{
+    const std::lock_guard<std::mutex> lock{mutex_};
+    const double deltaUs{(static_cast<double>(deviceUs) - static_cast<double>(referenceDeviceUs_)) * rate_};
+    return (minOffsetUs_ + maxOffsetUs_) / 2 + std::llround(deltaUs);
+}
+
+std::int64_t ClockSync::toHostUs(std::uint32_t deviceUs) const
+{
+    std::uint64_t referenceDeviceUs;
+    {
+        const std::lock_guard<std::mutex> lock{mutex_};
+        referenceDeviceUs = referenceDeviceUs_;
+    }
+    const std::int32_t deltaUs{static_cast<std::int32_t>(deviceUs - static_cast<std::uint32_t>(referenceDeviceUs))};
+    return toHostUs(referenceDeviceUs + static_cast<std::int64_t>(deltaUs));
+}
+
+std::int64_t ClockSync::getUncertaintyUs() const
+{
+    const std::lock_guard<std::mutex> lock{mutex_};
+    return (maxOffsetUs_ - minOffsetUs_ + 1) / 2;
+}
+
+double ClockSync::getDriftPpm() const
+{
+    const std::lock_guard<std::mutex> lock{mutex_};
+    return (1.0 / rate_ - 1.0) * 1e6;
+}
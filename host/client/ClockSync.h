@@ -0,0 +1,59 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include "IrClient.h"
+
+/// Maps the device time (event time stamps) to the host monotonic clock (std::chrono::steady_clock in µs).
+/// Every sample is one VendorRequest::GET_CLOCK: the device latched the time its SETUP packet arrived, which was between
+/// the host times before and after the request, so every sample bounds the offset between the clocks from both sides.
+/// The tightest bounds of the recent samples are used, the rate of the device clock is corrected with the frame period
+/// the device measured against the SOFs of the host. update() can be called from any thread, e.g. every few seconds.
+class ClockSync
+{
+public:
+    static constexpr std::size_t MAX_SAMPLES{64};
+
+    explicit ClockSync(IrClient& client) :
+    client_{client}
+    {}
+
+    /// Send count requests, returns false if none succeeded
+    bool update(std::size_t count = 16);
+
+    /// True after a successful update
+    bool isValid() const;
+
+    /// Host time of a device time
+    std::int64_t toHostUs(std::uint64_t deviceUs) const;
+
+    /// Host time of a 32 bit event time stamp, taken as the device time closest to the latest sample
+    std::int64_t toHostUs(std::uint32_t deviceUs) const;
+
+    /// Maximum error of the mapping at the latest sample (half the width of the offset bounds)
+    std::int64_t getUncertaintyUs() const;
+
+    /// Rate of the device clock relative to the SOFs of the host in ppm (positive if the device clock runs fast)
+    double getDriftPpm() const;
+
+    static std::int64_t getHostTimeUs();
+
+private:
+    struct Sample
+    {
+        std::int64_t hostBeforeUs;
+        std::int64_t hostAfterUs;
+        std::uint64_t deviceUs;
+    };
+
+    IrClient& client_;
+    mutable std::mutex mutex_{};
+    std::deque<Sample> samples_{};
+    double rate_{1.0};               ///< Host µs per device µs
+    std::uint64_t referenceDeviceUs_{0};
+    std::int64_t minOffsetUs_{0};    ///< Bounds of the host time at referenceDeviceUs_
+    std::int64_t maxOffsetUs_{0};
+
+    void calculate();
+};
@@ -0,0 +1,383 @@
+#include "IrClient.h"
+#include <cstring>
+
+IrClient::~IrClient()
+{
+    stop();
+}
+
+bool IrClient::start()
+{
+    stream_.clear();
+    eventStream_.clear();
+    sequenceValid_ = false;
+    keySequenceValid_ = false;
+    gestureSequenceValid_ = false;
+    return transport_.start([this](std::uint8_t endpoint, const std::uint8_t* data, std::size_t size) { receive(endpoint, data, size); }, errorHandler_);
+}
+
+void IrClient::stop()
+{
+    transport_.stop();
+}
+
+void IrClient::receive(std::uint8_t endpoint, const std::uint8_t* data, std::size_t size)
+{
+    // the endpoints are parsed separately, a report never spans both
+    std::vector<std::uint8_t>& stream{(endpoint == IrTransport::EVENT_IN_ENDPOINT) ? eventStream_ : stream_};
+    stream.insert(stream.end(), data, data + size);
+
+    std::size_t offset{0};
+    while(offset < stream.size())
+    {
+        const std::uint8_t type{stream[offset]};
+        if((type != static_cast<std::uint8_t>(UsbReportType::EVENTS)) && (type != static_cast<std::uint8_t>(UsbReportType::RAW)) &&
+           (type != static_cast<std::uint8_t>(UsbReportType::KEYS)) && (type != static_cast<std::uint8_t>(UsbReportType::GESTURES)))
+        {
+            invalidBytes_++; // skip until the next report starts
+            offset++;
+            continue;
+        }
+
+        const std::size_t reportSize{parseReport(stream.data() + offset, stream.size() - offset)};
+        if((reportSize == 0) && ((stream.size() - offset) > MAX_REPORT_SIZE)) // cannot be completed anymore
+        {
+            invalidBytes_++;
+            offset++;
+            continue;
+        }
+        if(reportSize == 0) // the rest follows with the next transfer
+        {
+            break;
+        }
+        offset += reportSize;
+    }
+    stream.erase(stream.begin(), stream.begin() + static_cast<std::ptrdiff_t>(offset));
+}
+
+std::size_t IrClient::parseReport(const std::uint8_t* data, std::size_t size)
+{
+    if(size < sizeof(UsbEventReportHeader))
+    {
+        return 0;
+    }
+
+    if(data[0] == static_cast<std::uint8_t>(UsbReportType::EVENTS))
+    {
+        UsbEventReportHeader header;
+        std::memcpy(&header, data, sizeof(header));
+        const std::size_t reportSize{sizeof(header) + header.count * sizeof(UsbEventReportEntry)};
+        if(size < reportSize)
+        {
+            return 0;
+        }
+        handleEvents(data + sizeof(header), header.count, header.droppedCount);
+        return reportSize;
+    }
+
+    if(data[0] == static_cast<std::uint8_t>(UsbReportType::KEYS))
+    {
+        UsbEventReportHeader header;
+        std::memcpy(&header, data, sizeof(header));
+        const std::size_t reportSize{sizeof(header) + header.count * sizeof(UsbKeyEventEntry)};
+        if(size < reportSize)
+        {
+            return 0;
+        }
+        handleKeys(data + sizeof(header), header.count, header.droppedCount);
+        return reportSize;
+    }
+
+    if(data[0] == static_cast<std::uint8_t>(UsbReportType::GESTURES))
+    {
+        UsbEventReportHeader header;
+        std::memcpy(&header, data, sizeof(header));
+        const std::size_t reportSize{sizeof(header) + header.count * sizeof(UsbGestureEntry)};
+        if(size < reportSize)
+        {
+            return 0;
+        }
+        handleGestures(data + sizeof(header), header.count, header.droppedCount);
+        return reportSize;
+    }
+
+    UsbRawReportHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    std::vector<Pulse> pulses;
+    const std::size_t used{decodeDurations(data + sizeof(header), size - sizeof(header), header.count, (header.flags & UsbRawFlags::FIRST_IS_MARK) != 0, pulses)};
+    if((used == 0) && (header.count != 0))
+    {
+        return 0;
+    }
+    if(rawHandler_)
+    {
+        rawHandler_(pulses, (header.flags & UsbRawFlags::PULSES_LOST) != 0);
+    }
+    return sizeof(header) + used;
+}
+
+void IrClient::handleEvents(const std::uint8_t* data, std::size_t count, std::uint16_t droppedCount)
+{
+    for(std::size_t i = 0; i < count; i++)
+    {
+        UsbEventReportEntry entry;
+        std::memcpy(&entry, data + i * sizeof(entry), sizeof(entry));
+
+        if(sequenceValid_ && (entry.sequence != expectedSequence_) && lossHandler_)
+        {
+            lossHandler_(static_cast<std::uint16_t>(entry.sequence - expectedSequence_), droppedCount);
+        }
+        sequenceValid_ = true;
+        expectedSequence_ = static_cast<std::uint16_t>(entry.sequence + 1);
+
+        if(eventHandler_)
+        {
+            eventHandler_(Event{entry.sequence, entry.protocol, (entry.flags & UsbEventFlags::REPEATED) != 0, entry.timestampUs,
+                                entry.code, entry.address, entry.command});
+        }
+    }
+}
+
+void IrClient::handleKeys(const std::uint8_t* data, std::size_t count, std::uint16_t droppedCount)
+{
+    for(std::size_t i = 0; i < count; i++)
+    {
+        UsbKeyEventEntry entry;
+        std::memcpy(&entry, data + i * sizeof(entry), sizeof(entry));
+
+        if(keySequenceValid_ && (entry.sequence != expectedKeySequence_) && lossHandler_)
+        {
+            lossHandler_(static_cast<std::uint16_t>(entry.sequence - expectedKeySequence_), droppedCount);
+        }
+        keySequenceValid_ = true;
+        expectedKeySequence_ = static_cast<std::uint16_t>(entry.sequence + 1);
+
+        if(keyHandler_)
+        {
+            keyHandler_(KeyEvent{entry.sequence, static_cast<UsbKeyEventType>(entry.type), entry.protocol, entry.address, entry.command,
+                                 entry.repeatCount, entry.timestampUs});
+        }
+    }
+}
+
+void IrClient::handleGestures(const std::uint8_t* data, std::size_t count, std::uint16_t droppedCount)
+{
+    for(std::size_t i = 0; i < count; i++)
+    {
+        UsbGestureEntry entry;
+        std::memcpy(&entry, data + i * sizeof(entry), sizeof(entry));
+
+        if(gestureSequenceValid_ && (entry.sequence != expectedGestureSequence_) && lossHandler_)
+        {
+            lossHandler_(static_cast<std::uint16_t>(entry.sequence - expectedGestureSequence_), droppedCount);
+        }
+        gestureSequenceValid_ = true;
+        expectedGestureSequence_ = static_cast<std::uint16_t>(entry.sequence + 1);
+
+        if(gestureHandler_)
+        {
+            gestureHandler_(GestureEvent{entry.sequence, entry.id, entry.timestampUs});
+        }
+    }
+}
+
+void IrClient::encodeDurations(const std::vector<Pulse>& pulses, std::vector<std::uint8_t>& encoded)
+{
+    std::uint32_t previous[2]{0, 0};
+    for(const Pulse& pulse : pulses)
+    {
+        const std::int32_t delta{static_cast<std::int32_t>(pulse.durationUs - previous[pulse.mark])};
+        previous[pulse.mark] = pulse.durationUs;
+        std::uint32_t value{(static_cast<std::uint32_t>(delta) << 1) ^ static_cast<std::uint32_t>(delta >> 31)};
+        while(value >= 0x80)
+        {
+            encoded.push_back(static_cast<std::uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        encoded.push_back(static_cast<std::uint8_t>(value));
+    }
+}
+
+std::size_t IrClient::decodeDurations(const std::uint8_t* data, std::size_t size, std::size_t count, bool firstIsMark, std::vector<Pulse>& pulses)
+{
+    std::uint32_t previous[2]{0, 0};
+    bool mark{firstIsMark};
+    std::size_t offset{0};
+    for(std::size_t i = 0; i < count; i++)
+    {
+        std::uint32_t value{0};
+        for(unsigned int shift = 0; ; shift += 7)
+        {
+            if((offset >= size) || (shift > 28))
+            {
+                return 0;
+            }
+            const std::uint8_t byte{data[offset++]};
+            value |= static_cast<std::uint32_t>(byte & 0x7F) << shift;
+            if((byte & 0x80) == 0)
+            {
+                break;
+            }
+        }
+        previous[mark] += (value >> 1) ^ (0u - (value & 1));
+        pulses.push_back(Pulse{mark, previous[mark]});
+        mark = !mark;
+    }
+    return offset;
+}
+
+template<typename Report>
+bool IrClient::getReport(VendorRequest request, std::uint16_t index, Report& report)
+{
+    return transport_.controlIn(static_cast<std::uint8_t>(request), 0, index, reinterpret_cast<std::uint8_t*>(&report), sizeof(report)) == sizeof(report);
+}
+
+bool IrClient::sendRequest(VendorRequest request, std::uint16_t value)
+{
+    return transport_.controlOut(static_cast<std::uint8_t>(request), value, 0, nullptr, 0) == 0;
+}
+
+bool IrClient::getLatency(UsbLatencyReport& report)
+{
+    return getReport(VendorRequest::GET_LATENCY, 0, report);
+}
+
+bool IrClient::resetLatency()
+{
+    return sendRequest(VendorRequest::RESET_LATENCY);
+}
+
+bool IrClient::setMode(std::uint16_t mode)
+{
+    return sendRequest(VendorRequest::SET_MODE, mode);
+}
+
+bool IrClient::getStatistics(std::uint16_t receiver, UsbStatisticsReport& report)
+{
+    return getReport(VendorRequest::GET_STATISTICS, receiver, report);
+}
+
+bool IrClient::getTrace(std::uint16_t receiver, std::uint32_t& writeCount, std::vector<UsbTraceEntry>& entries)
+{
+    std::vector<std::uint8_t> response(MAX_CONTROL_SIZE);
+    const int size{transport_.controlIn(static_cast<std::uint8_t>(VendorRequest::GET_TRACE), 0, receiver, response.data(), static_cast<std::uint16_t>(response.size()))};
+    if(size < static_cast<int>(sizeof(UsbTraceReportHeader)))
+    {
+        return false;
+    }
+
+    UsbTraceReportHeader header;
+    std::memcpy(&header, response.data(), sizeof(header));
+    writeCount = header.writeCount;
+    entries.resize((static_cast<std::size_t>(size) - sizeof(header)) / sizeof(UsbTraceEntry));
+    std::memcpy(entries.data(), response.data() + sizeof(header), entries.size() * sizeof(UsbTraceEntry));
+    return true;
+}
+
+bool IrClient::getHistograms(std::vector<std::vector<std::uint32_t>>& histograms)
+{
+    std::vector<std::uint8_t> response(MAX_CONTROL_SIZE);
+    const int size{transport_.controlIn(static_cast<std::uint8_t>(VendorRequest::GET_HISTOGRAMS), 0, 0, response.data(), static_cast<std::uint16_t>(response.size()))};
+    if(size < static_cast<int>(sizeof(UsbHistogramReportHeader)))
+    {
+        return false;
+    }
+
+    UsbHistogramReportHeader header;
+    std::memcpy(&header, response.data(), sizeof(header));
+    const std::size_t bucketsSize{static_cast<std::size_t>(header.bucketCount) * sizeof(std::uint32_t)};
+    if(static_cast<std::size_t>(size) < sizeof(header) + header.histogramCount * bucketsSize)
+    {
+        return false;
+    }
+
+    histograms.assign(header.histogramCount, std::vector<std::uint32_t>(header.bucketCount));
+    for(std::size_t i = 0; i < histograms.size(); i++)
+    {
+        std::memcpy(histograms[i].data(), response.data() + sizeof(header) + i * bucketsSize, bucketsSize);
+    }
+    return true;
+}
+
+bool IrClient::resetHistograms()
+{
+    return sendRequest(VendorRequest::RESET_HISTOGRAMS);
+}
+
+bool IrClient::getTransmitStatus(UsbTransmitStatusReport& report)
+{
+    return getReport(VendorRequest::GET_TRANSMIT_STATUS, 0, report);
+}
+
+bool IrClient::getConfig(std::uint16_t key, std::vector<std::uint8_t>& value)
+{
+    value.resize(MAX_CONTROL_SIZE);
+    const int size{transport_.controlIn(static_cast<std::uint8_t>(VendorRequest::GET_CONFIG), key, 0, value.data(), static_cast<std::uint16_t>(value.size()))};
+    value.resize((size > 0) ? static_cast<std::size_t>(size) : 0);
+    return size >= 0;
+}
+
+bool IrClient::setConfig(std::uint16_t key, const std::vector<std::uint8_t>& value)
+{
+    return (value.size() <= MAX_CONTROL_SIZE) &&
+           (transport_.controlOut(static_cast<std::uint8_t>(VendorRequest::SET_CONFIG), key, 0, value.data(), static_cast<std::uint16_t>(value.size())) ==
+            static_cast<int>(value.size()));
+}
+
+bool IrClient::getClock(UsbClockReport& report)
+{
+    return getReport(VendorRequest::GET_CLOCK, 0, report);
+}
+
+bool IrClient::setFilter(const std::vector<UsbFilterEntry>& entries)
+{
+    const std::size_t size{entries.size() * sizeof(UsbFilterEntry)};
+    return (size <= MAX_CONTROL_SIZE) &&
+           (transport_.controlOut(static_cast<std::uint8_t>(VendorRequest::SET_FILTER), 0, 0, reinterpret_cast<const std::uint8_t*>(entries.data()),
+                                  static_cast<std::uint16_t>(size)) == static_cast<int>(size));
+}
+
+bool IrClient::transmitCode(std::uint8_t protocol, std::uint16_t address, std::uint8_t command, std::uint8_t repeats, bool toggle, std::uint8_t bits)
+{
+    const UsbTransmitCodeCommand code
+    {
+        .type = static_cast<std::uint8_t>(UsbCommandType::TRANSMIT_CODE),
+        .protocol = protocol,
+        .address = address,
+        .command = command,
+        .repeats = repeats,
+        .flags = static_cast<std::uint8_t>(toggle ? UsbTransmitFlags::TOGGLE : 0),
+        .carrierKHz = 0,
+        .periodUs = 0,
+        .bits = bits
+    };
+    return transport_.write(reinterpret_cast<const std::uint8_t*>(&code), sizeof(code));
+}
+
+bool IrClient::transmitRaw(const std::vector<std::uint32_t>& durationsUs, std::uint8_t carrierKHz, std::uint32_t gapUs)
+{
+    std::vector<Pulse> pulses;
+    for(std::size_t i = 0; i < durationsUs.size(); i++)
+    {
+        pulses.push_back(Pulse{(i % 2) == 0, durationsUs[i]});
+    }
+
+    std::vector<std::uint8_t> command(sizeof(UsbTransmitRawCommand));
+    encodeDurations(pulses, command);
+    const std::size_t encodedSize{command.size() - sizeof(UsbTransmitRawCommand)};
+    if(durationsUs.empty() || (durationsUs.size() > UINT8_MAX) || (encodedSize > UINT8_MAX))
+    {
+        return false;
+    }
+
+    const UsbTransmitRawCommand header
+    {
+        .type = static_cast<std::uint8_t>(UsbCommandType::TRANSMIT_RAW),
+        .count = static_cast<std::uint8_t>(durationsUs.size()),
+        .size = static_cast<std::uint8_t>(encodedSize),
+        .carrierKHz = carrierKHz,
+        .gapUs = gapUs
+    };
+    std::memcpy(command.data(), &header, sizeof(header));
+    return transport_.write(command.data(), command.size());
+}
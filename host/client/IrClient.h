@@ -0,0 +1,151 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "IrTransport.h"
+#include "UsbReport.h"
+
+/// Host side of the vendor interface: turns the reports of the IN endpoints into events and pulses, sends the transmit
+/// commands and wraps the vendor requests. The handlers are called from the event thread of the transport, the requests
+/// can be sent from any thread.
+class IrClient
+{
+public:
+    struct Event
+    {
+        std::uint16_t sequence;
+        std::uint8_t protocol;     ///< IrProtocolId
+        bool repeated;
+        std::uint32_t timestampUs; ///< Device time of the last edge of the frame (wraps)
+        std::uint32_t code;        ///< All bits of the frame
+        std::uint16_t address;
+        std::uint8_t command;
+    };
+
+    struct KeyEvent
+    {
+        std::uint16_t sequence;
+        UsbKeyEventType type;
+        std::uint8_t protocol;     ///< IrProtocolId
+        std::uint16_t address;
+        std::uint8_t command;
+        std::uint8_t repeatCount;  ///< REPEAT events of this press so far
+        std::uint32_t timestampUs; ///< Device time of the last edge of the frame, timed repeat: of the repeat, release: when the next repeat code was due (wraps)
+    };
+
+    struct GestureEvent
+    {
+        std::uint16_t sequence;
+        std::uint16_t id;          ///< GestureEntry::id of the configuration
+        std::uint32_t timestampUs; ///< Device time of the end of the last step (wraps)
+    };
+
+    struct Pulse
+    {
+        bool mark;
+        std::uint32_t durationUs;
+    };
+
+    using EventHandler = std::function<void(const Event& event)>;
+
+    /// Key events (UsbReportMode::KEYS)
+    using KeyHandler = std::function<void(const KeyEvent& event)>;
+
+    /// Completed gestures (UsbReportMode::GESTURES)
+    using GestureHandler = std::function<void(const GestureEvent& event)>;
+
+    /// Durations of one RAW report, pulsesLost: the capture lost pulses before them
+    using RawHandler = std::function<void(const std::vector<Pulse>& pulses, bool pulsesLost)>;
+
+    /// Events (or key events, gestures) lost between the device and the host (sequence gap), droppedCount: dropped by the device so far (wraps)
+    using LossHandler = std::function<void(std::uint16_t lostCount, std::uint16_t droppedCount)>;
+
+    /// The reception ended because the device is gone or the transfers failed, called from the thread of the transport
+    using ErrorHandler = IrTransport::ErrorHandler;
+
+    explicit IrClient(IrTransport& transport) :
+    transport_{transport}
+    {}
+
+    ~IrClient();
+
+    void setEventHandler(EventHandler handler) { eventHandler_ = std::move(handler); }
+    void setKeyHandler(KeyHandler handler) { keyHandler_ = std::move(handler); }
+    void setGestureHandler(GestureHandler handler) { gestureHandler_ = std::move(handler); }
+    void setRawHandler(RawHandler handler) { rawHandler_ = std::move(handler); }
+    void setLossHandler(LossHandler handler) { lossHandler_ = std::move(handler); }
+    void setErrorHandler(ErrorHandler handler) { errorHandler_ = std::move(handler); }
+
+    /// Start receiving, set the handlers before
+    bool start();
+
+    void stop();
+
+    /// Number of bytes of the stream which were no valid report (e.g. the client started in the middle of a report)
+    std::size_t getInvalidBytes() const { return invalidBytes_; }
+
+    // Vendor requests (see VendorRequest), false if the transfer failed or the device stalled the request
+
+    bool getLatency(UsbLatencyReport& report);
+    bool resetLatency();
+    bool setMode(std::uint16_t mode);
+    bool getStatistics(std::uint16_t receiver, UsbStatisticsReport& report);
+    bool getTrace(std::uint16_t receiver, std::uint32_t& writeCount, std::vector<UsbTraceEntry>& entries);
+    bool getHistograms(std::vector<std::vector<std::uint32_t>>& histograms);
+    bool resetHistograms();
+    bool getTransmitStatus(UsbTransmitStatusReport& report);
+    bool getConfig(std::uint16_t key, std::vector<std::uint8_t>& value);
+    bool setConfig(std::uint16_t key, const std::vector<std::uint8_t>& value);
+    bool getClock(UsbClockReport& report);
+    /// Report only the events of these codes, an empty list reports all codes again
+    bool setFilter(const std::vector<UsbFilterEntry>& entries);
+
+    // Transmit commands (bulk OUT)
+
+    /// bits selects the frame length of protocols with several variants (Sony: 12, 15 or 20), 0 for the shortest one
+    bool transmitCode(std::uint8_t protocol, std::uint16_t address, std::uint8_t command, std::uint8_t repeats, bool toggle = false, std::uint8_t bits = 0);
+
+    /// Send recorded durations starting with a mark (up to 255 durations, as many as fit into 255 bytes when encoded)
+    bool transmitRaw(const std::vector<std::uint32_t>& durationsUs, std::uint8_t carrierKHz = 0, std::uint32_t gapUs = 0);
+
+    /// Encode durations like a RAW report (delta to the previous duration of the same level, zigzag, LEB128)
+    static void encodeDurations(const std::vector<Pulse>& pulses, std::vector<std::uint8_t>& encoded);
+
+    /// Decode count durations of a RAW report, returns the number of bytes used or 0 if the data is incomplete
+    static std::size_t decodeDurations(const std::uint8_t* data, std::size_t size, std::size_t count, bool firstIsMark, std::vector<Pulse>& pulses);
+
+    /// Parse data of an IN endpoint, called by the transport (reports can span several transfers)
+    void receive(std::uint8_t endpoint, const std::uint8_t* data, std::size_t size);
+
+private:
+    static constexpr std::size_t MAX_CONTROL_SIZE{1024};
+    static constexpr std::size_t MAX_REPORT_SIZE{sizeof(UsbRawReportHeader) + UINT8_MAX * 5}; // 255 durations of up to 5 bytes
+
+    IrTransport& transport_;
+    EventHandler eventHandler_{};
+    KeyHandler keyHandler_{};
+    GestureHandler gestureHandler_{};
+    RawHandler rawHandler_{};
+    LossHandler lossHandler_{};
+    ErrorHandler errorHandler_{};
+    std::vector<std::uint8_t> stream_{};      ///< Received data of the bulk endpoint not parsed yet
+    std::vector<std::uint8_t> eventStream_{}; ///< Same for the event endpoint
+    bool sequenceValid_{false};
+    std::uint16_t expectedSequence_{0};
+    bool keySequenceValid_{false};
+    std::uint16_t expectedKeySequence_{0};
+    bool gestureSequenceValid_{false};
+    std::uint16_t expectedGestureSequence_{0};
+    std::size_t invalidBytes_{0};
+
+    /// Parse the report at the start of the stream, returns its size or 0 if it is incomplete
+    std::size_t parseReport(const std::uint8_t* data, std::size_t size);
+    void handleEvents(const std::uint8_t* data, std::size_t count, std::uint16_t droppedCount);
+    void handleKeys(const std::uint8_t* data, std::size_t count, std::uint16_t droppedCount);
+    void handleGestures(const std::uint8_t* data, std::size_t count, std::uint16_t droppedCount);
+
+    template<typename Report>
+    bool getReport(VendorRequest request, std::uint16_t index, Report& report);
+    bool sendRequest(VendorRequest request, std::uint16_t value = 0);
+};
@@ -0,0 +1,47 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+/// Access to the vendor interface of the device: bulk IN stream, bulk OUT commands and vendor control requests.
+/// Optionally the events are received on the interrupt endpoint of the event interface instead of the bulk stream.
+class IrTransport
+{
+public:
+    /// Receives the data of every IN transfer with its endpoint, called from the event thread of the transport
+    using DataHandler = std::function<void(std::uint8_t endpoint, const std::uint8_t* data, std::size_t size)>;
+
+    /// Reasons the reception ended without stop()
+    enum class Error
+    {
+        DISCONNECTED, ///< The device is gone
+        FAILED        ///< The IN transfers failed repeatedly or could not be queued again
+    };
+
+    /// Called once from the event thread when the reception ends by an error. stop() still has to be called, but not from
+    /// the handler (it waits for the event thread)
+    using ErrorHandler = std::function<void(Error error)>;
+
+    /// Size of the IN transfers, one packet, so every packet is delivered as soon as it arrives
+    static constexpr std::size_t TRANSFER_SIZE{64};
+
+    static constexpr std::uint8_t BULK_IN_ENDPOINT{0x81};
+    static constexpr std::uint8_t EVENT_IN_ENDPOINT{0x83}; ///< Interrupt endpoint, every transfer holds complete reports
+
+    virtual ~IrTransport() = default;
+
+    /// Start receiving the IN endpoints, errorHandler may be empty
+    virtual bool start(DataHandler dataHandler, ErrorHandler errorHandler) = 0;
+
+    /// Stop receiving, the handler is not called anymore when this returns
+    virtual void stop() = 0;
+
+    /// Vendor request with device to host data stage, returns the number of bytes received or -1 if the request failed (stall)
+    virtual int controlIn(std::uint8_t request, std::uint16_t value, std::uint16_t index, std::uint8_t* data, std::uint16_t size) = 0;
+
+    /// Vendor request with host to device data stage (or none), returns the number of bytes sent or -1 if the request failed
+    virtual int controlOut(std::uint8_t request, std::uint16_t value, std::uint16_t index, const std::uint8_t* data, std::uint16_t size) = 0;
+
+    /// Send data on the bulk OUT endpoint
+    virtual bool write(const std::uint8_t* data, std::size_t size) = 0;
+};
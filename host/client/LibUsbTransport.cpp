@@ -0,0 +1,245 @@
+#include "LibUsbTransport.h"
+
+LibUsbTransport::~LibUsbTransport()
+{
+    close();
+}
+
+bool LibUsbTransport::open(std::uint16_t vid, std::uint16_t pid, bool eventEndpoint)
+{
+    close();
+    if(libusb_init(&context_) != LIBUSB_SUCCESS)
+    {
+        context_ = nullptr;
+        return false;
+    }
+
+    handle_ = libusb_open_device_with_vid_pid(context_, vid, pid);
+    if((handle_ == nullptr) || (libusb_claim_interface(handle_, INTERFACE) != LIBUSB_SUCCESS))
+    {
+        close();
+        return false;
+    }
+
+    if(eventEndpoint)
+    {
+        eventEndpoint_ = true;
+        if((libusb_claim_interface(handle_, EVENT_INTERFACE) != LIBUSB_SUCCESS) ||
+           (libusb_set_interface_alt_setting(handle_, EVENT_INTERFACE, EVENT_ALTERNATE_SETTING) != LIBUSB_SUCCESS))
+        {
+            close();
+            return false;
+        }
+    }
+    return true;
+}
+
+void LibUsbTransport::close()
+{
+    stop();
+    if(handle_ != nullptr)
+    {
+        if(eventEndpoint_) // back to the alternate setting without endpoint, the device sends the events on the bulk endpoint again
+        {
+            libusb_set_interface_alt_setting(handle_, EVENT_INTERFACE, 0);
+            libusb_release_interface(handle_, EVENT_INTERFACE);
+            eventEndpoint_ = false;
+        }
+        libusb_release_interface(handle_, INTERFACE);
+        libusb_close(handle_);
+        handle_ = nullptr;
+    }
+    if(context_ != nullptr)
+    {
+        libusb_exit(context_);
+        context_ = nullptr;
+    }
+}
+
+bool LibUsbTransport::start(DataHandler dataHandler, ErrorHandler errorHandler)
+{
+    if((handle_ == nullptr) || running_)
+    {
+        return false;
+    }
+
+    handler_ = std::move(dataHandler);
+    errorHandler_ = std::move(errorHandler);
+    errorCount_ = 0;
+    failed_ = false;
+    running_ = true;
+    const std::size_t count{eventEndpoint_ ? 2 * QUEUED_TRANSFERS : QUEUED_TRANSFERS};
+    for(std::size_t i = 0; i < count; i++)
+    {
+        transfers_[i] = libusb_alloc_transfer(0);
+        if(i < QUEUED_TRANSFERS)
+        {
+            libusb_fill_bulk_transfer(transfers_[i], handle_, BULK_IN_ENDPOINT, buffers_[i].data(), static_cast<int>(buffers_[i].size()),
+                                      &LibUsbTransport::transferCallback, this, 0);
+        }
+        else
+        {
+            libusb_fill_interrupt_transfer(transfers_[i], handle_, EVENT_IN_ENDPOINT, buffers_[i].data(), static_cast<int>(buffers_[i].size()),
+                                           &LibUsbTransport::transferCallback, this, 0);
+        }
+        if(libusb_submit_transfer(transfers_[i]) == LIBUSB_SUCCESS)
+        {
+            pendingTransfers_++;
+        }
+    }
+    if(pendingTransfers_ == 0) // no event thread needed, stop() has nothing to do
+    {
+        running_ = false;
+        freeTransfers();
+        return false;
+    }
+    thread_ = std::thread{&LibUsbTransport::eventLoop, this};
+    return true;
+}
+
+void LibUsbTransport::stop()
+{
+    if(!running_)
+    {
+        return;
+    }
+
+    // the cancelled transfers complete in the event thread, it ends when none is pending anymore
+    {
+        const std::lock_guard<std::mutex> lock{submitMutex_};
+        running_ = false;
+        for(libusb_transfer* transfer : transfers_)
+        {
+            if(transfer != nullptr)
+            {
+                libusb_cancel_transfer(transfer);
+            }
+        }
+    }
+    thread_.join();
+    freeTransfers();
+}
+
+int LibUsbTransport::controlIn(std::uint8_t request, std::uint16_t value, std::uint16_t index, std::uint8_t* data, std::uint16_t size)
+{
+    if(handle_ == nullptr)
+    {
+        return -1;
+    }
+    const int result{libusb_control_transfer(handle_, LIBUSB_ENDPOINT_IN | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE,
+                                             request, value, index, data, size, TIMEOUT_MS)};
+    return (result >= 0) ? result : -1;
+}
+
+int LibUsbTransport::controlOut(std::uint8_t request, std::uint16_t value, std::uint16_t index, const std::uint8_t* data, std::uint16_t size)
+{
+    if(handle_ == nullptr)
+    {
+        return -1;
+    }
+    // libusb does not write to the buffer of an OUT request
+    const int result{libusb_control_transfer(handle_, LIBUSB_ENDPOINT_OUT | LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE,
+                                             request, value, index, const_cast<std::uint8_t*>(data), size, TIMEOUT_MS)};
+    return (result >= 0) ? result : -1;
+}
+
+bool LibUsbTransport::write(const std::uint8_t* data, std::size_t size)
+{
+    int transferred{0};
+    return (handle_ != nullptr) &&
+           (libusb_bulk_transfer(handle_, ENDPOINT_OUT, const_cast<std::uint8_t*>(data), static_cast<int>(size), &transferred, TIMEOUT_MS) == LIBUSB_SUCCESS) &&
+           (static_cast<std::size_t>(transferred) == size);
+}
+
+void LIBUSB_CALL LibUsbTransport::transferCallback(libusb_transfer* transfer)
+{
+    static_cast<LibUsbTransport*>(transfer->user_data)->handleTransfer(transfer);
+}
+
+void LibUsbTransport::handleTransfer(libusb_transfer* transfer)
+{
+    bool resubmit{false};
+    Error error{Error::FAILED};
+    switch(transfer->status)
+    {
+    case LIBUSB_TRANSFER_COMPLETED:
+        errorCount_ = 0;
+        if((transfer->actual_length > 0) && !failed_)
+        {
+            handler_(transfer->endpoint, transfer->buffer, static_cast<std::size_t>(transfer->actual_length));
+        }
+        resubmit = true;
+        break;
+
+    case LIBUSB_TRANSFER_STALL: // the endpoint stays halted until the host clears it
+        resubmit = (++errorCount_ <= MAX_ERRORS) && (libusb_clear_halt(handle_, transfer->endpoint) == LIBUSB_SUCCESS);
+        break;
+
+    case LIBUSB_TRANSFER_TIMED_OUT:
+    case LIBUSB_TRANSFER_OVERFLOW:
+    case LIBUSB_TRANSFER_ERROR: // e.g. a corrupted packet, the next transfer usually succeeds
+        resubmit = ++errorCount_ <= MAX_ERRORS;
+        break;
+
+    case LIBUSB_TRANSFER_NO_DEVICE:
+        error = Error::DISCONNECTED;
+        break;
+
+    default: // cancelled by stop()
+        break;
+    }
+
+    bool report{false};
+    {
+        const std::lock_guard<std::mutex> lock{submitMutex_};
+        if(resubmit && running_ && !failed_) // queue it again right away
+        {
+            const int result{libusb_submit_transfer(transfer)};
+            if(result == LIBUSB_SUCCESS)
+            {
+                return;
+            }
+            error = (result == LIBUSB_ERROR_NO_DEVICE) ? Error::DISCONNECTED : Error::FAILED;
+        }
+        report = running_ && !failed_ && (transfer->status != LIBUSB_TRANSFER_CANCELLED);
+        if(report)
+        {
+            cancelOthers();
+        }
+    }
+    pendingTransfers_--;
+    if(report && errorHandler_) // without the lock, the handler may call into the transport
+    {
+        errorHandler_(error);
+    }
+}
+
+void LibUsbTransport::cancelOthers()
+{
+    // the other transfers end as well, the event thread ends when none is pending anymore
+    failed_ = true;
+    for(libusb_transfer* transfer : transfers_)
+    {
+        if(transfer != nullptr)
+        {
+            libusb_cancel_transfer(transfer);
+        }
+    }
+}
+
+void LibUsbTransport::freeTransfers()
+{
+    for(libusb_transfer*& transfer : transfers_)
+    {
+        libusb_free_transfer(transfer);
+        transfer = nullptr;
+    }
+}
+
+void LibUsbTransport::eventLoop()
+{
+    while(pendingTransfers_ > 0)
+    {
+        libusb_handle_events(context_);
+    }
+}
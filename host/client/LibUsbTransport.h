@@ -0,0 +1,67 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <libusb.h>
+#include "IrTransport.h"
+
+/// Transport with libusb. Several IN transfers are queued all the time, so the device can always send and the
+/// event thread sleeps in libusb until a transfer completes (no polling). A transfer which failed for a transient reason
+/// (timeout, stall, overflow, transmission error) is queued again, the reception ends with the error handler when the
+/// device is gone or the transfers keep failing.
+class LibUsbTransport final : public IrTransport
+{
+public:
+    static constexpr std::uint16_t VID{0xF055};
+    static constexpr std::uint16_t PID{0xB195};
+    static constexpr std::uint16_t IR_TOY_VID{0x04D8}; ///< IDs of the IR Toy personality, only the control requests are available then
+    static constexpr std::uint16_t IR_TOY_PID{0xFD08};
+    static constexpr std::size_t QUEUED_TRANSFERS{8};
+
+    LibUsbTransport() = default;
+    LibUsbTransport(const LibUsbTransport&) = delete;
+    LibUsbTransport& operator=(const LibUsbTransport&) = delete;
+    virtual ~LibUsbTransport() override;
+
+    /// Open the first device with the IDs and claim the vendor interface.
+    /// eventEndpoint: also claim the event interface and select its interrupt endpoint, the device sends the events there
+    bool open(std::uint16_t vid = VID, std::uint16_t pid = PID, bool eventEndpoint = false);
+
+    void close();
+
+    virtual bool start(DataHandler dataHandler, ErrorHandler errorHandler) override;
+    virtual void stop() override;
+    virtual int controlIn(std::uint8_t request, std::uint16_t value, std::uint16_t index, std::uint8_t* data, std::uint16_t size) override;
+    virtual int controlOut(std::uint8_t request, std::uint16_t value, std::uint16_t index, const std::uint8_t* data, std::uint16_t size) override;
+    virtual bool write(const std::uint8_t* data, std::size_t size) override;
+
+private:
+    static constexpr std::uint8_t INTERFACE{0};
+    static constexpr std::uint8_t EVENT_INTERFACE{2};
+    static constexpr std::uint8_t EVENT_ALTERNATE_SETTING{1}; ///< Alternate setting 0 has no endpoint
+    static constexpr std::uint8_t ENDPOINT_OUT{0x01};
+    static constexpr unsigned int TIMEOUT_MS{1000};
+    static constexpr unsigned int MAX_ERRORS{4 * QUEUED_TRANSFERS}; ///< Failed transfers in a row before the reception ends
+
+    libusb_context* context_{nullptr};
+    libusb_device_handle* handle_{nullptr};
+    bool eventEndpoint_{false};
+    std::array<libusb_transfer*, 2 * QUEUED_TRANSFERS> transfers_{}; ///< Bulk transfers, followed by the interrupt transfers
+    std::array<std::array<std::uint8_t, TRANSFER_SIZE>, 2 * QUEUED_TRANSFERS> buffers_{};
+    DataHandler handler_{};
+    ErrorHandler errorHandler_{};
+    std::thread thread_{};
+    std::atomic<bool> running_{false};
+    std::mutex submitMutex_{}; ///< A transfer is either resubmitted before stop() cancels it or not at all
+    std::atomic<std::size_t> pendingTransfers_{0};
+    unsigned int errorCount_{0}; ///< Failed transfers since the last completed one (event thread only)
+    bool failed_{false};         ///< The error was reported, the remaining transfers are not queued again
+
+    static void LIBUSB_CALL transferCallback(libusb_transfer* transfer);
+    void handleTransfer(libusb_transfer* transfer);
+    void cancelOthers();
+    void freeTransfers();
+    void eventLoop();
+};
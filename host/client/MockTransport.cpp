@@ -0,0 +1,107 @@
+#include "MockTransport.h"
+#include <algorithm>
+
+MockTransport::~MockTransport()
+{
+    stop();
+}
+
+void MockTransport::inject(const std::uint8_t* data, std::size_t size, std::uint8_t endpoint)
+{
+    const std::lock_guard<std::mutex> lock{mutex_};
+    for(std::size_t offset = 0; offset < size; offset += TRANSFER_SIZE)
+    {
+        transfers_.emplace_back(endpoint, std::vector<std::uint8_t>{data + offset, data + std::min(size, offset + TRANSFER_SIZE)});
+    }
+    changed_.notify_all();
+}
+
+void MockTransport::flush()
+{
+    std::unique_lock<std::mutex> lock{mutex_};
+    changed_.wait(lock, [this]() { return !running_ || (transfers_.empty() && !delivering_); });
+}
+
+std::vector<std::vector<std::uint8_t>> MockTransport::takeWritten()
+{
+    const std::lock_guard<std::mutex> lock{mutex_};
+    return std::move(written_);
+}
+
+bool MockTransport::start(DataHandler dataHandler, ErrorHandler)
+{
+    const std::lock_guard<std::mutex> lock{mutex_};
+    if(running_)
+    {
+        return false;
+    }
+    handler_ = std::move(dataHandler);
+    running_ = true;
+    thread_ = std::thread{&MockTransport::eventLoop, this};
+    return true;
+}
+
+void MockTransport::stop()
+{
+    {
+        const std::lock_guard<std::mutex> lock{mutex_};
+        if(!running_)
+        {
+            return;
+        }
+        running_ = false;
+        changed_.notify_all();
+    }
+    thread_.join();
+}
+
+int MockTransport::controlIn(std::uint8_t request, std::uint16_t value, std::uint16_t index, std::uint8_t* data, std::uint16_t size)
+{
+    std::vector<std::uint8_t> response;
+    if(!controlHandler_ || !controlHandler_(true, request, value, index, response))
+    {
+        return -1;
+    }
+    const std::size_t count{std::min<std::size_t>(response.size(), size)};
+    std::copy_n(response.begin(), count, data);
+    return static_cast<int>(count);
+}
+
+int MockTransport::controlOut(std::uint8_t request, std::uint16_t value, std::uint16_t index, const std::uint8_t* data, std::uint16_t size)
+{
+    std::vector<std::uint8_t> payload{data, data + size};
+    if(!controlHandler_ || !controlHandler_(false, request, value, index, payload))
+    {
+        return -1;
+    }
+    return size;
+}
+
+bool MockTransport::write(const std::uint8_t* data, std::size_t size)
+{
+    const std::lock_guard<std::mutex> lock{mutex_};
+    written_.emplace_back(data, data + size);
+    return true;
+}
+
+void MockTransport::eventLoop()
+{
+    std::unique_lock<std::mutex> lock{mutex_};
+    while(true)
+    {
+        changed_.wait(lock, [this]() { return !running_ || !transfers_.empty(); });
+        if(!running_)
+        {
+            return;
+        }
+
+        const std::pair<std::uint8_t, std::vector<std::uint8_t>> transfer{std::move(transfers_.front())};
+        transfers_.pop_front();
+        delivering_ = true;
+        lock.unlock(); // the handler may call back into the transport
+        handler_(transfer.first, transfer.second.data(), transfer.second.size());
+        lock.lock();
+        delivering_ = false;
+        changed_.notify_all();
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "IrTransport.h"
+
+/// Transport without a device for tests and demos. Data given to inject() is split into IN transfers and delivered
+/// from an own thread like a real transport does, the control requests are answered by a handler and the bulk OUT data
+/// is recorded.
+class MockTransport final : public IrTransport
+{
+public:
+    /// Answers a control request: in = device to host, the data of an OUT request is given, the one of an IN request has
+    /// to be filled (up to the requested size). Returns false to stall the request.
+    using ControlHandler = std::function<bool(bool in, std::uint8_t request, std::uint16_t value, std::uint16_t index, std::vector<std::uint8_t>& data)>;
+
+    MockTransport() = default;
+    MockTransport(const MockTransport&) = delete;
+    MockTransport& operator=(const MockTransport&) = delete;
+    virtual ~MockTransport() override;
+
+    void setControlHandler(ControlHandler handler) { controlHandler_ = std::move(handler); }
+
+    /// Queue data sent by the simulated device on the endpoint
+    void inject(const std::uint8_t* data, std::size_t size, std::uint8_t endpoint = BULK_IN_ENDPOINT);
+
+    /// Wait until all injected data was delivered to the handler
+    void flush();
+
+    /// Take the data written to the bulk OUT endpoint so far (one entry per write)
+    std::vector<std::vector<std::uint8_t>> takeWritten();
+
+    /// The simulated device never fails, the error handler is not used
+    virtual bool start(DataHandler dataHandler, ErrorHandler errorHandler) override;
+    virtual void stop() override;
+    virtual int controlIn(std::uint8_t request, std::uint16_t value, std::uint16_t index, std::uint8_t* data, std::uint16_t size) override;
+    virtual int controlOut(std::uint8_t request, std::uint16_t value, std::uint16_t index, const std::uint8_t* data, std::uint16_t size) override;
+    virtual bool write(const std::uint8_t* data, std::size_t size) override;
+
+private:
+    ControlHandler controlHandler_{};
+    DataHandler handler_{};
+    std::thread thread_{};
+    std::mutex mutex_{};
+    std::condition_variable changed_{};
+    bool running_{false};
+    bool delivering_{false};
+    std::deque<std::pair<std::uint8_t, std::vector<std::uint8_t>>> transfers_{}; ///< Endpoint and data
+    std::vector<std::vector<std::uint8_t>> written_{};
+
+    void eventLoop();
+};
@@ -0,0 +1,79 @@
+#include "FlashMock.h"
+#include <stdexcept>
+
+FlashMock::FlashMock(std::size_t sectorCount) :
+data_(sectorCount * SECTOR_SIZE, 0xFF),
+eraseCounts_(sectorCount, 0)
+{
+}
+
+void FlashMock::eraseSector(std::size_t offset)
+{
+    if((offset % SECTOR_SIZE) != 0 || (offset >= data_.size()))
+    {
+        throw std::out_of_range{"erase outside of the flash"};
+    }
+    if(powerLost_)
+    {
+        return;
+    }
+
+    eraseCounts_[offset / SECTOR_SIZE]++;
+    for(std::size_t i = 0; i < SECTOR_SIZE; i++)
+    {
+        if(!writeByte())
+        {
+            return;
+        }
+        data_[offset + i] = 0xFF;
+    }
+}
+
+void FlashMock::program(std::size_t offset, etl::span<const std::uint8_t> data)
+{
+    if(offset + data.size() > data_.size())
+    {
+        throw std::out_of_range{"program outside of the flash"};
+    }
+    if(powerLost_)
+    {
+        return;
+    }
+
+    for(std::size_t i = 0; i < data.size(); i++)
+    {
+        if(!writeByte())
+        {
+            data_[offset + i] &= data[i] | 0x0F; // half programmed byte
+            return;
+        }
+        data_[offset + i] &= data[i];
+    }
+}
+
+void FlashMock::schedulePowerFailure(std::size_t byteCount)
+{
+    failureScheduled_ = true;
+    remainingBytes_ = byteCount;
+}
+
+void FlashMock::powerOn()
+{
+    failureScheduled_ = false;
+    powerLost_ = false;
+}
+
+bool FlashMock::writeByte()
+{
+    if(!failureScheduled_)
+    {
+        return true;
+    }
+    if(remainingBytes_ == 0)
+    {
+        powerLost_ = true;
+        return false;
+    }
+    remainingBytes_--;
+    return true;
+}
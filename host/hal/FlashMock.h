@@ -0,0 +1,41 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "FlashInterface.h"
+
+/// Flash in RAM with the behaviour of NOR flash: erasing sets all bits of a sector, programming can only clear bits.
+/// A power failure can be scheduled after a number of written bytes (erased or programmed), the operation in progress
+/// stops in the middle and all later ones are ignored until powerOn().
+class FlashMock final : public FlashInterface
+{
+public:
+    explicit FlashMock(std::size_t sectorCount);
+
+    virtual std::size_t getSize() const override { return data_.size(); }
+    virtual const std::uint8_t* getData() const override { return data_.data(); }
+    virtual void eraseSector(std::size_t offset) override;
+    virtual void program(std::size_t offset, etl::span<const std::uint8_t> data) override;
+
+    /// Lose the power after the given number of bytes were written
+    void schedulePowerFailure(std::size_t byteCount);
+
+    /// True if the scheduled power failure happened
+    bool isPowerLost() const { return powerLost_; }
+
+    /// Restore the power and cancel a scheduled failure, the content stays as it is
+    void powerOn();
+
+    /// Number of erases of the sector so far
+    std::uint32_t getEraseCount(std::size_t sector) const { return eraseCounts_[sector]; }
+
+private:
+    std::vector<std::uint8_t> data_;
+    std::vector<std::uint32_t> eraseCounts_;
+    bool failureScheduled_{false};
+    bool powerLost_{false};
+    std::size_t remainingBytes_{0};
+
+    /// Count one written byte, false if the power is lost before it
+    bool writeByte();
+};
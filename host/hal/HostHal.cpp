@@ -0,0 +1,30 @@
+#include "HostHal.h"
+#include "pico/stdlib.h"
+
+namespace
+{
+    std::uint64_t timeUs{0};
+}
+
+std::uint64_t time_us_64()
+{
+    return timeUs;
+}
+
+namespace HostHal
+{
+    std::uint64_t getTimeUs()
+    {
+        return timeUs;
+    }
+
+    void advanceTimeUs(std::uint64_t deltaUs)
+    {
+        timeUs += deltaUs;
+    }
+
+    void reset()
+    {
+        timeUs = 0;
+    }
+}
@@ -0,0 +1,15 @@
+#pragma once
+#include <cstdint>
+
+/// Control of the simulated hardware used by the host build
+namespace HostHal
+{
+    /// Current simulated time in µs (what time_us_64() returns)
+    std::uint64_t getTimeUs();
+
+    /// Advance the simulated time
+    void advanceTimeUs(std::uint64_t deltaUs);
+
+    /// Reset the time to zero
+    void reset();
+}
@@ -0,0 +1,9 @@
+#pragma once
+// Host shim for the parts of the Pico SDK used by the decoder, see HostHal.h
+
+#include <cstdint>
+#include <cstdio>
+
+typedef unsigned int uint;
+
+std::uint64_t time_us_64();
@@ -0,0 +1,53 @@
+#pragma once
+#include "EdgeSourceGpio.h"
+#include "EdgeSourcePio.h"
+#include "IrDecoder.h"
+#include "IrProtocol.h"
+#include "LedGpio.h"
+#include "LedWS2812.h"
+
+/// Hardware of the supported boards. Everything that differs between them is a constant or a type, so the pins are
+/// folded into the code, the LED is used through its concrete class and the decoder only contains the protocols
+/// of the board. The board is selected with IR_BOARD (CMake cache variable).
+namespace Boards
+{
+    /// RP2040-One: receiver on pin 12, IR LED on pin 13, WS2812B LED on pin 16
+    struct Rp2040One
+    {
+        static constexpr unsigned int RECEIVER_PIN{12};
+        static constexpr bool RECEIVER_IDLE_HIGH{true};
+        static constexpr unsigned int TRANSMITTER_PIN{13};
+        static constexpr unsigned int LED_PIN{16};
+
+        using Led = LedWS2812;
+        using EdgeSource = EdgeSourcePio; // measure the pulses with PIO + DMA instead of one GPIO interrupt per edge
+        using Decoder = IrDecoderAll;
+    };
+
+    /// Pi Pico: receiver on pin 22, IR LED on pin 21, normal LED on pin 25
+    struct PiPico
+    {
+        static constexpr unsigned int RECEIVER_PIN{22};
+        static constexpr bool RECEIVER_IDLE_HIGH{true};
+        static constexpr unsigned int TRANSMITTER_PIN{21};
+        static constexpr unsigned int LED_PIN{25};
+
+        using Led = LedGpio;
+        using EdgeSource = EdgeSourcePio;
+        using Decoder = IrDecoderAll;
+    };
+
+    /// RP2040-One for NEC remotes only (e.g. the common 21 key remotes), the smallest decoder
+    struct Rp2040OneNec : Rp2040One
+    {
+        using Decoder = IrDecoderFor<IrProtocols::NEC>;
+    };
+}
+
+#if defined(IR_BOARD_PICO)
+using Board = Boards::PiPico;
+#elif defined(IR_BOARD_RP2040ONE_NEC)
+using Board = Boards::Rp2040OneNec;
+#else
+using Board = Boards::Rp2040One;
+#endif
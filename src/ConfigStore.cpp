@@ -0,0 +1,182 @@
+#include "ConfigStore.h"
+#include <cstring>
+#include "etl/crc32.h"
+
+void ConfigStore::initialize()
+{
+    sectorCount_ = flash_.getSize() / SECTOR_SIZE;
+    index_.fill(0);
+
+    bool found{false};
+    for(std::size_t sector = 0; sector < sectorCount_; sector++)
+    {
+        SectorHeader header;
+        if(readSectorHeader(sector, header) && (!found || (static_cast<std::int32_t>(header.sequence - sequence_) > 0)))
+        {
+            found = true;
+            activeSector_ = sector;
+            sequence_ = header.sequence;
+        }
+    }
+
+    if(!found) // empty flash, the first write starts with the first sector
+    {
+        activeSector_ = sectorCount_ - 1;
+        sequence_ = 0;
+        writeOffset_ = SECTOR_SIZE;
+        return;
+    }
+    scan();
+}
+
+etl::span<const std::uint8_t> ConfigStore::read(std::uint16_t key) const
+{
+    if((key >= MAX_KEYS) || (index_[key] == 0))
+    {
+        return {};
+    }
+    const RecordHeader header{readRecordHeader(activeSector_, index_[key])};
+    return etl::span<const std::uint8_t>{getSector(activeSector_) + index_[key] + sizeof(RecordHeader), header.length};
+}
+
+bool ConfigStore::write(std::uint16_t key, etl::span<const std::uint8_t> value)
+{
+    if((key >= MAX_KEYS) || (value.size() > MAX_VALUE_SIZE))
+    {
+        return false;
+    }
+
+    const etl::span<const std::uint8_t> current{read(key)};
+    if((current.size() == value.size()) && (std::memcmp(current.data(), value.data(), value.size()) == 0)) // save the erase cycles
+    {
+        return true;
+    }
+
+    // the sector is full or the record could not be written, continue in the next sector
+    return append(key, value) || (compact() && append(key, value));
+}
+
+bool ConfigStore::readSectorHeader(std::size_t sector, SectorHeader& header) const
+{
+    std::memcpy(&header, getSector(sector), sizeof(header));
+    return header.magic == MAGIC;
+}
+
+ConfigStore::RecordHeader ConfigStore::readRecordHeader(std::size_t sector, std::size_t offset) const
+{
+    RecordHeader header;
+    std::memcpy(&header, getSector(sector) + offset, sizeof(header));
+    return header;
+}
+
+void ConfigStore::scan()
+{
+    std::size_t offset{sizeof(SectorHeader)};
+    while(offset + sizeof(RecordHeader) <= SECTOR_SIZE)
+    {
+        const RecordHeader header{readRecordHeader(activeSector_, offset)};
+        if(header.key == ERASED_KEY) // end of the log
+        {
+            break;
+        }
+
+        const std::size_t size{getRecordSize(header.length)};
+        if((header.key >= MAX_KEYS) || (header.length > MAX_VALUE_SIZE) || (offset + size > SECTOR_SIZE) ||
+           (header.crc != calculateCrc(header.key, etl::span<const std::uint8_t>{getSector(activeSector_) + offset + sizeof(RecordHeader), header.length})))
+        {
+            offset = SECTOR_SIZE; // interrupted write, nothing can be appended behind it
+            break;
+        }
+
+        index_[header.key] = static_cast<std::uint16_t>((header.length != 0) ? offset : 0);
+        offset += size;
+    }
+    writeOffset_ = offset;
+}
+
+bool ConfigStore::append(std::uint16_t key, etl::span<const std::uint8_t> value)
+{
+    const std::size_t size{sizeof(RecordHeader) + value.size()};
+    if(writeOffset_ + size > SECTOR_SIZE)
+    {
+        return false;
+    }
+
+    const RecordHeader header{key, static_cast<std::uint16_t>(value.size()), calculateCrc(key, value)};
+    std::memcpy(buffer_.data(), &header, sizeof(header));
+    std::memcpy(buffer_.data() + sizeof(header), value.data(), value.size());
+
+    const std::size_t offset{writeOffset_};
+    writeOffset_ += getRecordSize(value.size());
+    flash_.program(activeSector_ * SECTOR_SIZE + offset, etl::span<const std::uint8_t>{buffer_.data(), size});
+    if(std::memcmp(getSector(activeSector_) + offset, buffer_.data(), size) != 0) // not erased before (interrupted write)
+    {
+        writeOffset_ = SECTOR_SIZE;
+        return false;
+    }
+
+    index_[key] = static_cast<std::uint16_t>(value.empty() ? 0 : offset);
+    return true;
+}
+
+bool ConfigStore::compact()
+{
+    if(sectorCount_ < 2)
+    {
+        return false;
+    }
+
+    const std::size_t target{(activeSector_ + 1) % sectorCount_};
+    flash_.eraseSector(target * SECTOR_SIZE);
+
+    etl::array<std::uint16_t, MAX_KEYS> index{};
+    std::size_t offset{sizeof(SectorHeader)};
+    for(std::uint16_t key = 0; key < MAX_KEYS; key++)
+    {
+        if(index_[key] == 0)
+        {
+            continue;
+        }
+
+        const std::size_t size{sizeof(RecordHeader) + readRecordHeader(activeSector_, index_[key]).length};
+        if(offset + size > SECTOR_SIZE)
+        {
+            return false;
+        }
+        std::memcpy(buffer_.data(), getSector(activeSector_) + index_[key], size);
+        flash_.program(target * SECTOR_SIZE + offset, etl::span<const std::uint8_t>{buffer_.data(), size});
+        if(std::memcmp(getSector(target) + offset, buffer_.data(), size) != 0)
+        {
+            return false;
+        }
+        index[key] = static_cast<std::uint16_t>(offset);
+        offset += getRecordSize(size - sizeof(RecordHeader));
+    }
+
+    // the header makes the new sector the active one, before that the old sector stays valid.
+    // The magic is written after the sequence, an interrupted header never has a valid magic with a wrong sequence.
+    const SectorHeader header{MAGIC, sequence_ + 1};
+    std::memcpy(buffer_.data(), &header, sizeof(header));
+    flash_.program(target * SECTOR_SIZE + offsetof(SectorHeader, sequence), etl::span<const std::uint8_t>{buffer_.data() + offsetof(SectorHeader, sequence), sizeof(header.sequence)});
+    flash_.program(target * SECTOR_SIZE + offsetof(SectorHeader, magic), etl::span<const std::uint8_t>{buffer_.data() + offsetof(SectorHeader, magic), sizeof(header.magic)});
+    if(std::memcmp(getSector(target), buffer_.data(), sizeof(header)) != 0)
+    {
+        return false;
+    }
+
+    activeSector_ = target;
+    sequence_++;
+    index_ = index;
+    writeOffset_ = offset;
+    return true;
+}
+
+std::uint32_t ConfigStore::calculateCrc(std::uint16_t key, etl::span<const std::uint8_t> value)
+{
+    const std::uint16_t length{static_cast<std::uint16_t>(value.size())};
+    etl::crc32 crc;
+    crc.add(reinterpret_cast<const std::uint8_t*>(&key), reinterpret_cast<const std::uint8_t*>(&key) + sizeof(key));
+    crc.add(reinterpret_cast<const std::uint8_t*>(&length), reinterpret_cast<const std::uint8_t*>(&length) + sizeof(length));
+    crc.add(value.data(), value.data() + value.size());
+    return crc.value();
+}
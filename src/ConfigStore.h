@@ -0,0 +1,70 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "etl/array.h"
+#include "etl/span.h"
+#include "FlashInterface.h"
+
+/// Log structured key / value store in a flash region of a few sectors.
+/// Every write appends a record (header with key, length and CRC, followed by the value) to the active sector, the
+/// latest record of a key is valid. When the sector is full, the latest values are copied to the next sector
+/// (round robin, so all sectors are erased equally often) and its header is written last, so an interrupted
+/// compaction leaves the old sector active. Records with a wrong CRC (interrupted write) close the sector.
+/// Values are read in place (memory mapped) through an index of the latest record per key, built once at boot.
+class ConfigStore
+{
+public:
+    static constexpr std::size_t MAX_KEYS{32};
+    static constexpr std::size_t MAX_VALUE_SIZE{1024};
+
+    explicit ConfigStore(FlashInterface& flash) :
+    flash_{flash}
+    {}
+
+    /// Find the active sector and build the index, call once before any other function
+    void initialize();
+
+    /// Latest value of the key, empty if not set. Points into the flash and is valid until the next write.
+    etl::span<const std::uint8_t> read(std::uint16_t key) const;
+
+    /// Store a new value, an empty value deletes the key. Returns false if the store is full or the flash failed.
+    bool write(std::uint16_t key, etl::span<const std::uint8_t> value);
+
+    /// Number of compactions so far (each one erased one sector)
+    std::uint32_t getSequence() const { return sequence_; }
+
+private:
+    struct SectorHeader
+    {
+        std::uint32_t magic;
+        std::uint32_t sequence; ///< Incremented with every compaction, the sector with the highest one is active
+    };
+
+    struct RecordHeader
+    {
+        std::uint16_t key;
+        std::uint16_t length;
+        std::uint32_t crc;      ///< CRC32 of key, length and value
+    };
+
+    static constexpr std::uint32_t MAGIC{0x47464349}; // "ICFG"
+    static constexpr std::uint16_t ERASED_KEY{0xFFFF};
+    static constexpr std::size_t SECTOR_SIZE{FlashInterface::SECTOR_SIZE};
+
+    FlashInterface& flash_;
+    std::size_t sectorCount_{0};
+    std::size_t activeSector_{0};
+    std::uint32_t sequence_{0};
+    std::size_t writeOffset_{SECTOR_SIZE};             ///< Offset of the next record in the active sector
+    etl::array<std::uint16_t, MAX_KEYS> index_{};      ///< Offset of the latest record of every key in the active sector, 0 if not set
+    etl::array<std::uint8_t, sizeof(RecordHeader) + MAX_VALUE_SIZE> buffer_{}; ///< The flash cannot be programmed from itself
+
+    bool readSectorHeader(std::size_t sector, SectorHeader& header) const;
+    RecordHeader readRecordHeader(std::size_t sector, std::size_t offset) const;
+    const std::uint8_t* getSector(std::size_t sector) const { return flash_.getData() + sector * SECTOR_SIZE; }
+    void scan();
+    bool append(std::uint16_t key, etl::span<const std::uint8_t> value);
+    bool compact();
+    static std::uint32_t calculateCrc(std::uint16_t key, etl::span<const std::uint8_t> value);
+    static constexpr std::size_t getRecordSize(std::size_t length) { return (sizeof(RecordHeader) + length + 3) & ~static_cast<std::size_t>(3); }
+};
@@ -0,0 +1,113 @@
+#include "Diagnostics.h"
+
+#include <cstring>
+
+#include "VendorControl.h"
+
+void Diagnostics::addReceiver(const EdgeSourceInterface& edgeSource, const IrDecoder& decoder)
+{
+    if(receiverCount_ < receivers_.size())
+    {
+        receivers_[receiverCount_++] = Receiver{&edgeSource, &decoder};
+    }
+}
+
+bool Diagnostics::handleRequest(std::uint8_t rhport, std::uint8_t stage, const tusb_control_request_t& request)
+{
+    if(stage != CONTROL_STAGE_SETUP)
+    {
+        return true;
+    }
+
+    const bool validReceiver{request.wIndex < receiverCount_};
+    std::uint16_t size{0};
+    switch(static_cast<VendorRequest>(request.bRequest))
+    {
+    case VendorRequest::GET_STATISTICS:
+        if(!validReceiver) return false;
+        size = createStatistics(receivers_[request.wIndex]);
+        break;
+
+    case VendorRequest::GET_TRACE:
+        if(!validReceiver) return false;
+        size = createTrace(receivers_[request.wIndex]);
+        break;
+
+    case VendorRequest::GET_HISTOGRAMS:
+        size = createHistograms();
+        break;
+
+    case VendorRequest::RESET_HISTOGRAMS:
+        histograms_.reset();
+        return tud_control_status(rhport, &request);
+
+    default:
+        return false;
+    }
+    return tud_control_xfer(rhport, &request, response_.data(), size);
+}
+
+std::uint16_t Diagnostics::createStatistics(const Receiver& receiver)
+{
+    const IrDecoder::Statistics& statistics{receiver.decoder->getStatistics()};
+    const UsbStatisticsReport report
+    {
+        .frames = statistics.frames,
+        .repeats = statistics.repeats,
+        .invalidHeader = statistics.invalidHeader,
+        .invalidBit = statistics.invalidBit,
+        .invalidChecksum = statistics.invalidChecksum,
+        .eventOverflows = receiver.decoder->getOverflowCount(),
+        .droppedEvents = reporter_.getDroppedCount(),
+        .captureOverruns = receiver.edgeSource->getOverrunCount(),
+        .corrected = statistics.corrected
+    };
+    std::memcpy(response_.data(), &report, sizeof(report));
+    return static_cast<std::uint16_t>(sizeof(report));
+}
+
+std::uint16_t Diagnostics::createTrace(const Receiver& receiver)
+{
+    std::uint32_t writeCount{0};
+    const std::size_t count{receiver.decoder->getTrace().snapshot(trace_, writeCount)};
+    const UsbTraceReportHeader header{writeCount};
+    std::memcpy(response_.data(), &header, sizeof(header));
+
+    std::size_t size{sizeof(header)};
+    for(std::size_t i = 0; i < count; i++)
+    {
+        const UsbTraceEntry entry
+        {
+            .timestampUs = trace_[i].timestampUs,
+            .event = static_cast<std::uint8_t>(trace_[i].event),
+            .value = trace_[i].value,
+            .reserved = 0
+        };
+        std::memcpy(response_.data() + size, &entry, sizeof(entry));
+        size += sizeof(entry);
+    }
+    return static_cast<std::uint16_t>(size);
+}
+
+std::uint16_t Diagnostics::createHistograms()
+{
+    const UsbHistogramReportHeader header
+    {
+        .histogramCount = static_cast<std::uint8_t>(HISTOGRAM_COUNT),
+        .bucketCount = static_cast<std::uint8_t>(LatencyHistograms::BUCKETS),
+        .reserved = 0
+    };
+    std::memcpy(response_.data(), &header, sizeof(header));
+
+    std::size_t size{sizeof(header)};
+    for(const Histogram<LatencyHistograms::BUCKETS>* histogram : {&histograms_.isrCycles, &histograms_.edgeToReadyUs, &histograms_.readyToUsbUs})
+    {
+        for(std::size_t i = 0; i < histogram->size(); i++)
+        {
+            const std::uint32_t count{histogram->getBucket(i)};
+            std::memcpy(response_.data() + size, &count, sizeof(count));
+            size += sizeof(count);
+        }
+    }
+    return static_cast<std::uint16_t>(size);
+}
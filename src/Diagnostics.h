@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdint>
+#include "etl/array.h"
+#include "EdgeSourceInterface.h"
+#include "EventReporter.h"
+#include "IrDecoder.h"
+#include "LatencyHistograms.h"
+#include "tusb.h"
+#include "UsbReport.h"
+
+/// Answers the diagnostic vendor requests with the counters and the trace of the decoder path.
+/// The counters and the trace are per receiver, the receiver is selected by wIndex of the request.
+class Diagnostics
+{
+public:
+    static constexpr std::size_t MAX_RECEIVERS{4};
+
+    Diagnostics(const EventReporter& reporter, LatencyHistograms& histograms) :
+    reporter_{reporter},
+    histograms_{histograms}
+    {}
+
+    /// Add a receiver, the first one gets index 0
+    void addReceiver(const EdgeSourceInterface& edgeSource, const IrDecoder& decoder);
+
+    /// Handler for VendorRequest::GET_STATISTICS, GET_TRACE, GET_HISTOGRAMS and RESET_HISTOGRAMS
+    bool handleRequest(std::uint8_t rhport, std::uint8_t stage, const tusb_control_request_t& request);
+
+private:
+    static constexpr std::size_t HISTOGRAM_COUNT{3};
+    static constexpr std::size_t MAX_TRACE_SIZE{sizeof(UsbTraceReportHeader) + IrDecoder::TRACE_SIZE * sizeof(UsbTraceEntry)};
+    static constexpr std::size_t HISTOGRAMS_SIZE{sizeof(UsbHistogramReportHeader) + HISTOGRAM_COUNT * LatencyHistograms::BUCKETS * sizeof(std::uint32_t)};
+    static constexpr std::size_t MAX_RESPONSE_SIZE{(MAX_TRACE_SIZE > HISTOGRAMS_SIZE) ? MAX_TRACE_SIZE : HISTOGRAMS_SIZE};
+
+    struct Receiver
+    {
+        const EdgeSourceInterface* edgeSource;
+        const IrDecoder* decoder;
+    };
+
+    etl::array<Receiver, MAX_RECEIVERS> receivers_{};
+    std::size_t receiverCount_{0};
+    const EventReporter& reporter_;
+    LatencyHistograms& histograms_;
+    etl::array<IrDecoder::TraceEntry, IrDecoder::TRACE_SIZE> trace_{};
+    etl::array<std::uint8_t, MAX_RESPONSE_SIZE> response_{}; ///< Must stay valid until the control transfer is done
+
+    std::uint16_t createStatistics(const Receiver& receiver);
+    std::uint16_t createTrace(const Receiver& receiver);
+    std::uint16_t createHistograms();
+};
@@ -0,0 +1,74 @@
+#include "EdgeSourceGpio.h"
+#include "pico/stdlib.h"
+
+etl::array<EdgeSourceGpio*, NUM_BANK0_GPIOS> EdgeSourceGpio::instances_{};
+etl::array<EdgeSourceGpio*, EdgeSourceGpio::MAX_ALARMS> EdgeSourceGpio::alarmInstances_{};
+
+void EdgeSourceGpio::gpioCallbackTrampoline(unsigned int pin, std::uint32_t events)
+{
+    EdgeSourceGpio* const instance{(pin < instances_.size()) ? instances_[pin] : nullptr};
+    if(instance != nullptr)
+    {
+        instance->gpioCallbackFunction(events);
+    }
+}
+
+void EdgeSourceGpio::alarmCallbackTrampoline(unsigned int alarm)
+{
+    EdgeSourceGpio* const instance{(alarm < alarmInstances_.size()) ? alarmInstances_[alarm] : nullptr};
+    if(instance != nullptr)
+    {
+        instance->alarmCallbackFunction();
+    }
+}
+
+void EdgeSourceGpio::initialize(PulseHandler pulseHandler)
+{
+    pulseHandler_ = pulseHandler;
+    instances_[pin_] = this;
+
+    gpio_init(pin_);
+    gpio_set_dir(pin_, GPIO_IN);
+    if(withPull_)
+    {
+        gpio_set_pulls(pin_, invert_, !invert_);
+    }
+    else
+    {
+        gpio_disable_pulls(pin_);
+    }
+
+    // claimed once, so the end of frame detection cannot run out of alarms later
+    alarm_ = static_cast<unsigned int>(hardware_alarm_claim_unused(true));
+    alarmInstances_[alarm_] = this;
+    hardware_alarm_set_callback(alarm_, &EdgeSourceGpio::alarmCallbackTrampoline);
+
+    lastTimeStamp_ = time_us_64();
+    gpio_set_irq_enabled_with_callback(pin_, GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL, true, &EdgeSourceGpio::gpioCallbackTrampoline);
+}
+
+void EdgeSourceGpio::gpioCallbackFunction(std::uint32_t events)
+{
+    const std::uint64_t currentTimeStamp = time_us_64();
+    // level after the edge, true if the carrier is present now -> the finished period was the opposite
+    const bool level{static_cast<bool>(invert_ ? events & GPIO_IRQ_EDGE_FALL : events & GPIO_IRQ_EDGE_RISE)};
+    const IrPulse pulse{static_cast<std::uint32_t>(currentTimeStamp - lastTimeStamp_), !level};
+    lastTimeStamp_ = currentTimeStamp;
+    hardware_alarm_set_target(alarm_, from_us_since_boot(currentTimeStamp + IDLE_TIME_US));
+
+    if(pulseHandler_.is_valid())
+    {
+        pulseHandler_(etl::span<const IrPulse>{&pulse, 1}, currentTimeStamp);
+    }
+}
+
+void EdgeSourceGpio::alarmCallbackFunction()
+{
+    // the alarm also fires after a long mark (stuck receiver), only a space is the end of a frame
+    const std::uint64_t currentTimeStamp = time_us_64();
+    const bool mark{gpio_get(pin_) != invert_};
+    if(!mark && ((currentTimeStamp - lastTimeStamp_) >= IDLE_TIME_US) && pulseHandler_.is_valid())
+    {
+        pulseHandler_(etl::span<const IrPulse>{}, currentTimeStamp);
+    }
+}
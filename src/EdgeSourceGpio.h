@@ -0,0 +1,39 @@
+#pragma once
+#include <cstdint>
+#include "etl/array.h"
+#include "hardware/gpio.h"
+#include "hardware/timer.h"
+#include "EdgeSourceInterface.h"
+
+/// Edge source using the GPIO interrupt, one interrupt and one pulse per edge.
+/// The GPIO interrupt callback is shared by all pins, it is dispatched to the instance of the pin with a table lookup.
+/// The end of a frame is detected with a hardware alarm of the timer (one per instance) which is moved with every edge.
+class EdgeSourceGpio final : public EdgeSourceInterface
+{
+public:
+    EdgeSourceGpio(const unsigned int pin, const bool idleHigh = false, const bool withPull = true) :
+    pin_{pin},
+    invert_{idleHigh},
+    withPull_{withPull}
+    {}
+
+    virtual void initialize(PulseHandler pulseHandler) override;
+
+private:
+    static constexpr std::uint32_t IDLE_TIME_US{8000}; // same as the PIO capture
+    static constexpr std::size_t MAX_ALARMS{4};        // hardware alarms of the timer
+
+    const unsigned int pin_;
+    const bool invert_;
+    const bool withPull_;
+    PulseHandler pulseHandler_{};
+    std::uint64_t lastTimeStamp_{0};
+    unsigned int alarm_{0};
+    static etl::array<EdgeSourceGpio*, NUM_BANK0_GPIOS> instances_;
+    static etl::array<EdgeSourceGpio*, MAX_ALARMS> alarmInstances_;
+
+    void gpioCallbackFunction(std::uint32_t events);
+    void alarmCallbackFunction();
+    static void gpioCallbackTrampoline(unsigned int gpio, std::uint32_t events);
+    static void alarmCallbackTrampoline(unsigned int alarm);
+};
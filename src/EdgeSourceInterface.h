@@ -0,0 +1,25 @@
+#pragma once
+#include <cstdint>
+#include "etl/delegate.h"
+#include "etl/span.h"
+
+/// One completed period of the demodulated IR signal
+struct IrPulse
+{
+    std::uint32_t durationUs; ///< Length of the period in µs
+    bool mark;                ///< True if the IR carrier was present (receiver active), false for a space
+};
+
+class EdgeSourceInterface
+{
+public:
+    /// Completed pulses and the time (time_us_64) at the end of the last one.
+    /// An empty span signals that the signal is a space since at least the idle time of the edge source (end of frame).
+    using PulseHandler = etl::delegate<void(etl::span<const IrPulse>, std::uint64_t)>;
+
+    /// Start the capture, completed pulses are passed to the handler (from interrupt context)
+    virtual void initialize(PulseHandler pulseHandler) = 0;
+
+    /// Number of pulses lost because the capture could not keep up
+    virtual std::uint32_t getOverrunCount() const { return 0; }
+};
@@ -0,0 +1,141 @@
+#include "EdgeSourcePio.h"
+#include "ir_capture.pio.h"
+
+#include "pico/stdlib.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+
+etl::array<EdgeSourcePio*, NUM_PIOS * NUM_PIO_STATE_MACHINES> EdgeSourcePio::instances_{};
+etl::array<unsigned int, NUM_PIOS> EdgeSourcePio::programOffsets_{};
+
+void EdgeSourcePio::initialize(PulseHandler pulseHandler)
+{
+    pulseHandler_ = pulseHandler;
+
+    gpio_init(pin_);
+    gpio_set_dir(pin_, GPIO_IN);
+    if(withPull_)
+    {
+        gpio_set_pulls(pin_, invert_, !invert_);
+    }
+    else
+    {
+        gpio_disable_pulls(pin_);
+    }
+    // the PIO program expects a 1 while the carrier is present
+    gpio_set_inover(pin_, invert_ ? GPIO_OVERRIDE_INVERT : GPIO_OVERRIDE_NORMAL);
+
+    // the first instance on a PIO loads the program and installs the interrupt handler, the others share them
+    const unsigned int pioIndex{pio_get_index(pio_)};
+    bool firstOnPio{true};
+    for(unsigned int i = 0; i < NUM_PIO_STATE_MACHINES; i++)
+    {
+        firstOnPio = firstOnPio && (instances_[pioIndex * NUM_PIO_STATE_MACHINES + i] == nullptr);
+    }
+
+    sm_ = static_cast<unsigned int>(pio_claim_unused_sm(pio_, true));
+    if(firstOnPio)
+    {
+        programOffsets_[pioIndex] = pio_add_program(pio_, &ir_capture_program);
+    }
+
+    // move every measured pulse into the ring buffer, the counter is large enough to never run out in practice
+    dmaChannel_ = static_cast<unsigned int>(dma_claim_unused_channel(true));
+    dma_channel_config dmaConfig{dma_channel_get_default_config(dmaChannel_)};
+    channel_config_set_transfer_data_size(&dmaConfig, DMA_SIZE_32);
+    channel_config_set_read_increment(&dmaConfig, false);
+    channel_config_set_write_increment(&dmaConfig, true);
+    channel_config_set_ring(&dmaConfig, true, RING_SIZE_BITS);
+    channel_config_set_dreq(&dmaConfig, pio_get_dreq(pio_, sm_, false));
+    dma_channel_configure(dmaChannel_, &dmaConfig, ring_.data(), &pio_->rxf[sm_], DMA_TRANSFER_COUNT, true);
+
+    // one interrupt per frame, raised by the state machine after the idle time
+    instances_[pioIndex * NUM_PIO_STATE_MACHINES + sm_] = this;
+
+    const unsigned int irq{(pioIndex == 0) ? PIO0_IRQ_0 : PIO1_IRQ_0};
+    pio_set_irq0_source_enabled(pio_, static_cast<pio_interrupt_source>(pis_interrupt0 + sm_), true);
+    if(firstOnPio)
+    {
+        irq_add_shared_handler(irq, (pioIndex == 0) ? &EdgeSourcePio::irqHandlerPio0 : &EdgeSourcePio::irqHandlerPio1, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+        irq_set_enabled(irq, true);
+    }
+
+    ir_capture_program_init(pio_, sm_, programOffsets_[pioIndex], pin_, 1000000.0f);
+    pio_sm_put_blocking(pio_, sm_, ~FRAME_GAP_US);
+}
+
+void EdgeSourcePio::poll()
+{
+    // the current period is still running, so the end of the last pulse is not exactly known
+    drain(time_us_64());
+}
+
+void EdgeSourcePio::drain(std::uint64_t endTimeUs)
+{
+    const std::uint32_t writeCount{DMA_TRANSFER_COUNT - dma_channel_hw_addr(dmaChannel_)->transfer_count};
+    __compiler_memory_barrier();
+
+    if((writeCount - readCount_) > RING_SIZE) // the DMA has overwritten data which was not read yet
+    {
+        overrunCount_ += writeCount - readCount_ - RING_SIZE;
+        readCount_ = writeCount - RING_SIZE;
+    }
+
+    // time stamp of every batch = start of the pending pulses + the pulses up to the end of the batch
+    std::uint64_t pendingUs{0};
+    for(std::uint32_t i = readCount_; i != writeCount; i++)
+    {
+        pendingUs += ir_capture_word_ticks(ring_[i % RING_SIZE]);
+    }
+    std::uint64_t batchEndUs{endTimeUs - pendingUs};
+
+    etl::array<IrPulse, BATCH_SIZE> batch;
+    while(readCount_ != writeCount)
+    {
+        std::size_t count{0};
+        while((readCount_ != writeCount) && (count < batch.size()))
+        {
+            const std::uint32_t word{ring_[readCount_ % RING_SIZE]};
+            batch[count] = IrPulse{ir_capture_word_ticks(word), ir_capture_word_is_mark(word)};
+            batchEndUs += batch[count].durationUs;
+            count++;
+            readCount_++;
+        }
+
+        if(pulseHandler_.is_valid())
+        {
+            pulseHandler_(etl::span<const IrPulse>{batch.data(), count}, batchEndUs);
+        }
+    }
+}
+
+void EdgeSourcePio::handleIrq(PIO pio)
+{
+    // the state machine of each instance raises the (relative) flag with its own number
+    const unsigned int pioIndex{pio_get_index(pio)};
+    for(unsigned int sm = 0; sm < NUM_PIO_STATE_MACHINES; sm++)
+    {
+        EdgeSourcePio* const instance{instances_[pioIndex * NUM_PIO_STATE_MACHINES + sm]};
+        if((instance != nullptr) && pio_interrupt_get(pio, sm))
+        {
+            pio_interrupt_clear(pio, sm);
+            // the interrupt is raised when the space after the last pulse reached the frame gap
+            const std::uint64_t nowUs{time_us_64()};
+            instance->drain(nowUs - FRAME_GAP_US);
+            if(instance->pulseHandler_.is_valid())
+            {
+                instance->pulseHandler_(etl::span<const IrPulse>{}, nowUs);
+            }
+        }
+    }
+}
+
+void EdgeSourcePio::irqHandlerPio0()
+{
+    handleIrq(pio0);
+}
+
+void EdgeSourcePio::irqHandlerPio1()
+{
+    handleIrq(pio1);
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <cstdint>
+#include "etl/array.h"
+#include "hardware/pio.h"
+#include "EdgeSourceInterface.h"
+
+/// Edge source using a PIO state machine to measure the pulses and a DMA channel to store them in a ring buffer.
+/// The CPU is only interrupted once per frame (when the signal is idle again) to drain the buffer.
+/// Several instances (one state machine each) share the interrupt of their PIO, it is dispatched by the state machine flags.
+class EdgeSourcePio final : public EdgeSourceInterface
+{
+public:
+    EdgeSourcePio(const unsigned int pin, const bool idleHigh = false, const bool withPull = true, const PIO pio = pio1) :
+    pin_{pin},
+    invert_{idleHigh},
+    withPull_{withPull},
+    pio_{pio}
+    {}
+
+    virtual void initialize(PulseHandler pulseHandler) override;
+
+    /// Pass all pulses captured so far to the handler, may be called at any time
+    void poll();
+
+    /// Number of pulses lost because the ring buffer was not drained fast enough
+    virtual std::uint32_t getOverrunCount() const override { return overrunCount_; }
+
+private:
+    static constexpr std::size_t RING_SIZE_BITS{9}; // ring size in bytes as power of two
+    static constexpr std::size_t RING_SIZE{(1u << RING_SIZE_BITS) / sizeof(std::uint32_t)};
+    static constexpr std::size_t BATCH_SIZE{32};
+    static constexpr std::uint32_t FRAME_GAP_US{8000};
+    static constexpr std::uint32_t DMA_TRANSFER_COUNT{0xFFFFFFFF};
+
+    const unsigned int pin_;
+    const bool invert_;
+    const bool withPull_;
+    const PIO pio_;
+    unsigned int sm_{0};
+    unsigned int dmaChannel_{0};
+    PulseHandler pulseHandler_{};
+    std::uint32_t readCount_{0};
+    std::uint32_t overrunCount_{0};
+    alignas(1u << RING_SIZE_BITS) etl::array<std::uint32_t, RING_SIZE> ring_{};
+    static etl::array<EdgeSourcePio*, NUM_PIOS * NUM_PIO_STATE_MACHINES> instances_;
+    static etl::array<unsigned int, NUM_PIOS> programOffsets_; ///< Offset of the capture program, loaded once per PIO
+
+    void drain(std::uint64_t endTimeUs);
+    static void handleIrq(PIO pio);
+    static void irqHandlerPio0();
+    static void irqHandlerPio1();
+};
@@ -0,0 +1,129 @@
+#include "EventEndpoint.h"
+
+#include <cstring>
+
+#include "etl/array.h"
+#include "tusb.h"
+#include "device/usbd_pvt.h"
+
+namespace
+{
+    constexpr std::uint8_t RHPORT{0};
+
+    const tusb_desc_endpoint_t* endpointDescriptor{nullptr};
+    std::uint8_t alternate{0};
+    etl::array<std::uint8_t, EventEndpoint::MAX_PACKET_SIZE> buffer{}; ///< Must stay valid until the transfer is done
+
+    void init()
+    {
+    }
+
+    void reset(std::uint8_t)
+    {
+        endpointDescriptor = nullptr;
+        alternate = 0;
+    }
+
+    // takes the interface with all its alternate settings
+    std::uint16_t open(std::uint8_t, const tusb_desc_interface_t* interface, std::uint16_t maxLength)
+    {
+        if((interface->bInterfaceClass != TUSB_CLASS_VENDOR_SPECIFIC) || (interface->bInterfaceNumber != EventEndpoint::INTERFACE))
+        {
+            return 0;
+        }
+
+        const std::uint8_t* descriptor{reinterpret_cast<const std::uint8_t*>(interface)};
+        const std::uint8_t* const end{descriptor + maxLength};
+        while(descriptor < end)
+        {
+            if((tu_desc_type(descriptor) == TUSB_DESC_INTERFACE) &&
+               (reinterpret_cast<const tusb_desc_interface_t*>(descriptor)->bInterfaceNumber != EventEndpoint::INTERFACE))
+            {
+                break;
+            }
+            if(tu_desc_type(descriptor) == TUSB_DESC_ENDPOINT)
+            {
+                endpointDescriptor = reinterpret_cast<const tusb_desc_endpoint_t*>(descriptor);
+            }
+            descriptor = tu_desc_next(descriptor);
+        }
+        alternate = 0;
+        return static_cast<std::uint16_t>(descriptor - reinterpret_cast<const std::uint8_t*>(interface));
+    }
+
+    bool controlTransfer(std::uint8_t rhport, std::uint8_t stage, const tusb_control_request_t* request)
+    {
+        if((stage != CONTROL_STAGE_SETUP) || (request->bmRequestType_bit.type != TUSB_REQ_TYPE_STANDARD))
+        {
+            return stage != CONTROL_STAGE_SETUP;
+        }
+
+        switch(request->bRequest)
+        {
+        case TUSB_REQ_SET_INTERFACE:
+            if((request->wValue > 1) || (endpointDescriptor == nullptr))
+            {
+                return false;
+            }
+            if(alternate != 0)
+            {
+                usbd_edpt_close(rhport, EventEndpoint::ENDPOINT);
+            }
+            alternate = static_cast<std::uint8_t>(request->wValue);
+            if((alternate != 0) && !usbd_edpt_open(rhport, endpointDescriptor))
+            {
+                alternate = 0;
+                return false;
+            }
+            return tud_control_status(rhport, request);
+
+        case TUSB_REQ_GET_INTERFACE:
+            return tud_control_xfer(rhport, request, &alternate, 1);
+
+        default:
+            return false;
+        }
+    }
+
+    bool transferComplete(std::uint8_t, std::uint8_t, xfer_result_t, std::uint32_t)
+    {
+        return true; // the endpoint is free again, usbd_edpt_busy() tells
+    }
+
+    const usbd_class_driver_t DRIVER
+    {
+        .init = &init,
+        .reset = &reset,
+        .open = &open,
+        .control_xfer_cb = &controlTransfer,
+        .xfer_cb = &transferComplete,
+        .sof = nullptr
+    };
+}
+
+bool EventEndpoint::isActive()
+{
+    return tud_ready() && (alternate != 0);
+}
+
+bool EventEndpoint::isReady()
+{
+    return isActive() && !usbd_edpt_busy(RHPORT, ENDPOINT);
+}
+
+bool EventEndpoint::write(const std::uint8_t* data, std::uint16_t size)
+{
+    if(!isReady() || (size > buffer.size()))
+    {
+        return false;
+    }
+    std::memcpy(buffer.data(), data, size);
+    return usbd_edpt_xfer(RHPORT, ENDPOINT, buffer.data(), size);
+}
+
+// Invoked by TinyUSB to get the application class drivers, they are tried before the built-in ones
+extern "C" const usbd_class_driver_t* usbd_app_driver_get_cb(std::uint8_t* driverCount)
+{
+    *driverCount = 1;
+    return &DRIVER;
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <cstdint>
+
+/// Interrupt IN endpoint for the event reports on an own interface, served by an application class driver of TinyUSB
+/// (the vendor class only supports bulk endpoints). Alternate setting 0 has no endpoint, so the interface does not
+/// reserve bandwidth until the host selects alternate setting 1. Then the events are sent on the interrupt endpoint
+/// (polled every bInterval, independent of other bulk traffic), the bulk endpoint keeps the raw reports.
+class EventEndpoint
+{
+public:
+    static constexpr std::uint8_t INTERFACE{2};
+    static constexpr std::uint8_t ENDPOINT{0x83};
+    static constexpr std::uint16_t MAX_PACKET_SIZE{64};
+
+    /// True if the host selected the alternate setting with the endpoint
+    static bool isActive();
+
+    /// True if the endpoint is active and the previous packet was taken by the host
+    static bool isReady();
+
+    /// Send one packet (up to MAX_PACKET_SIZE bytes, copied), false if the endpoint is not ready
+    static bool write(const std::uint8_t* data, std::uint16_t size);
+};
@@ -0,0 +1,44 @@
+#include "EventFilter.h"
+
+bool EventFilter::load(etl::span<const UsbFilterEntry> entries)
+{
+    clear();
+    if(entries.size() > MAX_ENTRIES)
+    {
+        return false;
+    }
+
+    const auto keyOf{[this](std::size_t address) { return addresses_[address].key; }};
+    for(const UsbFilterEntry& entry : entries)
+    {
+        // a new address takes the next free entry
+        const std::uint32_t key{makeKey(entry.protocol, entry.address)};
+        std::size_t address{index_.find(key, keyOf)};
+        if(address == Index::NOT_FOUND)
+        {
+            if(addressCount_ == MAX_ADDRESSES)
+            {
+                clear();
+                return false;
+            }
+            addresses_[addressCount_] = Address{key, {}};
+            address = index_.insert(key, addressCount_++, keyOf);
+        }
+        addresses_[address].commands[entry.command / 32] |= 1u << (entry.command % 32);
+    }
+    enabled_ = true;
+    return true;
+}
+
+void EventFilter::clear()
+{
+    enabled_ = false;
+    addressCount_ = 0;
+    index_.clear();
+}
+
+bool EventFilter::contains(std::uint8_t protocol, std::uint16_t address, std::uint8_t command) const
+{
+    const std::size_t entry{index_.find(makeKey(protocol, address), [this](std::size_t address) { return addresses_[address].key; })};
+    return (entry != Index::NOT_FOUND) && ((addresses_[entry].commands[command / 32] & (1u << (command % 32))) != 0);
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+#include "etl/array.h"
+#include "etl/span.h"
+#include "HashIndex.h"
+#include "IrProtocol.h"
+#include "UsbReport.h"
+
+/// Set of the codes the host subscribed to (VendorRequest::SET_FILTER). Every address (with its protocol) gets a bitmap
+/// of the 256 commands, the addresses are found with a hash index (open addressing), so a code is checked with two index
+/// lookups (its protocol and UsbFilterProtocol::ANY) and a bit test however many codes are subscribed. Without a filter
+/// every code is accepted.
+class EventFilter
+{
+public:
+    static constexpr std::size_t MAX_ENTRIES{128};  ///< Codes per request
+    static constexpr std::size_t MAX_ADDRESSES{16}; ///< Different addresses (per protocol) of the codes
+
+    /// Replace the filter, false if the entries exceed the limits (then every code is accepted)
+    bool load(etl::span<const UsbFilterEntry> entries);
+
+    /// Accept every code again
+    void clear();
+
+    bool isEnabled() const { return enabled_; }
+
+    /// True if events of the code shall be reported
+    bool accept(IrProtocolId protocol, std::uint16_t address, std::uint8_t command) const
+    {
+        return !enabled_ || contains(static_cast<std::uint8_t>(protocol), address, command) || contains(UsbFilterProtocol::ANY, address, command);
+    }
+
+private:
+    using Index = HashIndex<std::uint32_t, MAX_ADDRESSES>;
+
+    struct Address
+    {
+        std::uint32_t key;
+        etl::array<std::uint32_t, 256 / 32> commands; ///< Bit n: command n
+    };
+
+    bool enabled_{false};
+    std::size_t addressCount_{0};
+    etl::array<Address, MAX_ADDRESSES> addresses_{};
+    Index index_{}; ///< Over the keys of the addresses
+
+    /// Key of an address: the code key with command 0, the protocol may be UsbFilterProtocol::ANY
+    static constexpr std::uint32_t makeKey(std::uint8_t protocol, std::uint16_t address)
+    {
+        return makeCodeKey(static_cast<IrProtocolId>(protocol), address, 0);
+    }
+
+    bool contains(std::uint8_t protocol, std::uint16_t address, std::uint8_t command) const;
+};
@@ -0,0 +1,225 @@
+#include "EventReporter.h"
+
+#include <cstring>
+
+#include "pico/stdlib.h"
+
+void EventReporter::add(const IrDecoder::Data& data)
+{
+    if(histograms_ != nullptr)
+    {
+        histograms_->edgeToReadyUs.add(static_cast<std::uint32_t>(data.readyUs - data.timestampUs));
+    }
+    if(!filter_.accept(data.protocol, data.address, data.command))
+    {
+        return;
+    }
+
+    const UsbEventReportEntry entry
+    {
+        .sequence = sequence_++,
+        .protocol = static_cast<std::uint8_t>(data.protocol),
+        .flags = static_cast<std::uint8_t>(data.repeated ? UsbEventFlags::REPEATED : 0),
+        .timestampUs = static_cast<std::uint32_t>(data.timestampUs),
+        .code = data.code,
+        .address = data.address,
+        .command = data.command,
+        .reserved = 0
+    };
+    pending_.push(PendingEvent{entry, static_cast<std::uint32_t>(data.readyUs)});
+}
+
+void EventReporter::addKey(const KeyTracker::Event& event)
+{
+    if(!filter_.accept(event.protocol, event.address, event.command))
+    {
+        return;
+    }
+    pendingKeys_.push(UsbKeyEventEntry
+    {
+        .sequence = keySequence_++,
+        .type = static_cast<std::uint8_t>(event.type),
+        .protocol = static_cast<std::uint8_t>(event.protocol),
+        .address = event.address,
+        .command = event.command,
+        .repeatCount = event.repeatCount,
+        .timestampUs = static_cast<std::uint32_t>(event.timestampUs)
+    });
+}
+
+void EventReporter::addGesture(const GestureMatcher::Event& event)
+{
+    pendingGestures_.push(UsbGestureEntry
+    {
+        .sequence = gestureSequence_++,
+        .id = event.id,
+        .timestampUs = static_cast<std::uint32_t>(event.timestampUs)
+    });
+}
+
+std::size_t EventReporter::transmit()
+{
+    const bool eventEndpoint{EventEndpoint::isActive()};
+    std::size_t count{transmitEvents(eventEndpoint)};
+    count += transmitEntries(eventEndpoint, UsbReportType::KEYS, pendingKeys_);
+    return count + transmitEntries(eventEndpoint, UsbReportType::GESTURES, pendingGestures_);
+}
+
+std::size_t EventReporter::transmitEvents(bool eventEndpoint)
+{
+    if(pending_.empty())
+    {
+        return 0;
+    }
+
+    // take only as many events as the endpoint can take right now, the rest waits for the next report
+    const std::size_t maxCount{getMaxCount(eventEndpoint, sizeof(UsbEventReportEntry), eventEndpoint ? MAX_EVENTS_PER_PACKET : events_.size())};
+    if(maxCount == 0)
+    {
+        return 0;
+    }
+
+    const std::size_t count{pending_.drain(etl::span<PendingEvent>{events_.data(), maxCount})};
+    const UsbEventReportHeader header
+    {
+        .type = static_cast<std::uint8_t>(UsbReportType::EVENTS),
+        .count = static_cast<std::uint8_t>(count),
+        .droppedCount = static_cast<std::uint16_t>(getDroppedCount())
+    };
+    std::memcpy(report_.data(), &header, sizeof(header));
+    for(std::size_t i = 0; i < count; i++)
+    {
+        std::memcpy(report_.data() + sizeof(header) + i * sizeof(UsbEventReportEntry), &events_[i].entry, sizeof(UsbEventReportEntry));
+    }
+
+    send(eventEndpoint, sizeof(header) + count * sizeof(UsbEventReportEntry));
+    measureLatency(etl::span<const PendingEvent>{events_.data(), count});
+    return count;
+}
+
+template<typename Entry, std::size_t SIZE>
+std::size_t EventReporter::transmitEntries(bool eventEndpoint, UsbReportType type, SpscQueue<Entry, SIZE>& queue)
+{
+    if(queue.empty())
+    {
+        return 0;
+    }
+
+    const std::size_t maxPerReport{((eventEndpoint ? EventEndpoint::MAX_PACKET_SIZE : MAX_REPORT_SIZE) - sizeof(UsbEventReportHeader)) / sizeof(Entry)};
+    const std::size_t maxCount{getMaxCount(eventEndpoint, sizeof(Entry), maxPerReport)};
+    if(maxCount == 0)
+    {
+        return 0;
+    }
+
+    etl::array<Entry, SIZE> entries;
+    const std::size_t count{queue.drain(etl::span<Entry>{entries.data(), (maxCount < entries.size()) ? maxCount : entries.size()})};
+    const UsbEventReportHeader header
+    {
+        .type = static_cast<std::uint8_t>(type),
+        .count = static_cast<std::uint8_t>(count),
+        .droppedCount = static_cast<std::uint16_t>(queue.getOverflowCount())
+    };
+    std::memcpy(report_.data(), &header, sizeof(header));
+    std::memcpy(report_.data() + sizeof(header), entries.data(), count * sizeof(Entry));
+
+    send(eventEndpoint, sizeof(header) + count * sizeof(Entry));
+    return count;
+}
+
+std::size_t EventReporter::getMaxCount(bool eventEndpoint, std::size_t entrySize, std::size_t maxCount)
+{
+    if(eventEndpoint)
+    {
+        return EventEndpoint::isReady() ? maxCount : 0;
+    }
+
+    if(!tud_vendor_mounted())
+    {
+        return 0;
+    }
+    const std::uint32_t available{tud_vendor_write_available()};
+    if(available < (sizeof(UsbEventReportHeader) + entrySize))
+    {
+        return 0;
+    }
+    const std::size_t count{(available - sizeof(UsbEventReportHeader)) / entrySize};
+    return (count < maxCount) ? count : maxCount;
+}
+
+void EventReporter::send(bool eventEndpoint, std::size_t size)
+{
+    if(eventEndpoint)
+    {
+        EventEndpoint::write(report_.data(), static_cast<std::uint16_t>(size));
+    }
+    else
+    {
+        tud_vendor_write(report_.data(), static_cast<std::uint32_t>(size));
+        tud_vendor_write_flush();
+    }
+}
+
+bool EventReporter::handleLatencyRequest(std::uint8_t rhport, std::uint8_t stage, const tusb_control_request_t& request)
+{
+    if(stage != CONTROL_STAGE_SETUP)
+    {
+        return true;
+    }
+
+    if(request.bRequest == static_cast<std::uint8_t>(VendorRequest::RESET_LATENCY))
+    {
+        latency_ = Latency{0, UINT32_MAX, 0, 0};
+        return tud_control_status(rhport, &request);
+    }
+
+    latencyReport_ = UsbLatencyReport
+    {
+        .count = latency_.count,
+        .minUs = (latency_.count > 0) ? latency_.minUs : 0,
+        .maxUs = latency_.maxUs,
+        .averageUs = (latency_.count > 0) ? static_cast<std::uint32_t>(latency_.sumUs / latency_.count) : 0
+    };
+    return tud_control_xfer(rhport, &request, &latencyReport_, static_cast<std::uint16_t>(sizeof(latencyReport_)));
+}
+
+bool EventReporter::handleFilterRequest(std::uint8_t rhport, std::uint8_t stage, const tusb_control_request_t& request)
+{
+    if(stage == CONTROL_STAGE_SETUP)
+    {
+        if(((request.wLength % sizeof(UsbFilterEntry)) != 0) || (request.wLength > sizeof(filterEntries_)))
+        {
+            return false;
+        }
+        if(request.wLength == 0) // no data stage, report all codes again
+        {
+            filter_.clear();
+            return tud_control_status(rhport, &request);
+        }
+        return tud_control_xfer(rhport, &request, filterEntries_.data(), request.wLength);
+    }
+    if(stage == CONTROL_STAGE_DATA)
+    {
+        return filter_.load(etl::span<const UsbFilterEntry>{filterEntries_.data(), request.wLength / sizeof(UsbFilterEntry)});
+    }
+    return true;
+}
+
+void EventReporter::measureLatency(etl::span<const PendingEvent> events)
+{
+    // the time stamps of the report are only 32 bit, the difference is still correct across a wrap
+    const std::uint32_t nowUs{static_cast<std::uint32_t>(time_us_64())};
+    for(const PendingEvent& event : events)
+    {
+        if(histograms_ != nullptr)
+        {
+            histograms_->readyToUsbUs.add(nowUs - event.readyUs);
+        }
+
+        const std::uint32_t latencyUs{nowUs - event.entry.timestampUs};
+        latency_.count++;
+        latency_.sumUs += latencyUs;
+        if(latencyUs < latency_.minUs) latency_.minUs = latencyUs;
+        if(latencyUs > latency_.maxUs) latency_.maxUs = latencyUs;
+    }
+}
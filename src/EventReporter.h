@@ -0,0 +1,102 @@
+#pragma once
+#include <cstdint>
+#include "etl/array.h"
+#include "EventEndpoint.h"
+#include "EventFilter.h"
+#include "GestureMatcher.h"
+#include "IrDecoder.h"
+#include "KeyTracker.h"
+#include "LatencyHistograms.h"
+#include "SpscQueue.h"
+#include "tusb.h"
+#include "UsbReport.h"
+#include "VendorControl.h"
+
+/// Collects decoded events and sends as many of them as possible in one report over the vendor bulk IN endpoint, or
+/// over the interrupt endpoint of the event interface while the host selected it (up to one packet per poll interval).
+/// While the host does not read, events are kept until the queue is full, then new events are dropped and counted.
+/// The time from the last edge of a frame until its event is queued for USB is measured for every event.
+/// Key events (KeyTracker) and gestures (GestureMatcher) are queued separately and sent in own reports after the frame events.
+/// Events and key events of codes the host did not subscribe to (EventFilter) are dropped before they are queued.
+class EventReporter
+{
+public:
+    /// histograms (optional) get the edge to ready and ready to USB time of every event
+    EventReporter(LatencyHistograms* const histograms = nullptr) :
+    histograms_{histograms}
+    {}
+
+    /// Queue an event for the next report
+    void add(const IrDecoder::Data& data);
+
+    /// Queue a key event for the next key report
+    void addKey(const KeyTracker::Event& event);
+
+    /// Queue a completed gesture for the next gesture report
+    void addGesture(const GestureMatcher::Event& event);
+
+    /// Send the queued events if the endpoint can take them, returns the number of events sent
+    std::size_t transmit();
+
+    std::uint32_t getDroppedCount() const { return pending_.getOverflowCount(); }
+
+    std::uint32_t getDroppedKeyCount() const { return pendingKeys_.getOverflowCount(); }
+
+    std::uint32_t getDroppedGestureCount() const { return pendingGestures_.getOverflowCount(); }
+
+    /// Handler for VendorRequest::GET_LATENCY and VendorRequest::RESET_LATENCY
+    bool handleLatencyRequest(std::uint8_t rhport, std::uint8_t stage, const tusb_control_request_t& request);
+
+    /// Handler for VendorRequest::SET_FILTER
+    bool handleFilterRequest(std::uint8_t rhport, std::uint8_t stage, const tusb_control_request_t& request);
+
+private:
+    struct Latency
+    {
+        std::uint32_t count;
+        std::uint32_t minUs;
+        std::uint32_t maxUs;
+        std::uint64_t sumUs;
+    };
+
+    struct PendingEvent
+    {
+        UsbEventReportEntry entry;
+        std::uint32_t readyUs; ///< Time the decoder queued the event (wraps)
+    };
+
+    static constexpr std::size_t QUEUE_SIZE{64};
+    static constexpr std::size_t MAX_REPORT_SIZE{CFG_TUD_VENDOR_TX_BUFSIZE};
+    static constexpr std::size_t MAX_EVENTS_PER_REPORT{(MAX_REPORT_SIZE - sizeof(UsbEventReportHeader)) / sizeof(UsbEventReportEntry)};
+    static constexpr std::size_t MAX_EVENTS_PER_PACKET{(EventEndpoint::MAX_PACKET_SIZE - sizeof(UsbEventReportHeader)) / sizeof(UsbEventReportEntry)};
+    static_assert(MAX_EVENTS_PER_PACKET > 0, "the event endpoint cannot take a report");
+    static constexpr std::size_t KEY_QUEUE_SIZE{16};
+    static constexpr std::size_t GESTURE_QUEUE_SIZE{8};
+
+    LatencyHistograms* const histograms_;
+    SpscQueue<PendingEvent, QUEUE_SIZE> pending_{};
+    std::uint16_t sequence_{0};
+    SpscQueue<UsbKeyEventEntry, KEY_QUEUE_SIZE> pendingKeys_{};
+    std::uint16_t keySequence_{0};
+    SpscQueue<UsbGestureEntry, GESTURE_QUEUE_SIZE> pendingGestures_{};
+    std::uint16_t gestureSequence_{0};
+    etl::array<PendingEvent, MAX_EVENTS_PER_REPORT> events_{};
+    etl::array<std::uint8_t, MAX_REPORT_SIZE> report_{};
+    Latency latency_{0, UINT32_MAX, 0, 0};
+    UsbLatencyReport latencyReport_{}; ///< Must stay valid until the control transfer is done
+    EventFilter filter_{};
+    etl::array<UsbFilterEntry, EventFilter::MAX_ENTRIES> filterEntries_{}; ///< Data stage of SET_FILTER
+
+    std::size_t transmitEvents(bool eventEndpoint);
+
+    /// Send the entries of a key or gesture queue in a report of the type
+    template<typename Entry, std::size_t SIZE>
+    std::size_t transmitEntries(bool eventEndpoint, UsbReportType type, SpscQueue<Entry, SIZE>& queue);
+
+    /// Number of entries of the size the endpoint can take right now (at most maxCount)
+    static std::size_t getMaxCount(bool eventEndpoint, std::size_t entrySize, std::size_t maxCount);
+
+    /// Send the report with the header and size bytes in report_
+    void send(bool eventEndpoint, std::size_t size);
+    void measureLatency(etl::span<const PendingEvent> events);
+};
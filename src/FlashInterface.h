@@ -0,0 +1,23 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "etl/span.h"
+
+/// Flash region with memory mapped read access. Erased bytes read as 0xFF, programming can only clear bits.
+class FlashInterface
+{
+public:
+    static constexpr std::size_t SECTOR_SIZE{4096};
+
+    /// Size of the region in bytes (multiple of the sector size)
+    virtual std::size_t getSize() const = 0;
+
+    /// Memory mapped content of the region
+    virtual const std::uint8_t* getData() const = 0;
+
+    /// Erase the sector at the offset (multiple of the sector size)
+    virtual void eraseSector(std::size_t offset) = 0;
+
+    /// Program data at any offset, the data must not be located in the flash itself
+    virtual void program(std::size_t offset, etl::span<const std::uint8_t> data) = 0;
+};
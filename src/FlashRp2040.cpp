@@ -0,0 +1,69 @@
+#include "FlashRp2040.h"
+#include <algorithm>
+#include <cstring>
+
+#include "etl/array.h"
+#include "pico/multicore.h"
+#include "hardware/flash.h"
+#include "hardware/sync.h"
+
+static_assert(FlashInterface::SECTOR_SIZE == FLASH_SECTOR_SIZE, "unexpected flash sector size");
+
+namespace
+{
+    /// Keeps the other core and the interrupts away from the flash while it is busy
+    class FlashLock
+    {
+    public:
+        FlashLock()
+        {
+            multicore_lockout_start_blocking();
+            interrupts_ = save_and_disable_interrupts();
+        }
+
+        ~FlashLock()
+        {
+            restore_interrupts(interrupts_);
+            multicore_lockout_end_blocking();
+        }
+
+    private:
+        std::uint32_t interrupts_;
+    };
+}
+
+const std::uint8_t* FlashRp2040::getData() const
+{
+    return reinterpret_cast<const std::uint8_t*>(XIP_BASE + getFlashOffset());
+}
+
+void FlashRp2040::eraseSector(std::size_t offset)
+{
+    const FlashLock lock;
+    flash_range_erase(getFlashOffset() + offset, FLASH_SECTOR_SIZE);
+}
+
+void FlashRp2040::program(std::size_t offset, etl::span<const std::uint8_t> data)
+{
+    // the flash is programmed in whole pages, the bytes outside of the data stay 0xFF and do not change the flash
+    etl::array<std::uint8_t, FLASH_PAGE_SIZE> page;
+    std::size_t done{0};
+    while(done < data.size())
+    {
+        const std::size_t pageStart{(offset + done) & ~static_cast<std::size_t>(FLASH_PAGE_SIZE - 1)};
+        const std::size_t pageOffset{offset + done - pageStart};
+        const std::size_t count{std::min(data.size() - done, static_cast<std::size_t>(FLASH_PAGE_SIZE) - pageOffset)};
+        page.fill(0xFF);
+        std::memcpy(page.data() + pageOffset, data.data() + done, count);
+        {
+            const FlashLock lock;
+            flash_range_program(getFlashOffset() + pageStart, page.data(), FLASH_PAGE_SIZE);
+        }
+        done += count;
+    }
+}
+
+std::uint32_t FlashRp2040::getFlashOffset() const
+{
+    return static_cast<std::uint32_t>(PICO_FLASH_SIZE_BYTES - size_);
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <cstdint>
+#include "FlashInterface.h"
+
+/// The last sectors of the on-board flash, read through XIP.
+/// Erasing and programming stall the other core (multicore lockout, it has to call multicore_lockout_victim_init())
+/// and disable the interrupts, because no code can be executed from the flash meanwhile.
+class FlashRp2040 final : public FlashInterface
+{
+public:
+    explicit FlashRp2040(std::size_t sectorCount) :
+    size_{sectorCount * SECTOR_SIZE}
+    {}
+
+    virtual std::size_t getSize() const override { return size_; }
+    virtual const std::uint8_t* getData() const override;
+    virtual void eraseSector(std::size_t offset) override;
+    virtual void program(std::size_t offset, etl::span<const std::uint8_t> data) override;
+
+private:
+    const std::size_t size_;
+
+    std::uint32_t getFlashOffset() const;
+};
@@ -0,0 +1,202 @@
+#include "GestureMatcher.h"
+
+void GestureMatcher::load(etl::span<const GestureEntry> entries)
+{
+    entries_ = entries.first((entries.size() < MAX_GESTURES) ? entries.size() : MAX_GESTURES);
+    nodes_[ROOT] = Node{0, NONE, NONE, NONE, 0, 0, 0};
+    nodeCount_ = 1;
+
+    for(std::size_t gesture = 0; gesture < entries_.size(); gesture++)
+    {
+        const GestureEntry& entry{entries_[gesture]};
+        if((entry.stepCount == 0) || (entry.stepCount > GestureEntry::MAX_STEPS))
+        {
+            continue;
+        }
+
+        std::uint8_t node{ROOT};
+        for(std::size_t i = 0; (i < entry.stepCount) && (node != NONE); i++)
+        {
+            const GestureKey& key{entry.keys[i]};
+            const bool longStep{(entry.longSteps & (1u << i)) != 0};
+            if(i > 0) // the walk waits for the next step as long as any gesture through the node allows
+            {
+                nodes_[node].maxGapMs = (entry.maxGapMs > nodes_[node].maxGapMs) ? entry.maxGapMs : nodes_[node].maxGapMs;
+            }
+
+            const std::uint32_t step{makeCodeKey(key.protocol, key.address, key.command) | (longStep ? LONG_STEP : 0)};
+            std::uint8_t child{findChild(node, step)};
+            if(child == NONE)
+            {
+                child = addChild(node, step);
+            }
+            if((child != NONE) && longStep)
+            {
+                const std::uint16_t holdMs{(entry.holdMs != 0) ? entry.holdMs : static_cast<std::uint16_t>(1)};
+                nodes_[child].holdMs = ((nodes_[child].holdMs == 0) || (holdMs < nodes_[child].holdMs)) ? holdMs : nodes_[child].holdMs;
+            }
+            node = child;
+        }
+
+        if((node != NONE) && (nodes_[node].gesture == NONE))
+        {
+            nodes_[node].gesture = static_cast<std::uint8_t>(gesture);
+        }
+    }
+
+    held_ = false;
+    reset();
+}
+
+void GestureMatcher::add(const KeyTracker::Event& event)
+{
+    switch(event.type)
+    {
+    case UsbKeyEventType::PRESS:
+        held_ = true;
+        longDone_ = false;
+        heldKey_ = makeCodeKey(event.protocol, event.address, event.command);
+        pressUs_ = event.timestampUs;
+        pressGapMs_ = 0;
+        if(node_ != ROOT)
+        {
+            // the release of the previous key is stamped with the time its next repeat was due, a fast press can be earlier
+            const std::uint64_t gapMs{(event.timestampUs > stepEndUs_) ? (event.timestampUs - stepEndUs_) / 1000 : 0};
+            if(gapMs > nodes_[node_].maxGapMs) // too late to continue, the walk ends before this key
+            {
+                complete();
+            }
+            else
+            {
+                pressGapMs_ = static_cast<std::uint16_t>(gapMs);
+            }
+        }
+        break;
+
+    case UsbKeyEventType::RELEASE:
+        if(!held_)
+        {
+            break;
+        }
+        checkLong();
+        held_ = false;
+        if(!longDone_)
+        {
+            step(heldKey_, 0, event.timestampUs);
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+void GestureMatcher::task(std::uint64_t nowUs)
+{
+    if(held_)
+    {
+        checkLong();
+    }
+    else if((node_ != ROOT) && (nowUs > stepEndUs_ + nodes_[node_].maxGapMs * 1000ull)) // no further step in time
+    {
+        complete();
+    }
+}
+
+void GestureMatcher::checkLong()
+{
+    if(!held_ || longDone_)
+    {
+        return;
+    }
+
+    // the frames of the key prove the hold, the walk continues with the long press or starts with it
+    const std::uint32_t step{heldKey_ | LONG_STEP};
+    std::uint8_t child{findChild(node_, step)};
+    if((child == NONE) && (node_ != ROOT))
+    {
+        child = findChild(ROOT, step);
+    }
+    const std::uint64_t heldUs{keys_.getLastFrameUs() - pressUs_};
+    if((child != NONE) && (heldUs >= nodes_[child].holdMs * 1000ull))
+    {
+        longDone_ = true;
+        this->step(step, static_cast<std::uint16_t>((heldUs / 1000 < UINT16_MAX) ? heldUs / 1000 : UINT16_MAX), keys_.getLastFrameUs());
+    }
+}
+
+std::uint8_t GestureMatcher::findChild(std::uint8_t node, std::uint32_t step) const
+{
+    for(std::uint8_t child = nodes_[node].firstChild; child != NONE; child = nodes_[child].nextSibling)
+    {
+        if(nodes_[child].step == step)
+        {
+            return child;
+        }
+    }
+    return NONE;
+}
+
+std::uint8_t GestureMatcher::addChild(std::uint8_t node, std::uint32_t step)
+{
+    if(nodeCount_ >= nodes_.size())
+    {
+        return NONE;
+    }
+    const std::uint8_t child{static_cast<std::uint8_t>(nodeCount_++)};
+    nodes_[child] = Node{step, NONE, nodes_[node].firstChild, NONE, 0, 0, 0};
+    nodes_[node].firstChild = child;
+    return child;
+}
+
+void GestureMatcher::step(std::uint32_t step, std::uint16_t holdMs, std::uint64_t endUs)
+{
+    std::uint8_t child{findChild(node_, step)};
+    if((child == NONE) && (node_ != ROOT)) // the walk cannot continue, it ends before this step which may start a new one
+    {
+        complete();
+        child = findChild(ROOT, step);
+    }
+    if(child == NONE)
+    {
+        return;
+    }
+
+    if(node_ != ROOT)
+    {
+        walkGapMs_ = (pressGapMs_ > walkGapMs_) ? pressGapMs_ : walkGapMs_;
+    }
+    if((step & LONG_STEP) != 0)
+    {
+        walkHoldMs_ = (holdMs < walkHoldMs_) ? holdMs : walkHoldMs_;
+    }
+    node_ = child;
+    stepEndUs_ = endUs;
+
+    if(nodes_[node_].firstChild == NONE) // no gesture continues, no need to wait
+    {
+        complete();
+    }
+}
+
+void GestureMatcher::complete()
+{
+    const std::uint8_t gesture{nodes_[node_].gesture};
+    if(gesture != NONE)
+    {
+        const GestureEntry& entry{entries_[gesture]};
+        const bool inTime{(walkGapMs_ <= entry.maxGapMs) && ((entry.longSteps == 0) || (walkHoldMs_ >= entry.holdMs))};
+        if(inTime && eventHandler_.is_valid())
+        {
+            eventHandler_(Event{entry.id, stepEndUs_});
+        }
+    }
+    reset();
+}
+
+void GestureMatcher::reset()
+{
+    node_ = ROOT;
+    walkGapMs_ = 0;
+    walkHoldMs_ = UINT16_MAX;
+}
@@ -0,0 +1,115 @@
+#pragma once
+#include <cstdint>
+#include "etl/array.h"
+#include "etl/delegate.h"
+#include "etl/span.h"
+#include "IrProtocol.h"
+#include "KeyTracker.h"
+
+/// Key of one step of a gesture
+struct GestureKey
+{
+    IrProtocolId protocol;
+    std::uint8_t command;
+    std::uint16_t address;
+};
+
+/// A sequence of 1 to 4 key presses which is reported as one gesture id, e.g. a combo (different keys), a double tap
+/// (the same key twice) or a long press (one step held). Stored as array in the configuration (ConfigKey::GESTURES).
+struct GestureEntry
+{
+    std::uint16_t id;        ///< Reported when the gesture is complete
+    std::uint8_t stepCount;  ///< Used keys, 1 ... MAX_STEPS
+    std::uint8_t longSteps;  ///< Bit n set: step n is a long press, otherwise a tap (released before the hold time)
+    std::uint16_t maxGapMs;  ///< Longest time from the end of a step to the press of the next one
+    std::uint16_t holdMs;    ///< Shortest hold of the long press steps
+    etl::array<GestureKey, 4> keys;
+
+    static constexpr std::size_t MAX_STEPS{4};
+};
+
+static_assert(sizeof(GestureKey) == 4, "the keys are stored as they are in the configuration");
+static_assert(sizeof(GestureEntry) == 24, "the entries are stored as they are in the configuration");
+
+/// Recognizes gestures in the key events of the KeyTracker, so the timing is measured on the device with the time
+/// stamps of the edges instead of after the USB jitter. The gestures are stored in a trie: every node is a step (key
+/// and tap / long press), a path from the root is the prefix of the gestures below it. The matcher walks down with
+/// every step and reports the gesture of a node once no other gesture can continue it, so a gesture which is the
+/// prefix of another one (single tap and double tap of the same key) is reported after the gap of the longer one.
+/// A step ends with the release of a tap (KeyTracker release time) or when a long press reaches the hold time.
+class GestureMatcher
+{
+public:
+    static constexpr std::size_t MAX_GESTURES{32};
+
+    struct Event
+    {
+        std::uint16_t id;          ///< GestureEntry::id
+        std::uint64_t timestampUs; ///< End of the last step
+    };
+
+    using EventHandler = etl::delegate<void(const Event& event)>;
+
+    /// keys: tracker whose events are passed to add(), its frames tell how long a key is held
+    explicit GestureMatcher(const KeyTracker& keys) :
+    keys_{keys}
+    {
+        nodes_[ROOT] = Node{0, NONE, NONE, NONE, 0, 0, 0}; // no gestures until load()
+    }
+
+    void setEventHandler(EventHandler handler) { eventHandler_ = handler; }
+
+    /// Build the trie of the gestures, entries beyond MAX_GESTURES or with an invalid step count are ignored.
+    /// The table must stay valid until the next load(). Of two gestures with the same steps the first one is used.
+    void load(etl::span<const GestureEntry> entries);
+
+    /// Follow a key event of the tracker
+    void add(const KeyTracker::Event& event);
+
+    /// Detect long presses and the end of a gesture without further steps, call periodically
+    void task(std::uint64_t nowUs);
+
+    /// Time task() has to run to end the gesture in progress after its gap, UINT64_MAX if none is in progress or a key
+    /// is held (a long press is detected with the frames of the key, which arrive as new events)
+    std::uint64_t getWakeTimeUs() const { return ((node_ != ROOT) && !held_) ? stepEndUs_ + nodes_[node_].maxGapMs * 1000ull + 1 : UINT64_MAX; }
+
+private:
+    struct Node
+    {
+        std::uint32_t step;        ///< Key and LONG_STEP of the step leading to the node
+        std::uint8_t firstChild;   ///< NONE if the node is a leaf
+        std::uint8_t nextSibling;  ///< NONE if the node is the last child
+        std::uint8_t gesture;      ///< Index of the gesture ending here, NONE if no gesture ends here
+        std::uint8_t reserved;
+        std::uint16_t maxGapMs;    ///< Longest gap of the gestures continuing after the node
+        std::uint16_t holdMs;      ///< Shortest hold of the gestures if the step is a long press, 0 for a tap
+    };
+
+    static constexpr std::size_t MAX_NODES{1 + MAX_GESTURES * GestureEntry::MAX_STEPS};
+    static constexpr std::uint8_t ROOT{0};
+    static constexpr std::uint8_t NONE{0xFF};
+    static constexpr std::uint32_t LONG_STEP{0x80000000};
+    static_assert(MAX_NODES < NONE, "node index too small");
+
+    const KeyTracker& keys_;
+    EventHandler eventHandler_{};
+    etl::span<const GestureEntry> entries_{};
+    etl::array<Node, MAX_NODES> nodes_{};
+    std::size_t nodeCount_{1};
+    std::uint8_t node_{ROOT};          ///< Current position of the walk
+    std::uint16_t walkGapMs_{0};       ///< Longest gap between the steps of the walk
+    std::uint16_t walkHoldMs_{UINT16_MAX}; ///< Shortest hold of the long press steps of the walk
+    std::uint64_t stepEndUs_{0};       ///< End of the last step of the walk
+    bool held_{false};
+    bool longDone_{false};             ///< The held key already made a long press step
+    std::uint32_t heldKey_{0};
+    std::uint64_t pressUs_{0};
+    std::uint16_t pressGapMs_{0};      ///< Gap from the end of the last step to the press of the held key
+
+    void checkLong();
+    std::uint8_t findChild(std::uint8_t node, std::uint32_t step) const;
+    std::uint8_t addChild(std::uint8_t node, std::uint32_t step);
+    void step(std::uint32_t step, std::uint16_t holdMs, std::uint64_t endUs);
+    void complete();
+    void reset();
+};
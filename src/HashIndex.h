@@ -0,0 +1,70 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include "etl/array.h"
+
+/// Hash index (open addressing with linear probing, Fibonacci hashing) over a table of up to MAX_ENTRIES entries which the
+/// user keeps, e.g. memory mapped from the configuration store. A slot holds the entry number + 1 (0 if the slot is empty),
+/// at most half of the slots are used, so a lookup takes about one probe. The keys of the entries are read through keyOf,
+/// a callable returning the key of an entry number.
+template<typename Key, std::size_t MAX_ENTRIES>
+class HashIndex
+{
+    static_assert(std::is_unsigned_v<Key> && (sizeof(Key) <= sizeof(std::uint32_t)), "Key must be an unsigned integer of up to 32 bits");
+    static_assert((MAX_ENTRIES > 0) && (MAX_ENTRIES < UINT8_MAX), "MAX_ENTRIES must be between 1 and 254");
+
+public:
+    static constexpr std::size_t NOT_FOUND{MAX_ENTRIES};
+
+    /// Remove all entries
+    void clear() { slots_.fill(0); }
+
+    /// Number of the entry with the key, NOT_FOUND if there is none
+    template<typename KeyOf>
+    std::size_t find(Key key, KeyOf keyOf) const
+    {
+        const std::uint8_t slot{slots_[findSlot(key, keyOf)]};
+        return (slot == 0) ? NOT_FOUND : slot - 1u;
+    }
+
+    /// Add the entry number of a key, returns the entry number of the key (an entry already in the index wins)
+    template<typename KeyOf>
+    std::size_t insert(Key key, std::size_t entry, KeyOf keyOf)
+    {
+        std::uint8_t& slot{slots_[findSlot(key, keyOf)]};
+        if(slot == 0)
+        {
+            slot = static_cast<std::uint8_t>(entry + 1);
+        }
+        return slot - 1u;
+    }
+
+private:
+    static constexpr std::size_t getIndexBits()
+    {
+        std::size_t bits{1};
+        while((std::size_t{1} << bits) < 2 * MAX_ENTRIES)
+        {
+            bits++;
+        }
+        return bits;
+    }
+
+    static constexpr std::size_t INDEX_BITS{getIndexBits()};
+    static constexpr std::size_t INDEX_SIZE{std::size_t{1} << INDEX_BITS};
+
+    etl::array<std::uint8_t, INDEX_SIZE> slots_{};
+
+    /// Slot of the key or the empty slot where it would be added
+    template<typename KeyOf>
+    std::size_t findSlot(Key key, KeyOf keyOf) const
+    {
+        std::size_t slot{static_cast<std::size_t>((static_cast<std::uint32_t>(key) * 2654435761u) >> (32 - INDEX_BITS))};
+        while((slots_[slot] != 0) && (keyOf(slots_[slot] - 1u) != key))
+        {
+            slot = (slot + 1) & (INDEX_SIZE - 1);
+        }
+        return slot;
+    }
+};
@@ -0,0 +1,105 @@
+#include "HidKeyboard.h"
+#include "etl/array.h"
+#include "tusb.h"
+#include "UsbReport.h"
+
+void HidKeyboard::setEnabled(bool enabled)
+{
+    enabled_ = enabled;
+    if(!enabled)
+    {
+        held_ = false;
+    }
+}
+
+void HidKeyboard::add(const KeyTracker::Event& event)
+{
+    if(!enabled_)
+    {
+        return;
+    }
+
+    const KeymapEntry* const entry{keymap_.find(event.protocol, event.address, event.command)};
+    if(entry == nullptr)
+    {
+        return;
+    }
+
+    switch(event.type)
+    {
+    case UsbKeyEventType::PRESS:
+        // the release of the previous press of this key may not be reported yet
+        if(entry->usage == ((entry->page == HidUsagePage::KEYBOARD) ? keyboardSent_ : consumerSent_))
+        {
+            releaseFirst_ = true;
+        }
+        key_ = *entry;
+        held_ = true;
+        break;
+
+    case UsbKeyEventType::RELEASE:
+        if(held_ && (entry->getKey() == key_.getKey()))
+        {
+            held_ = false;
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+void HidKeyboard::getState(std::uint16_t& keyboard, std::uint16_t& consumer) const
+{
+    keyboard = 0;
+    consumer = 0;
+    if(held_ && !releaseFirst_)
+    {
+        ((key_.page == HidUsagePage::KEYBOARD) ? keyboard : consumer) = key_.usage;
+    }
+}
+
+void HidKeyboard::task()
+{
+    if(!tud_hid_ready())
+    {
+        return;
+    }
+    if(releaseFirst_ && (keyboardSent_ == 0) && (consumerSent_ == 0)) // the release is out, press the key again right away
+    {
+        releaseFirst_ = false;
+    }
+
+    std::uint16_t keyboard{0};
+    std::uint16_t consumer{0};
+    getState(keyboard, consumer);
+
+    // one report per call, the next one can be sent when the previous transfer is complete
+    if(keyboard != keyboardSent_)
+    {
+        etl::array<std::uint8_t, 6> keyCodes{};
+        keyCodes[0] = static_cast<std::uint8_t>(keyboard);
+        if(tud_hid_keyboard_report(HidReportId::KEYBOARD, 0, keyCodes.data()))
+        {
+            keyboardSent_ = keyboard;
+        }
+    }
+    else if(consumer != consumerSent_)
+    {
+        if(tud_hid_report(HidReportId::CONSUMER, &consumer, sizeof(consumer)))
+        {
+            consumerSent_ = consumer;
+        }
+    }
+}
+
+// Invoked when received GET_REPORT control request, the reports are only sent on the interrupt endpoint
+extern "C" std::uint16_t tud_hid_get_report_cb(std::uint8_t, std::uint8_t, hid_report_type_t, std::uint8_t*, std::uint16_t)
+{
+    return 0;
+}
+
+// Invoked when received SET_REPORT control request or data on the OUT endpoint (keyboard LEDs), not used
+extern "C" void tud_hid_set_report_cb(std::uint8_t, std::uint8_t, hid_report_type_t, std::uint8_t const*, std::uint16_t)
+{
+}
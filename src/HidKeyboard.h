@@ -0,0 +1,36 @@
+#pragma once
+#include <cstdint>
+#include "KeyTracker.h"
+#include "Keymap.h"
+
+/// Presses the keys of mapped IR codes on the HID interface (keyboard and consumer control), so no host software is needed.
+/// The key follows the press and release events of the KeyTracker, so it is held as long as the remote sends repeats.
+class HidKeyboard
+{
+public:
+    explicit HidKeyboard(const Keymap& keymap) :
+    keymap_{keymap}
+    {}
+
+    /// A disabled keyboard releases the held key and ignores new events
+    void setEnabled(bool enabled);
+
+    bool isEnabled() const { return enabled_; }
+
+    /// Press or release the key of a key event (if mapped)
+    void add(const KeyTracker::Event& event);
+
+    /// Send the changed key state, call periodically
+    void task();
+
+private:
+    const Keymap& keymap_;
+    bool enabled_{true};
+    bool held_{false};
+    KeymapEntry key_{};                ///< Held key (a copy, the keymap can be reloaded meanwhile)
+    bool releaseFirst_{false};         ///< The held key was pressed again, the host has to see a release in between
+    std::uint16_t keyboardSent_{0};    ///< Key code reported to the host, 0 if none
+    std::uint16_t consumerSent_{0};    ///< Consumer usage reported to the host, 0 if none
+
+    void getState(std::uint16_t& keyboard, std::uint16_t& consumer) const;
+};
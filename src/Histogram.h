@@ -0,0 +1,49 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "etl/array.h"
+
+/// Counts values in power of two buckets: bucket 0 holds 0, bucket i holds [2^(i-1), 2^i) and the last bucket all larger values.
+/// Written by exactly one context (e.g. an interrupt), read and reset from any other (e.g. the other core). Only plain loads
+/// and stores are used, a reset is only requested and executed by the writer with the next value.
+template<std::size_t BUCKETS>
+class Histogram
+{
+    static_assert((BUCKETS > 1) && (BUCKETS <= 33), "BUCKETS must be between 2 and 33");
+
+public:
+    /// Writer side
+    void add(std::uint32_t value)
+    {
+        if(resetRequested_.load(std::memory_order_acquire))
+        {
+            for(std::atomic<std::uint32_t>& bucket : buckets_)
+            {
+                bucket.store(0, std::memory_order_relaxed);
+            }
+            resetRequested_.store(false, std::memory_order_release);
+        }
+
+        std::size_t index{(value == 0) ? 0 : static_cast<std::size_t>(32 - __builtin_clz(value))};
+        if(index >= BUCKETS)
+        {
+            index = BUCKETS - 1;
+        }
+        buckets_[index].store(buckets_[index].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    /// Reader side, a requested reset reads as empty histogram
+    std::uint32_t getBucket(std::size_t index) const
+    {
+        return resetRequested_.load(std::memory_order_acquire) ? 0 : buckets_[index].load(std::memory_order_relaxed);
+    }
+
+    void reset() { resetRequested_.store(true, std::memory_order_release); }
+
+    static constexpr std::size_t size() { return BUCKETS; }
+
+private:
+    etl::array<std::atomic<std::uint32_t>, BUCKETS> buckets_{};
+    std::atomic<bool> resetRequested_{false};
+};
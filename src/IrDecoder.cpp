@@ -1,197 +1,124 @@
 #include "IrDecoder.h"
 
-#define ONE_TIME 1600
-#define ZERO_TIME 500
-#define BIT_TOLERANCE 250
+bool IrDecoder::getData(IrDecoder::Data& data)
+{
+    return events_.pop(data);
+}
 
-IrDecoder::CallbackDelegateType IrDecoder::callbackDelegate_{};
+std::size_t IrDecoder::getEvents(etl::span<IrDecoder::Data> events)
+{
+    return events_.drain(events);
+}
 
-void IrDecoder::gpioCallbackTrampoline(unsigned int pin, std::uint32_t events)
+void IrDecoder::emitFrame(const IrProtocolMatcher::Frame& frame)
 {
-    if(callbackDelegate_.is_valid())
+    if(frameDecoded_)
     {
-        callbackDelegate_(pin, events);
+        return;
     }
-}
+    frameDecoded_ = true;
 
-void IrDecoder::initialize(const bool withPull)
-{
-    callbackDelegate_ = CallbackDelegateType::create<IrDecoder, &IrDecoder::gpioCallbackFunction>(*this);
+    // protocols without repeat code send the whole frame again (with the same toggle bit) while the key is held
+    const bool repeated{lastDataValid_ && (lastData_.protocol == frame.protocol) && (lastData_.code == frame.code) &&
+                        ((frameStartUs_ - lastFrameStartUs_) <= REPEAT_WINDOW_US)};
+
+    lastData_ = Data{frame.protocol, frame.command, frame.address, frame.code, false, frameEndUs_, 0};
+    lastDataValid_ = true;
+    lastFrameStartUs_ = frameStartUs_;
+
+    Data data{lastData_};
+    data.repeated = repeated;
+    pushEvent(data);
 
-    gpio_init(irPin_);
-    gpio_set_dir(irPin_, GPIO_IN);
-    if(withPull)
+    if(repeated)
     {
-        gpio_set_pulls(irPin_, irInvert_, !irInvert_);
+        statistics_.repeats++;
     }
     else
     {
-        gpio_disable_pulls(irPin_);
+        statistics_.frames++;
     }
-
-    gpio_set_irq_enabled_with_callback(irPin_, GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL, true, &IrDecoder::gpioCallbackTrampoline);
+    if(frame.correctedBits != 0)
+    {
+        statistics_.corrected++;
+    }
+    trace(repeated ? TraceEvent::REPEAT : TraceEvent::FRAME, static_cast<std::uint8_t>(frame.protocol));
 }
 
-bool IrDecoder::getData(IrDecoder::Data& data)
+void IrDecoder::emitRepeat(IrProtocolId protocol)
 {
-    const bool ret{dataIsNew_};
-    dataIsNew_ = false;
-    data = data_;
-    return ret;
+    if(frameDecoded_)
+    {
+        return;
+    }
+    frameDecoded_ = true;
+
+    const bool sameProtocol{(protocol == IrProtocolId::NEC) ?
+        ((lastData_.protocol == IrProtocolId::NEC) || (lastData_.protocol == IrProtocolId::NEC_EXTENDED)) :
+        (lastData_.protocol == protocol)};
+    if(lastDataValid_ && sameProtocol)
+    {
+        Data data{lastData_};
+        data.repeated = true;
+        data.timestampUs = frameEndUs_;
+        pushEvent(data);
+        statistics_.repeats++;
+        trace(TraceEvent::REPEAT, static_cast<std::uint8_t>(data.protocol));
+    }
 }
 
-void IrDecoder::gpioCallbackFunction(unsigned int, std::uint32_t events)
+void IrDecoder::pushEvent(Data data)
 {
-    const std::uint64_t currentTimeStamp = time_us_64();
-    const bool level{static_cast<bool>(irInvert_ ? events & GPIO_IRQ_EDGE_FALL : events & GPIO_IRQ_EDGE_RISE)};
-    
-    /*
-    const std::uint32_t timeDiff{static_cast<std::uint32_t>(currentTimeStamp - lastTimeStamp_)};
-    printf("Level: %u time: %u\n", level, timeDiff);
-    */
-    
-    switch (state_)
+    data.readyUs = time_us_64();
+    if(events_.push(data) && eventNotifier_.is_valid())
     {
-    case DecoderState::IDLE:
-        if(level)
-        {
-            setState(DecoderState::WAIT_FOR_START);
-        }
-        break;
-
-    case DecoderState::WAIT_FOR_START:
-        if(!level)
-        {
-            if(isPulseInRange(currentTimeStamp, 9000))
-            {
-                setState(DecoderState::ADDRESS_OR_REPEAT);
-            }
-            else
-            {
-                setState(DecoderState::IDLE);
-                const std::uint32_t timeDiff{static_cast<std::uint32_t>(currentTimeStamp - lastTimeStamp_)};
-                printf("Invalid start time: %lu\n", timeDiff);
-            }
-            
-        }
-        else
-        {
-            setState(DecoderState::IDLE);
-            printf("Invalid level after expected start\n");
-        }
-        break;
-
-    case DecoderState::ADDRESS_OR_REPEAT:
-        if(level)
-        {
-            if(isPulseInRange(currentTimeStamp, 4500))
-            {
-                setState(DecoderState::RECEIVE_FRAME);
-                frameData_ = 0;
-                bitCounter_ = 0;
-            }
-            else if(isPulseInRange(currentTimeStamp, 2250))
-            {
-                data_.repeated = true;
-                dataIsNew_ = true;
-                setState(DecoderState::WAIT_END);
-            }
-        }
-        else
-        {
-            setState(DecoderState::IDLE);
-            printf("Invalid level after wait address or repeat\n");
-        }
-        break;
-
-    case DecoderState::RECEIVE_FRAME:
-        if(level)
-        {
-            if(isPulseInRange(currentTimeStamp, ZERO_TIME, BIT_TOLERANCE)) //0
-            {
-                frameData_>>=1;
-                bitCounter_++;
-            }
-            else if(isPulseInRange(currentTimeStamp, ONE_TIME, BIT_TOLERANCE)) //1
-            {
-                frameData_>>=1;
-                frameData_ |= 0x80000000;
-                bitCounter_++;
-            }
-            else
-            {
-                const std::uint32_t timeDiff{static_cast<std::uint32_t>(currentTimeStamp - lastTimeStamp_)};
-                printf("Invalid bit length: %lu\n", timeDiff);
-                setState(DecoderState::IDLE);
-            }
-
-            if(bitCounter_ >= 32)
-            {
-                const std::uint8_t command_inverse = static_cast<std::uint8_t>(frameData_ >> 24);
-                const std::uint8_t command = static_cast<std::uint8_t>(frameData_>> 16);
-                const std::uint8_t address_inverse = static_cast<std::uint8_t>(frameData_ >> 8);
-                const std::uint8_t address = static_cast<std::uint8_t>(frameData_);
-                
-                if((command + command_inverse == 0xFF) && (address + address_inverse == 0xFF))
-                {
-                    data_.address = address;
-                    data_.command = command;
-                    data_.repeated = false;
-                    dataIsNew_ = true;
-                    printf("Got frame: Command: %x, Address: %x\n", command, address);
-                }
-                else
-                {
-                    printf("Got invalid frame: 0x%lx c: %x, ci: %x, a: %x, ai: %x\n", frameData_, command, command_inverse, address, address_inverse);
-                }
-                setState(DecoderState::WAIT_END);
-            }
-        }
-        break;
-    
-    case DecoderState::WAIT_END:
-        if(!level)
-        {
-            setState(DecoderState::IDLE);
-        }
-        break;
-
-    default:
-        setState(DecoderState::IDLE);
-        break;
+        eventNotifier_();
     }
-    
-    lastTimeStamp_ = currentTimeStamp;
 }
 
-void IrDecoder::setState(IrDecoder::DecoderState newState)
+void IrDecoder::rejectFrame()
 {
-    switch(newState)
+    if(frameDecoded_)
     {
-    case DecoderState::WAIT_FOR_START:
-        timeoutAlarmId_ = add_alarm_in_ms(100, &IrDecoder::timeoutAlarmCallback, this, false);
-        if(led_ != nullptr) led_->on();
+        return;
+    }
+
+    switch(frameReject_)
+    {
+    case IrProtocolMatcher::Result::INVALID_CHECKSUM:
+        statistics_.invalidChecksum++;
         break;
-    case DecoderState::IDLE:
-        cancel_alarm(timeoutAlarmId_);
-        if(led_ != nullptr) led_->off();
+    case IrProtocolMatcher::Result::INVALID_BIT:
+        statistics_.invalidBit++;
         break;
     default:
+        statistics_.invalidHeader++;
         break;
     }
+    trace(TraceEvent::REJECT, static_cast<std::uint8_t>(frameReject_));
+}
 
-    state_ = newState;
+std::uint32_t IrDecoder::startFrame()
+{
+    frameDecoded_ = false;
+    frameReject_ = IrProtocolMatcher::Result::BUSY;
+    return enabledProtocols_.load(std::memory_order_relaxed);
 }
 
-bool IrDecoder::isPulseInRange(std::uint64_t now, std::uint32_t timeUs, std::uint32_t tolerance)
+void IrDecoder::enterState(IrDecoder::DecoderState newState)
 {
-    const std::uint32_t timeDiff{static_cast<std::uint32_t>(now - lastTimeStamp_)};
-    const std::uint32_t targetDiff{(timeUs > timeDiff) ? timeUs - timeDiff : timeDiff - timeUs};
-    return targetDiff <= tolerance;
+    if(newState != state_)
+    {
+        trace(TraceEvent::STATE, static_cast<std::uint8_t>(newState));
+    }
+    state_ = newState;
 }
 
-std::int64_t IrDecoder::timeoutAlarmCallback(alarm_id_t id, void *user_data)
+void IrDecoder::trace(TraceEvent event, std::uint8_t value)
 {
-    reinterpret_cast<IrDecoder*>(user_data)->setState(DecoderState::IDLE);
-    return 0;
-}
\ No newline at end of file
+    trace_.write(TraceEntry{static_cast<std::uint32_t>(timeUs_), event, value});
+    if(statusNotifier_.is_valid())
+    {
+        statusNotifier_(event, value);
+    }
+}
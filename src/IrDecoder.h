@@ -1,61 +1,300 @@
 #pragma once
+#include <atomic>
 #include <cstdint>
+#include <tuple>
+#include "etl/array.h"
 #include "etl/delegate.h"
+#include "etl/span.h"
 #include "pico/stdlib.h"
-#include "LedInterface.h"
+#include "EdgeSourceInterface.h"
+#include "IrProtocol.h"
+#include "IrProtocolMatcher.h"
+#include "SpscQueue.h"
+#include "TraceRing.h"
 
+/// Protocol independent part of the decoder: event queue, repeat detection, statistics and trace.
+/// The decoder of a set of protocols is IrDecoderFor, everyone else only needs this part.
 class IrDecoder
 {
 public:
     struct Data
     {
-        std::uint8_t address;
+        IrProtocolId protocol;
         std::uint8_t command;
+        std::uint16_t address;
+        std::uint32_t code; ///< All bits of the frame as received (including checksum / toggle bits)
         bool repeated;
+        std::uint64_t timestampUs; ///< Time (time_us_64) of the last edge of the frame
+        std::uint64_t readyUs;     ///< Time (time_us_64) the event was queued by the decoder
     };
 
-    IrDecoder(const unsigned int pin, const bool idleHigh = false, LedInterface* const led = nullptr) :
-    irPin_{pin},
-    irInvert_{idleHigh},
-    led_{led}
-    {}
+    struct Statistics
+    {
+        std::uint32_t frames;          ///< Valid frames decoded
+        std::uint32_t repeats;         ///< Repeat codes and repeated frames decoded
+        std::uint32_t invalidHeader;   ///< Rejected because no protocol matched the header
+        std::uint32_t invalidBit;      ///< Rejected because of a bit length or frame length
+        std::uint32_t invalidChecksum; ///< Rejected because of the checksum of the protocol
+        std::uint32_t corrected;       ///< Valid frames which passed the checksum after flipping low confidence bits
+    };
+
+    enum class TraceEvent : std::uint8_t
+    {
+        STATE,  ///< Decoder state changed, value: DecoderState (0 idle, 1 frame, 2 wait for gap)
+        FRAME,  ///< Frame decoded, value: IrProtocolId
+        REPEAT, ///< Repeat code or repeated frame decoded, value: IrProtocolId
+        REJECT  ///< Frame rejected, value: IrProtocolMatcher::Result of the protocol that got furthest
+    };
+
+    struct TraceEntry
+    {
+        std::uint32_t timestampUs; ///< Signal time (time_us_64, wraps) of the pulse which caused the entry
+        TraceEvent event;
+        std::uint8_t value;
+    };
+
+    static constexpr std::uint32_t ALL_PROTOCOLS{0xFFFFFFFF};
+
+    static constexpr std::size_t TRACE_SIZE{64};
+    using Trace = TraceRing<TraceEntry, TRACE_SIZE>;
+
+    /// Called from the decoding context (interrupt) after an event was queued, e.g. to wake up the consumer
+    using EventNotifier = etl::delegate<void()>;
+
+    /// Called from the decoding context with every trace entry (state changes and results), e.g. for a status LED.
+    /// Must not block, the decoder runs in the capture interrupt.
+    using StatusNotifier = etl::delegate<void(TraceEvent event, std::uint8_t value)>;
+
+    void setEventNotifier(EventNotifier notifier) { eventNotifier_ = notifier; }
+
+    void setStatusNotifier(StatusNotifier notifier) { statusNotifier_ = notifier; }
+
+    /// Decode only the protocols with their bit (1 << IrProtocolId) set, NEC includes NEC extended.
+    /// Can be called from another core, takes effect with the next frame.
+    void setEnabledProtocols(std::uint32_t mask) { enabledProtocols_.store(mask, std::memory_order_relaxed); }
 
-    void initialize(const bool withPull = true);
+    /// True if decoded events are waiting to be taken
+    bool hasEvents() const { return !events_.empty(); }
 
+    /// Take the oldest decoded event
     bool getData(Data& data);
 
-private:
-    enum class DecoderState
+    /// Take all pending decoded events (up to the size of the target), returns the number of events taken
+    std::size_t getEvents(etl::span<Data> events);
+
+    /// Number of events lost because they were not taken fast enough
+    std::uint32_t getOverflowCount() const { return events_.getOverflowCount(); }
+
+    const Statistics& getStatistics() const { return statistics_; }
+
+    /// Latest state transitions and decode results, written from the decoding context without locks
+    const Trace& getTrace() const { return trace_; }
+
+protected:
+    enum class DecoderState : std::uint8_t
     {
-        IDLE,
-        WAIT_FOR_START,
-        ADDRESS_OR_REPEAT,
-        RECEIVE_FRAME,
-        WAIT_END
+        IDLE,        ///< Waiting for the first mark of a frame
+        FRAME,       ///< All protocols are matched against the pulses
+        WAIT_FOR_GAP ///< Frame timed out, wait for the idle time before the next frame
     };
 
-    using CallbackDelegateType = etl::delegate<void(unsigned int, std::uint32_t)>;
-    const unsigned int irPin_;
-    const bool irInvert_;
-    LedInterface* const led_;
+    static constexpr std::uint32_t FRAME_GAP_US{6000};         ///< Longer than any space inside a frame of the supported protocols
+    static constexpr std::uint64_t FRAME_TIMEOUT_US{100000};   ///< Longer frames are noise, wait for the next gap
+    static constexpr std::uint64_t REPEAT_WINDOW_US{250000};   ///< The same frame again within this time is a held key
+    static constexpr std::size_t EVENT_QUEUE_SIZE{16};
+
+    explicit IrDecoder(EdgeSourceInterface& edgeSource) :
+    edgeSource_{edgeSource}
+    {}
+
+    EdgeSourceInterface& edgeSource_;
     DecoderState state_{DecoderState::IDLE};
-    std::uint8_t bitCounter_{0};
-    std::uint64_t lastTimeStamp_{0};
-    std::uint32_t frameData_{0};
-    Data data_{0};
-    bool dataIsNew_{false};
-    alarm_id_t timeoutAlarmId_{-1};
-    static CallbackDelegateType callbackDelegate_;
-    
+    std::uint64_t timeUs_{0};           ///< End of the current pulse
+    std::uint64_t frameStartUs_{0};
+    std::uint64_t frameEndUs_{0};       ///< End of the last pulse of the frame
+    std::uint64_t lastFrameStartUs_{0};
+    bool frameDecoded_{false};
+    IrProtocolMatcher::Result frameReject_{IrProtocolMatcher::Result::BUSY};
+    bool lastDataValid_{false};
+    Data lastData_{};
+    SpscQueue<Data, EVENT_QUEUE_SIZE> events_{};
+    Statistics statistics_{};
+    Trace trace_{};
+    EventNotifier eventNotifier_{};
+    StatusNotifier statusNotifier_{};
+    std::atomic<std::uint32_t> enabledProtocols_{ALL_PROTOCOLS};
 
+    void emitFrame(const IrProtocolMatcher::Frame& frame);
+    void emitRepeat(IrProtocolId protocol);
+    void pushEvent(Data data);
+    void rejectFrame();
+    std::uint32_t startFrame();
+    void enterState(DecoderState newState);
+    void trace(TraceEvent event, std::uint8_t value);
 
+    // called for every pulse and protocol, the common results (busy, ignored) stay in the capture interrupt without a call
+    void handleResult(const IrProtocolMatcher& matcher, IrProtocolId protocol, IrProtocolMatcher::Result result)
+    {
+        switch(result)
+        {
+        case IrProtocolMatcher::Result::FRAME:
+            emitFrame(matcher.getFrame());
+            break;
+
+        case IrProtocolMatcher::Result::REPEAT:
+            emitRepeat(protocol);
+            break;
+
+        case IrProtocolMatcher::Result::INVALID_HEADER:
+        case IrProtocolMatcher::Result::INVALID_BIT:
+        case IrProtocolMatcher::Result::INVALID_CHECKSUM:
+            if(result > frameReject_) // keep the reason of the protocol that got furthest
+            {
+                frameReject_ = result;
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+};
 
-    
-    void gpioCallbackFunction(unsigned int gpio, std::uint32_t events);
-    static void gpioCallbackTrampoline(unsigned int gpio, std::uint32_t events);
-    bool isPulseInRange(std::uint64_t now, std::uint32_t timeUs, std::uint32_t tolerance = 500u);
+/// Decoder of the given protocols, matched in parallel on the same pulses.
+/// The matchers are separate types, so the loops over them are unrolled into direct (inlinable) calls and a protocol
+/// which is not in the list adds no code to the capture interrupt.
+template<const IrProtocolDescriptor&... PROTOCOLS>
+class IrDecoderFor final : public IrDecoder
+{
+public:
+    explicit IrDecoderFor(EdgeSourceInterface& edgeSource) :
+    IrDecoder{edgeSource}
+    {}
+
+    /// Register decode() as pulse handler of the edge source, not needed if decode() is called by someone else
+    void initialize()
+    {
+        edgeSource_.initialize(EdgeSourceInterface::PulseHandler::create<IrDecoderFor, &IrDecoderFor::decode>(*this));
+    }
+
+    /// Decode a batch of pulses ending at the given time, called by the edge source but can also be fed directly.
+    /// An empty batch ends the current frame (idle time detected by the edge source).
+    void decode(etl::span<const IrPulse> pulses, std::uint64_t endTimeUs);
+
+private:
+    std::tuple<IrProtocolMatcherFor<PROTOCOLS>...> matchers_{};
+
+    void processPulse(const IrPulse& pulse);
+    void endFrame(DecoderState newState);
     void setState(DecoderState newState);
 
-    static std::int64_t timeoutAlarmCallback(alarm_id_t id, void *user_data);
+    template<typename Function>
+    void forEachMatcher(Function function)
+    {
+        std::apply([&function](auto&... matcher) { (function(matcher), ...); }, matchers_);
+    }
+};
+
+/// Decoder of all supported protocols (IrProtocols::ALL)
+using IrDecoderAll = IrDecoderFor<IrProtocols::NEC, IrProtocols::SAMSUNG, IrProtocols::SONY, IrProtocols::RC5, IrProtocols::RC6>;
+
+template<const IrProtocolDescriptor&... PROTOCOLS>
+void IrDecoderFor<PROTOCOLS...>::decode(etl::span<const IrPulse> pulses, std::uint64_t endTimeUs)
+{
+    if(pulses.empty()) // the edge source detected the idle time, the last frame is complete
+    {
+        timeUs_ = endTimeUs;
+        endFrame(DecoderState::IDLE);
+        return;
+    }
+
+    std::uint64_t batchUs{0};
+    for(const IrPulse& pulse : pulses)
+    {
+        batchUs += pulse.durationUs;
+    }
+    timeUs_ = endTimeUs - batchUs;
+
+    for(const IrPulse& pulse : pulses)
+    {
+        processPulse(pulse);
+    }
+}
+
+template<const IrProtocolDescriptor&... PROTOCOLS>
+void IrDecoderFor<PROTOCOLS...>::processPulse(const IrPulse& pulse)
+{
+    timeUs_ += pulse.durationUs;
+
+    if(!pulse.mark && (pulse.durationUs >= FRAME_GAP_US))
+    {
+        endFrame(DecoderState::IDLE);
+        return;
+    }
+
+    switch (state_)
+    {
+    case DecoderState::IDLE:
+        if(!pulse.mark)
+        {
+            break;
+        }
+        frameStartUs_ = timeUs_ - pulse.durationUs;
+        setState(DecoderState::FRAME);
+        [[fallthrough]];
+
+    case DecoderState::FRAME:
+        if((timeUs_ - frameStartUs_) > FRAME_TIMEOUT_US)
+        {
+            endFrame(DecoderState::WAIT_FOR_GAP);
+            break;
+        }
+        frameEndUs_ = timeUs_;
+        // every protocol sees the pulse once, no re-scan of the frame
+        forEachMatcher([this, &pulse](auto& matcher)
+        {
+            handleResult(matcher, matcher.getProtocol().id, matcher.feed(pulse));
+        });
+        break;
+
+    default:
+        break;
+    }
+}
+
+template<const IrProtocolDescriptor&... PROTOCOLS>
+void IrDecoderFor<PROTOCOLS...>::endFrame(DecoderState newState)
+{
+    if(state_ == DecoderState::FRAME)
+    {
+        // frames with variable length are only complete after the idle time
+        forEachMatcher([this](auto& matcher)
+        {
+            if(matcher.isActive())
+            {
+                handleResult(matcher, matcher.getProtocol().id, matcher.finish());
+            }
+        });
+        rejectFrame();
+    }
+
+    setState(newState);
+}
+
+template<const IrProtocolDescriptor&... PROTOCOLS>
+void IrDecoderFor<PROTOCOLS...>::setState(DecoderState newState)
+{
+    if((newState == DecoderState::FRAME) && (state_ != DecoderState::FRAME))
+    {
+        const std::uint32_t enabled{startFrame()};
+        forEachMatcher([enabled](auto& matcher)
+        {
+            if((enabled & (1u << static_cast<unsigned int>(matcher.getProtocol().id))) != 0) // disabled matchers stay inactive
+            {
+                matcher.start();
+            }
+        });
+    }
 
-};
\ No newline at end of file
+    enterState(newState);
+}
@@ -0,0 +1,23 @@
+#include "IrEventCombiner.h"
+
+bool IrEventCombiner::accept(const IrDecoder::Data& data, std::uint8_t receiver)
+{
+    for(std::size_t i = 0; i < historyCount_; i++)
+    {
+        const Entry& entry{history_[i]};
+        const std::uint64_t differenceUs{(data.timestampUs > entry.timestampUs) ? data.timestampUs - entry.timestampUs : entry.timestampUs - data.timestampUs};
+        if((entry.receiver != receiver) && (entry.protocol == data.protocol) && (entry.code == data.code) && (differenceUs <= windowUs_))
+        {
+            duplicateCount_++;
+            return false;
+        }
+    }
+
+    history_[next_] = Entry{data.protocol, receiver, data.code, data.timestampUs};
+    next_ = (next_ + 1) % history_.size();
+    if(historyCount_ < history_.size())
+    {
+        historyCount_++;
+    }
+    return true;
+}
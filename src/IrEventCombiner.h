@@ -0,0 +1,40 @@
+#pragma once
+#include <cstdint>
+#include "etl/array.h"
+#include "IrDecoder.h"
+
+/// Merges the events of several receivers: a frame decoded by another receiver within the time window is the
+/// same frame seen from a different direction and dropped. Events of the same receiver are always accepted,
+/// they are real repeats. The first receiver seeing a frame wins, so no event is delayed.
+class IrEventCombiner
+{
+public:
+    static constexpr std::uint32_t DEFAULT_WINDOW_US{20000}; // much shorter than the repeat period of all protocols
+
+    explicit IrEventCombiner(const std::uint32_t windowUs = DEFAULT_WINDOW_US) :
+    windowUs_{windowUs}
+    {}
+
+    /// Returns false if the event is a duplicate of an event already accepted from another receiver
+    bool accept(const IrDecoder::Data& data, std::uint8_t receiver);
+
+    /// Number of events dropped as duplicate
+    std::uint32_t getDuplicateCount() const { return duplicateCount_; }
+
+private:
+    struct Entry
+    {
+        IrProtocolId protocol;
+        std::uint8_t receiver;
+        std::uint32_t code;
+        std::uint64_t timestampUs;
+    };
+
+    static constexpr std::size_t HISTORY_SIZE{4}; // events of different frames within the window are rare
+
+    const std::uint32_t windowUs_;
+    etl::array<Entry, HISTORY_SIZE> history_{};
+    std::size_t historyCount_{0};
+    std::size_t next_{0};
+    std::uint32_t duplicateCount_{0};
+};
@@ -0,0 +1,138 @@
+#pragma once
+#include <cstdint>
+#include "etl/array.h"
+
+enum class IrProtocolId : std::uint8_t
+{
+    NEC,
+    NEC_EXTENDED, ///< NEC with 16 bit address (no inverse address byte)
+    SAMSUNG,
+    SONY,
+    RC5,
+    RC6,
+};
+
+/// Protocol, address and command of a code in one word, e.g. as lookup key
+constexpr std::uint32_t makeCodeKey(IrProtocolId protocol, std::uint16_t address, std::uint8_t command)
+{
+    return (static_cast<std::uint32_t>(protocol) << 24) | (static_cast<std::uint32_t>(address) << 8) | command;
+}
+
+enum class IrBitEncoding : std::uint8_t
+{
+    PULSE_DISTANCE, ///< Constant mark, the bit value is given by the length of the following space
+    PULSE_WIDTH,    ///< Constant space, the bit value is given by the length of the mark
+    MANCHESTER      ///< Bi-phase, every bit consists of two half bits with different levels
+};
+
+enum class IrChecksumRule : std::uint8_t
+{
+    NONE,
+    NEC,    ///< Inverse command byte, inverse address byte (or 16 bit address for extended NEC)
+    SAMSUNG ///< Address byte sent twice, inverse command byte
+};
+
+/// Timing and framing of one protocol, all times in µs
+struct IrProtocolDescriptor
+{
+    IrProtocolId id;
+    IrBitEncoding encoding;
+    IrChecksumRule checksum;
+    bool msbFirst;
+    std::uint16_t headerMarkUs;      ///< 0 if the frame starts directly with the first bit
+    std::uint16_t headerSpaceUs;     ///< 0 if the header mark is directly followed by the first bit
+    std::uint16_t repeatSpaceUs;     ///< Header space of a repeat code, 0 if the protocol has no repeat code
+    std::uint16_t headerToleranceUs;
+    std::uint16_t markUs;            ///< Pulse distance: bit mark, pulse width: zero mark, Manchester: half bit time
+    std::uint16_t spaceUs;           ///< Pulse distance: zero space, pulse width: space between the bits
+    std::uint16_t oneUs;             ///< Pulse distance: one space, pulse width: one mark
+    std::uint16_t bitToleranceUs;
+    std::uint8_t longBitIndex;       ///< Manchester: index of the bit with double half bit time (RC6 trailer), 0xFF if none
+    bool oneIsMarkFirst;             ///< Manchester: level order of a 1 bit
+    std::uint32_t validBitCounts;    ///< Bit mask of the allowed frame lengths, see bitCount()
+    std::uint32_t framePeriodUs;     ///< Time from the start of a frame to the start of the next (repeat) frame while a key is held
+
+    /// Bit mask entry for a frame length of n bits (1...32)
+    static constexpr std::uint32_t bitCount(std::uint8_t bits)
+    {
+        return 1ul << (bits - 1);
+    }
+
+    constexpr bool isValidBitCount(std::uint8_t bits) const
+    {
+        return (bits > 0) && (bits <= 32) && ((validBitCounts & bitCount(bits)) != 0);
+    }
+
+    constexpr std::uint8_t getMaxBits() const
+    {
+        std::uint8_t bits{32};
+        while((bits > 0) && !isValidBitCount(bits))
+        {
+            bits--;
+        }
+        return bits;
+    }
+
+    constexpr std::uint8_t getMinBits() const
+    {
+        std::uint8_t bits{1};
+        while((bits <= 32) && !isValidBitCount(bits))
+        {
+            bits++;
+        }
+        return bits;
+    }
+};
+
+namespace IrProtocols
+{
+    inline constexpr std::uint8_t NO_LONG_BIT{0xFF};
+
+    inline constexpr IrProtocolDescriptor NEC
+    {
+        IrProtocolId::NEC, IrBitEncoding::PULSE_DISTANCE, IrChecksumRule::NEC, false,
+        9000, 4500, 2250, 500,
+        560, 560, 1690, 250,
+        NO_LONG_BIT, false, IrProtocolDescriptor::bitCount(32),
+        108000
+    };
+
+    inline constexpr IrProtocolDescriptor SAMSUNG
+    {
+        IrProtocolId::SAMSUNG, IrBitEncoding::PULSE_DISTANCE, IrChecksumRule::SAMSUNG, false,
+        4500, 4500, 0, 500,
+        560, 560, 1690, 250,
+        NO_LONG_BIT, false, IrProtocolDescriptor::bitCount(32),
+        108000
+    };
+
+    inline constexpr IrProtocolDescriptor SONY
+    {
+        IrProtocolId::SONY, IrBitEncoding::PULSE_WIDTH, IrChecksumRule::NONE, false,
+        2400, 0, 0, 300,
+        600, 600, 1200, 250,
+        NO_LONG_BIT, false, IrProtocolDescriptor::bitCount(12) | IrProtocolDescriptor::bitCount(15) | IrProtocolDescriptor::bitCount(20),
+        45000
+    };
+
+    inline constexpr IrProtocolDescriptor RC5
+    {
+        IrProtocolId::RC5, IrBitEncoding::MANCHESTER, IrChecksumRule::NONE, true,
+        0, 0, 0, 0,
+        889, 0, 0, 250,
+        NO_LONG_BIT, false, IrProtocolDescriptor::bitCount(14),
+        114000 // 64 bit times
+    };
+
+    inline constexpr IrProtocolDescriptor RC6
+    {
+        IrProtocolId::RC6, IrBitEncoding::MANCHESTER, IrChecksumRule::NONE, true,
+        2666, 889, 0, 300,
+        444, 0, 0, 180,
+        4, true, IrProtocolDescriptor::bitCount(21), // start bit, 3 mode bits, trailer (toggle), 16 data bits (mode 0)
+        107000 // 240 half bit times
+    };
+
+    /// All supported protocols, the decoder of a board matches a subset of them (see Board.h)
+    inline constexpr etl::array<IrProtocolDescriptor, 5> ALL{NEC, SAMSUNG, SONY, RC5, RC6};
+}
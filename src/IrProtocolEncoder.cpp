@@ -0,0 +1,162 @@
+#include "IrProtocolEncoder.h"
+
+std::size_t IrProtocolEncoder::encode(IrProtocolId protocol, std::uint16_t address, std::uint8_t command, bool toggle, std::uint8_t bits, etl::span<IrPulse> pulses)
+{
+    const IrProtocolDescriptor* const descriptor{findDescriptor(protocol)};
+    if(descriptor == nullptr)
+    {
+        return 0;
+    }
+    if(bits == 0)
+    {
+        bits = descriptor->getMinBits();
+    }
+    std::uint32_t code{0};
+    if(!descriptor->isValidBitCount(bits) || !createCode(protocol, address, command, toggle, bits, code))
+    {
+        return 0;
+    }
+
+    PulseWriter writer{pulses};
+    if(descriptor->headerMarkUs != 0)
+    {
+        writer.add(true, descriptor->headerMarkUs);
+    }
+    if(descriptor->headerSpaceUs != 0)
+    {
+        writer.add(false, descriptor->headerSpaceUs);
+    }
+
+    for(std::uint8_t i = 0; i < bits; i++)
+    {
+        const std::uint8_t index{descriptor->msbFirst ? static_cast<std::uint8_t>(bits - 1 - i) : i};
+        const bool one{(code & (1ul << index)) != 0};
+
+        switch(descriptor->encoding)
+        {
+        case IrBitEncoding::PULSE_DISTANCE:
+            writer.add(true, descriptor->markUs);
+            writer.add(false, one ? descriptor->oneUs : descriptor->spaceUs);
+            break;
+
+        case IrBitEncoding::PULSE_WIDTH:
+            writer.add(false, descriptor->spaceUs);
+            writer.add(true, one ? descriptor->oneUs : descriptor->markUs);
+            break;
+
+        case IrBitEncoding::MANCHESTER:
+        {
+            const std::uint32_t halfBitUs{(i == descriptor->longBitIndex) ? 2u * descriptor->markUs : descriptor->markUs};
+            const bool firstHalfMark{one == descriptor->oneIsMarkFirst};
+            writer.add(firstHalfMark, halfBitUs);
+            writer.add(!firstHalfMark, halfBitUs);
+            break;
+        }
+        }
+    }
+
+    if(descriptor->encoding == IrBitEncoding::PULSE_DISTANCE) // stop bit, ends the last space
+    {
+        writer.add(true, descriptor->markUs);
+    }
+    return writer.getCount();
+}
+
+std::size_t IrProtocolEncoder::encodeRepeat(IrProtocolId protocol, etl::span<IrPulse> pulses)
+{
+    const IrProtocolDescriptor* const descriptor{findDescriptor(protocol)};
+    if((descriptor == nullptr) || (descriptor->repeatSpaceUs == 0))
+    {
+        return 0;
+    }
+
+    PulseWriter writer{pulses};
+    writer.add(true, descriptor->headerMarkUs);
+    writer.add(false, descriptor->repeatSpaceUs);
+    writer.add(true, descriptor->markUs);
+    return writer.getCount();
+}
+
+std::uint32_t IrProtocolEncoder::getFramePeriodUs(IrProtocolId protocol)
+{
+    const IrProtocolDescriptor* const descriptor{findDescriptor(protocol)};
+    return (descriptor == nullptr) ? 0 : descriptor->framePeriodUs;
+}
+
+const IrProtocolDescriptor* IrProtocolEncoder::findDescriptor(IrProtocolId protocol)
+{
+    if(protocol == IrProtocolId::NEC_EXTENDED)
+    {
+        protocol = IrProtocolId::NEC;
+    }
+    for(const IrProtocolDescriptor& descriptor : IrProtocols::ALL)
+    {
+        if(descriptor.id == protocol)
+        {
+            return &descriptor;
+        }
+    }
+    return nullptr;
+}
+
+bool IrProtocolEncoder::createCode(IrProtocolId protocol, std::uint16_t address, std::uint8_t command, bool toggle, std::uint8_t bits, std::uint32_t& code)
+{
+    // same bit layout as IrProtocolMatcher::complete()
+    const std::uint32_t commandBytes{static_cast<std::uint32_t>(command) << 16 | static_cast<std::uint32_t>(static_cast<std::uint8_t>(~command)) << 24};
+    switch(protocol)
+    {
+    case IrProtocolId::NEC:
+        if(address > 0xFF) return false;
+        code = address | static_cast<std::uint32_t>(static_cast<std::uint8_t>(~address)) << 8 | commandBytes;
+        return true;
+
+    case IrProtocolId::NEC_EXTENDED:
+        code = address | commandBytes;
+        return true;
+
+    case IrProtocolId::SAMSUNG:
+        if(address > 0xFF) return false;
+        code = address | static_cast<std::uint32_t>(address) << 8 | commandBytes;
+        return true;
+
+    case IrProtocolId::SONY: // 7 bit command, the address takes the remaining 5, 8 or 13 bits
+        if((command > 0x7F) || (address >= (1ul << (bits - 7)))) return false;
+        code = command | static_cast<std::uint32_t>(address) << 7;
+        bits = (address <= 0x1F) ? 12 : ((address <= 0xFF) ? 15 : 20);
+        return true;
+
+    case IrProtocolId::RC5: // start bit, field bit (inverse command bit 6), toggle, 5 bit address, 6 bit command
+        if((command > 0x7F) || (address > 0x1F)) return false;
+        code = 1ul << 13 | (((command & 0x40) == 0) ? 1ul << 12 : 0) | (toggle ? 1ul << 11 : 0) | static_cast<std::uint32_t>(address) << 6 | (command & 0x3F);
+        return true;
+
+    case IrProtocolId::RC6: // start bit, mode 0, trailer (toggle), 8 bit address, 8 bit command
+        if(address > 0xFF) return false;
+        code = 1ul << 20 | (toggle ? 1ul << 16 : 0) | static_cast<std::uint32_t>(address) << 8 | command;
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+void IrProtocolEncoder::PulseWriter::add(bool mark, std::uint32_t durationUs)
+{
+    if((count_ == 0) && !mark)
+    {
+        return;
+    }
+
+    if((count_ > 0) && (pulses_[count_ - 1].mark == mark))
+    {
+        pulses_[count_ - 1].durationUs += durationUs;
+    }
+    else if(count_ < pulses_.size())
+    {
+        pulses_[count_++] = IrPulse{durationUs, mark};
+    }
+    else
+    {
+        overflow_ = true;
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+#include "etl/span.h"
+#include "EdgeSourceInterface.h"
+#include "IrProtocol.h"
+
+/// Creates the pulses of a frame from the protocol descriptors, the inverse of IrProtocolMatcher
+class IrProtocolEncoder
+{
+public:
+    /// Enough for the longest frame of all protocols
+    static constexpr std::size_t MAX_PULSES{72};
+
+    /// Pulses of one frame starting with the first mark, returns the number of pulses or 0 if the address or command
+    /// does not fit in the protocol, the protocol has no frame of that many bits (0 for the shortest one) or the target is too small
+    static std::size_t encode(IrProtocolId protocol, std::uint16_t address, std::uint8_t command, bool toggle, std::uint8_t bits, etl::span<IrPulse> pulses);
+
+    /// Pulses of the repeat code sent while the key is held, returns 0 if the protocol sends the whole frame again
+    static std::size_t encodeRepeat(IrProtocolId protocol, etl::span<IrPulse> pulses);
+
+    /// Time from the start of a frame to the start of the next one while a key is held, 0 for an unknown protocol
+    static std::uint32_t getFramePeriodUs(IrProtocolId protocol);
+
+private:
+    /// Appends pulses, consecutive pulses with the same level are merged and leading spaces are dropped
+    class PulseWriter
+    {
+    public:
+        explicit PulseWriter(etl::span<IrPulse> pulses) : pulses_{pulses} {}
+
+        void add(bool mark, std::uint32_t durationUs);
+        std::size_t getCount() const { return overflow_ ? 0 : count_; }
+
+    private:
+        etl::span<IrPulse> pulses_;
+        std::size_t count_{0};
+        bool overflow_{false};
+    };
+
+    static const IrProtocolDescriptor* findDescriptor(IrProtocolId protocol);
+    static bool createCode(IrProtocolId protocol, std::uint16_t address, std::uint8_t command, bool toggle, std::uint8_t bits, std::uint32_t& code);
+};
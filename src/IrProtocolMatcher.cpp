@@ -0,0 +1,108 @@
+#include "IrProtocolMatcher.h"
+
+void IrProtocolMatcher::reset()
+{
+    frameData_ = 0;
+    bitCounter_ = 0;
+    secondHalf_ = false;
+    firstHalfMark_ = false;
+    scale_ = SCALE_ONE;
+    markBiasUs_ = 0;
+}
+
+bool IrProtocolMatcher::isChecksumValid(std::uint32_t data, IrChecksumRule checksum, bool allowExtended)
+{
+    const std::uint8_t address{static_cast<std::uint8_t>(data)};
+    const std::uint8_t addressCheck{static_cast<std::uint8_t>(data >> 8)};
+    const std::uint8_t command{static_cast<std::uint8_t>(data >> 16)};
+    const std::uint8_t commandInverse{static_cast<std::uint8_t>(data >> 24)};
+    if(command + commandInverse != 0xFF)
+    {
+        return false;
+    }
+    if(checksum == IrChecksumRule::SAMSUNG)
+    {
+        return address == addressCheck;
+    }
+    return allowExtended || (address + addressCheck == 0xFF);
+}
+
+bool IrProtocolMatcher::correctBits(bool msbFirst, IrChecksumRule checksum)
+{
+    // collect the least confident bits, sorted by confidence
+    etl::array<std::uint8_t, MAX_CORRECTED_BITS> candidates;
+    std::size_t count{0};
+    for(std::uint8_t bit = 0; bit < bitCounter_; bit++)
+    {
+        if(confidence_[bit] >= LOW_CONFIDENCE)
+        {
+            continue;
+        }
+        std::size_t position{count};
+        while((position > 0) && (confidence_[candidates[position - 1]] > confidence_[bit]))
+        {
+            position--;
+        }
+        if(position >= candidates.size())
+        {
+            continue;
+        }
+        count = std::min(count + 1, candidates.size());
+        for(std::size_t i = count - 1; i > position; i--)
+        {
+            candidates[i] = candidates[i - 1];
+        }
+        candidates[position] = bit;
+    }
+
+    // fewest flips first, the least confident bits first for the same number of flips
+    for(std::uint8_t flips = 1; flips <= count; flips++)
+    {
+        for(std::uint32_t combination = 1; combination < (1ul << count); combination++)
+        {
+            std::uint32_t mask{0};
+            std::uint8_t bits{0};
+            for(std::size_t i = 0; i < count; i++)
+            {
+                if((combination & (1ul << i)) != 0)
+                {
+                    const std::uint8_t position{msbFirst ? static_cast<std::uint8_t>(bitCounter_ - 1 - candidates[i]) : candidates[i]};
+                    mask |= 1ul << position;
+                    bits++;
+                }
+            }
+
+            // a changed address must match its check byte, otherwise every address flip would be a valid extended NEC address
+            if((bits == flips) && isChecksumValid(frameData_ ^ mask, checksum, (mask & 0xFFFF) == 0))
+            {
+                frameData_ ^= mask;
+                frame_.correctedBits = bits;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool IrProtocolMatcher::classifyBit(const IrPulse& pulse, std::uint32_t zeroUs, std::uint32_t oneUs, std::uint32_t toleranceUs, bool& value, std::uint8_t& confidence)
+{
+    if((pulse.durationUs + toleranceUs < zeroUs) || (pulse.durationUs > oneUs + toleranceUs))
+    {
+        return false;
+    }
+
+    // soft decision: nearest nominal time, the confidence is the distance from the threshold relative to the nominal time
+    const std::uint32_t thresholdUs{(zeroUs + oneUs) / 2};
+    const std::uint32_t halfUs{(oneUs - zeroUs) / 2};
+    value = pulse.durationUs >= thresholdUs;
+    const std::uint32_t distanceUs{value ? pulse.durationUs - thresholdUs : thresholdUs - pulse.durationUs};
+    confidence = static_cast<std::uint8_t>(std::min<std::uint32_t>(distanceUs * UINT8_MAX / halfUs, UINT8_MAX));
+    return true;
+}
+
+void IrProtocolMatcher::setScale(std::uint32_t measuredUs, std::uint32_t nominalUs)
+{
+    constexpr std::uint32_t minScale{SCALE_ONE * (100 - MAX_DRIFT_PERCENT) / 100};
+    constexpr std::uint32_t maxScale{SCALE_ONE * (100 + MAX_DRIFT_PERCENT) / 100};
+    scale_ = std::clamp((measuredUs * SCALE_ONE + nominalUs / 2) / nominalUs, minScale, maxScale);
+}
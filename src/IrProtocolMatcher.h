@@ -0,0 +1,425 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include "etl/array.h"
+#include "EdgeSourceInterface.h"
+#include "IrProtocol.h"
+
+/// Decodes the pulses of one frame according to a protocol descriptor.
+/// The decoder runs one matcher per protocol on the same pulses, so every pulse is only seen once.
+/// The bit timing is scaled with the clock of the remote, measured on the header, and bits are classified by the
+/// nearest nominal time. Frames failing the checksum get a second chance by flipping the least confident bits.
+/// This is the protocol independent part, the matcher of a protocol is IrProtocolMatcherFor.
+class IrProtocolMatcher
+{
+public:
+    enum class Result : std::uint8_t
+    {
+        BUSY,            ///< Pulse accepted, frame not complete yet
+        IGNORED,         ///< Matcher is not active (failed or already complete)
+        INVALID_HEADER,
+        INVALID_BIT,
+        INVALID_CHECKSUM,
+        FRAME,           ///< Complete frame, see getFrame()
+        REPEAT           ///< Repeat code of the protocol
+    };
+
+    struct Frame
+    {
+        IrProtocolId protocol;
+        std::uint16_t address;
+        std::uint8_t command;
+        bool toggle;        ///< Toggle bit of the protocol (RC5 / RC6), false otherwise
+        std::uint32_t code; ///< All received bits
+        std::uint8_t correctedBits; ///< Number of low confidence bits flipped to pass the checksum
+    };
+
+    bool isActive() const { return (state_ != State::INACTIVE) && (state_ != State::DONE); }
+
+    const Frame& getFrame() const { return frame_; }
+
+protected:
+    enum class State : std::uint8_t
+    {
+        INACTIVE,
+        HEADER_MARK,
+        HEADER_SPACE,
+        BIT_MARK,
+        BIT_SPACE,
+        MANCHESTER,
+        DONE
+    };
+
+    static constexpr std::uint32_t SCALE_ONE{4096};        ///< Timing scale 1.0 (Q12)
+    static constexpr std::uint32_t MAX_DRIFT_PERCENT{15};  ///< Maximum clock deviation of a remote
+    static constexpr std::uint8_t LOW_CONFIDENCE{96};      ///< Bits below are candidates for the checksum correction
+    static constexpr std::size_t MAX_CORRECTED_BITS{3};
+
+    State state_{State::INACTIVE};
+    std::uint8_t bitCounter_{0};
+    bool secondHalf_{false};      ///< Manchester: first half of the current bit received
+    bool firstHalfMark_{false};   ///< Manchester: level of the first half of the current bit
+    std::uint32_t frameData_{0};
+    std::uint32_t scale_{SCALE_ONE};      ///< Timing of the remote relative to the nominal timing, learned from the header
+    std::int32_t markBiasUs_{0};          ///< Lengthening of the marks (and shortening of the spaces) by the receiver, learned from the header
+    std::uint32_t headerMarkUs_{0};       ///< Measured header mark
+    etl::array<std::uint8_t, 32> confidence_{}; ///< Distance of every bit from the decision threshold, 0: on the threshold, 255: nominal time
+    Frame frame_{};
+
+    void reset();
+    bool correctBits(bool msbFirst, IrChecksumRule checksum);
+    void setScale(std::uint32_t measuredUs, std::uint32_t nominalUs);
+    std::uint32_t scaled(std::uint32_t timeUs) const { return (timeUs * scale_ + SCALE_ONE / 2) / SCALE_ONE; }
+    static bool isChecksumValid(std::uint32_t data, IrChecksumRule checksum, bool allowExtended);
+    static bool classifyBit(const IrPulse& pulse, std::uint32_t zeroUs, std::uint32_t oneUs, std::uint32_t toleranceUs, bool& value, std::uint8_t& confidence);
+
+    // called for every pulse, inlined into the matchers
+
+    IrPulse removeBias(const IrPulse& pulse) const
+    {
+        const std::int32_t durationUs{static_cast<std::int32_t>(pulse.durationUs) + (pulse.mark ? -markBiasUs_ : markBiasUs_)};
+        return IrPulse{static_cast<std::uint32_t>(std::max<std::int32_t>(durationUs, 0)), pulse.mark};
+    }
+
+    Result fail(Result reason)
+    {
+        state_ = State::INACTIVE;
+        return reason;
+    }
+
+    static bool isPulseInRange(const IrPulse& pulse, std::uint32_t timeUs, std::uint32_t tolerance)
+    {
+        const std::uint32_t timeDiff{pulse.durationUs};
+        const std::uint32_t targetDiff{(timeUs > timeDiff) ? timeUs - timeDiff : timeDiff - timeUs};
+        return targetDiff <= tolerance;
+    }
+};
+
+/// Matcher of one protocol. The descriptor is a template parameter, so its timing is folded into the code and the
+/// branches of other bit encodings and frame layouts are not compiled in.
+template<const IrProtocolDescriptor& PROTOCOL>
+class IrProtocolMatcherFor final : public IrProtocolMatcher
+{
+public:
+    /// Prepare for a new frame, called with the first mark of the frame
+    void start();
+
+    Result feed(const IrPulse& pulse);
+
+    /// End of the frame (long idle time), completes frames with variable length
+    Result finish();
+
+    static constexpr const IrProtocolDescriptor& getProtocol() { return PROTOCOL; }
+
+private:
+    static constexpr std::uint8_t MAX_BITS{PROTOCOL.getMaxBits()};
+    static constexpr std::uint32_t HEADER_MARK_TOLERANCE_US{PROTOCOL.headerToleranceUs + PROTOCOL.headerMarkUs * MAX_DRIFT_PERCENT / 100};
+    static constexpr std::uint32_t HEADER_SPACE_TOLERANCE_US{PROTOCOL.headerToleranceUs + PROTOCOL.headerSpaceUs * MAX_DRIFT_PERCENT / 100};
+    static constexpr std::uint32_t REPEAT_SPACE_TOLERANCE_US{PROTOCOL.headerToleranceUs + PROTOCOL.repeatSpaceUs * MAX_DRIFT_PERCENT / 100};
+
+    Result feedManchester(const IrPulse& pulse);
+    Result addBit(bool value, std::uint8_t confidence);
+    Result complete();
+
+    static constexpr State getFirstBitState()
+    {
+        switch(PROTOCOL.encoding)
+        {
+        case IrBitEncoding::MANCHESTER:
+            return State::MANCHESTER;
+        case IrBitEncoding::PULSE_WIDTH:
+            return State::BIT_SPACE; // separator space before the first bit mark
+        default:
+            return State::BIT_MARK;
+        }
+    }
+};
+
+template<const IrProtocolDescriptor& PROTOCOL>
+void IrProtocolMatcherFor<PROTOCOL>::start()
+{
+    reset();
+
+    if constexpr(PROTOCOL.headerMarkUs != 0)
+    {
+        state_ = State::HEADER_MARK;
+    }
+    else
+    {
+        state_ = getFirstBitState();
+        if constexpr(getFirstBitState() == State::MANCHESTER) // the first half of the first bit is a space which is part of the idle time (RC5)
+        {
+            secondHalf_ = true;
+        }
+    }
+}
+
+template<const IrProtocolDescriptor& PROTOCOL>
+IrProtocolMatcher::Result IrProtocolMatcherFor<PROTOCOL>::feed(const IrPulse& received)
+{
+    // the bias is known after the header, the bits are compared without it
+    const IrPulse pulse{((state_ == State::HEADER_MARK) || (state_ == State::HEADER_SPACE)) ? received : removeBias(received)};
+    switch(state_)
+    {
+    case State::HEADER_MARK:
+        if(pulse.mark && isPulseInRange(pulse, PROTOCOL.headerMarkUs, HEADER_MARK_TOLERANCE_US))
+        {
+            headerMarkUs_ = pulse.durationUs;
+            if constexpr(PROTOCOL.headerSpaceUs == 0)
+            {
+                setScale(headerMarkUs_, PROTOCOL.headerMarkUs);
+                state_ = getFirstBitState();
+            }
+            else
+            {
+                state_ = State::HEADER_SPACE;
+            }
+            return Result::BUSY;
+        }
+        return fail(Result::INVALID_HEADER);
+
+    case State::HEADER_SPACE:
+        if(!pulse.mark && isPulseInRange(pulse, PROTOCOL.headerSpaceUs, HEADER_SPACE_TOLERANCE_US))
+        {
+            // the receiver lengthens marks at the cost of the spaces, the sum only depends on the clock of the remote
+            setScale(headerMarkUs_ + pulse.durationUs, PROTOCOL.headerMarkUs + PROTOCOL.headerSpaceUs);
+            constexpr std::int32_t tolerance{static_cast<std::int32_t>(PROTOCOL.bitToleranceUs)};
+            markBiasUs_ = std::clamp(static_cast<std::int32_t>(headerMarkUs_) - static_cast<std::int32_t>(scaled(PROTOCOL.headerMarkUs)), -tolerance, tolerance);
+            state_ = getFirstBitState();
+            return Result::BUSY;
+        }
+        if constexpr(PROTOCOL.repeatSpaceUs != 0)
+        {
+            if(!pulse.mark && isPulseInRange(pulse, PROTOCOL.repeatSpaceUs, REPEAT_SPACE_TOLERANCE_US))
+            {
+                state_ = State::DONE;
+                return Result::REPEAT;
+            }
+        }
+        return fail(Result::INVALID_HEADER);
+
+    case State::BIT_MARK:
+        if(pulse.mark)
+        {
+            if constexpr(PROTOCOL.encoding == IrBitEncoding::PULSE_WIDTH)
+            {
+                bool one;
+                std::uint8_t confidence;
+                if(classifyBit(pulse, scaled(PROTOCOL.markUs), scaled(PROTOCOL.oneUs), PROTOCOL.bitToleranceUs, one, confidence))
+                {
+                    state_ = State::BIT_SPACE;
+                    return addBit(one, confidence);
+                }
+            }
+            else if(isPulseInRange(pulse, scaled(PROTOCOL.markUs), PROTOCOL.bitToleranceUs))
+            {
+                state_ = State::BIT_SPACE;
+                return Result::BUSY;
+            }
+        }
+        return fail(Result::INVALID_BIT);
+
+    case State::BIT_SPACE:
+        if(!pulse.mark)
+        {
+            if constexpr(PROTOCOL.encoding == IrBitEncoding::PULSE_WIDTH)
+            {
+                if(isPulseInRange(pulse, scaled(PROTOCOL.spaceUs), PROTOCOL.bitToleranceUs))
+                {
+                    state_ = State::BIT_MARK;
+                    return Result::BUSY;
+                }
+                return finish(); // a longer space ends a frame with variable length
+            }
+            else
+            {
+                bool one;
+                std::uint8_t confidence;
+                if(classifyBit(pulse, scaled(PROTOCOL.spaceUs), scaled(PROTOCOL.oneUs), PROTOCOL.bitToleranceUs, one, confidence))
+                {
+                    state_ = State::BIT_MARK;
+                    return addBit(one, confidence);
+                }
+            }
+        }
+        return fail(Result::INVALID_BIT);
+
+    case State::MANCHESTER:
+        if constexpr(PROTOCOL.encoding == IrBitEncoding::MANCHESTER)
+        {
+            return feedManchester(pulse);
+        }
+        return Result::IGNORED;
+
+    default:
+        return Result::IGNORED;
+    }
+}
+
+template<const IrProtocolDescriptor& PROTOCOL>
+IrProtocolMatcher::Result IrProtocolMatcherFor<PROTOCOL>::finish()
+{
+    switch(state_)
+    {
+    case State::HEADER_MARK:
+    case State::HEADER_SPACE:
+        return fail(Result::INVALID_HEADER);
+
+    case State::MANCHESTER:
+        if(secondHalf_ && firstHalfMark_) // the second half of the last bit is a space, merged into the idle time
+        {
+            secondHalf_ = false;
+            const Result result{addBit(PROTOCOL.oneIsMarkFirst, UINT8_MAX)};
+            if(result != Result::BUSY)
+            {
+                return result;
+            }
+        }
+        [[fallthrough]];
+    case State::BIT_MARK:
+    case State::BIT_SPACE:
+        return complete();
+
+    default:
+        return Result::IGNORED;
+    }
+}
+
+template<const IrProtocolDescriptor& PROTOCOL>
+IrProtocolMatcher::Result IrProtocolMatcherFor<PROTOCOL>::feedManchester(const IrPulse& pulse)
+{
+    constexpr std::uint32_t maxUnits{(PROTOCOL.longBitIndex != IrProtocols::NO_LONG_BIT) ? 4u : 2u};
+    const std::uint32_t unitUs{scaled(PROTOCOL.markUs)};
+    if(!pulse.mark && (pulse.durationUs > (maxUnits * unitUs + PROTOCOL.bitToleranceUs))) // idle after the last bit
+    {
+        return finish();
+    }
+
+    std::uint32_t units{(pulse.durationUs + unitUs / 2) / unitUs};
+    if((units == 0) || !isPulseInRange(pulse, units * unitUs, PROTOCOL.bitToleranceUs))
+    {
+        return fail(Result::INVALID_BIT);
+    }
+
+    // a pulse covers one or more half bits with the same level
+    while(units > 0)
+    {
+        const std::uint32_t width{(bitCounter_ == PROTOCOL.longBitIndex) ? 2u : 1u};
+        if(units < width)
+        {
+            return fail(Result::INVALID_BIT);
+        }
+        units -= width;
+
+        if(!secondHalf_)
+        {
+            firstHalfMark_ = pulse.mark;
+            secondHalf_ = true;
+        }
+        else
+        {
+            if(firstHalfMark_ == pulse.mark)
+            {
+                return fail(Result::INVALID_BIT);
+            }
+            secondHalf_ = false;
+            const Result result{addBit(firstHalfMark_ == PROTOCOL.oneIsMarkFirst, UINT8_MAX)};
+            if(result != Result::BUSY) // frame complete, the rest of the pulse is idle time
+            {
+                return result;
+            }
+        }
+    }
+    return Result::BUSY;
+}
+
+template<const IrProtocolDescriptor& PROTOCOL>
+IrProtocolMatcher::Result IrProtocolMatcherFor<PROTOCOL>::addBit(bool value, std::uint8_t confidence)
+{
+    // without a checksum an ambiguous bit cannot be verified
+    if constexpr(PROTOCOL.checksum == IrChecksumRule::NONE)
+    {
+        if(confidence < LOW_CONFIDENCE / 2)
+        {
+            return fail(Result::INVALID_BIT);
+        }
+    }
+    confidence_[bitCounter_] = confidence;
+
+    if constexpr(PROTOCOL.msbFirst)
+    {
+        frameData_ = (frameData_ << 1) | (value ? 1u : 0u);
+    }
+    else if(value)
+    {
+        frameData_ |= 1ul << bitCounter_;
+    }
+    bitCounter_++;
+
+    return (bitCounter_ >= MAX_BITS) ? complete() : Result::BUSY;
+}
+
+template<const IrProtocolDescriptor& PROTOCOL>
+IrProtocolMatcher::Result IrProtocolMatcherFor<PROTOCOL>::complete()
+{
+    if(!PROTOCOL.isValidBitCount(bitCounter_))
+    {
+        return fail(Result::INVALID_BIT);
+    }
+
+    state_ = State::DONE;
+    frame_ = Frame{PROTOCOL.id, 0, 0, false, frameData_, 0};
+
+    if constexpr((PROTOCOL.id == IrProtocolId::NEC) || (PROTOCOL.id == IrProtocolId::NEC_EXTENDED) || (PROTOCOL.id == IrProtocolId::SAMSUNG))
+    {
+        if(!isChecksumValid(frameData_, PROTOCOL.checksum, true) && !correctBits(PROTOCOL.msbFirst, PROTOCOL.checksum))
+        {
+            return Result::INVALID_CHECKSUM;
+        }
+
+        frame_.code = frameData_;
+        const std::uint8_t address{static_cast<std::uint8_t>(frameData_)};
+        const std::uint8_t addressCheck{static_cast<std::uint8_t>(frameData_ >> 8)};
+        frame_.command = static_cast<std::uint8_t>(frameData_ >> 16);
+        if constexpr(PROTOCOL.checksum == IrChecksumRule::SAMSUNG)
+        {
+            frame_.address = address;
+        }
+        else if(address + addressCheck == 0xFF)
+        {
+            frame_.address = address;
+        }
+        else // extended NEC, the second byte is the high byte of a 16 bit address
+        {
+            frame_.protocol = IrProtocolId::NEC_EXTENDED;
+            frame_.address = static_cast<std::uint16_t>(frameData_);
+        }
+    }
+    else if constexpr(PROTOCOL.id == IrProtocolId::SONY) // 7 bit command, 5, 8 or 13 bit address
+    {
+        frame_.command = static_cast<std::uint8_t>(frameData_ & 0x7F);
+        frame_.address = static_cast<std::uint16_t>(frameData_ >> 7);
+    }
+    else if constexpr(PROTOCOL.id == IrProtocolId::RC5) // start bit, field bit (inverse command bit 6), toggle, 5 bit address, 6 bit command
+    {
+        if((frameData_ & (1ul << 13)) == 0)
+        {
+            return fail(Result::INVALID_BIT);
+        }
+        frame_.toggle = (frameData_ & (1ul << 11)) != 0;
+        frame_.address = static_cast<std::uint16_t>((frameData_ >> 6) & 0x1F);
+        frame_.command = static_cast<std::uint8_t>((frameData_ & 0x3F) | (((frameData_ & (1ul << 12)) == 0) ? 0x40 : 0x00));
+    }
+    else if constexpr(PROTOCOL.id == IrProtocolId::RC6) // start bit, 3 mode bits, trailer (toggle), 8 bit address, 8 bit command
+    {
+        if(((frameData_ >> 17) & 0x0F) != 0x08) // start bit set, mode 0
+        {
+            return fail(Result::INVALID_BIT);
+        }
+        frame_.toggle = (frameData_ & (1ul << 16)) != 0;
+        frame_.address = static_cast<std::uint16_t>((frameData_ >> 8) & 0xFF);
+        frame_.command = static_cast<std::uint8_t>(frameData_);
+    }
+
+    return Result::FRAME;
+}
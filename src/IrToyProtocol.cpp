@@ -0,0 +1,113 @@
+#include "IrToyProtocol.h"
+
+#include <cstring>
+
+void IrToyProtocol::receive(std::uint8_t byte)
+{
+    switch(byte)
+    {
+    case 0x00: // reset, leaves the sample mode (the driver sends five of them)
+        sampling_ = false;
+        sampleSize_ = 0;
+        resetFrame();
+        break;
+    case 'v':
+        setReply("V222");
+        break;
+    case 's':
+        sampling_ = true;
+        sampleSize_ = 0;
+        resetFrame();
+        setReply("S01");
+        break;
+    default: // transmit and other commands of the IR Toy are not supported
+        break;
+    }
+}
+
+bool IrToyProtocol::add(const IrPulse& pulse)
+{
+    if(!sampling_)
+    {
+        return true;
+    }
+
+    if(pulse.mark)
+    {
+        // the previous space is sent with the mark, if it was lost the frame ends before the mark
+        if((sampleSize_ + 2 * sizeof(std::uint16_t)) > samples_.size())
+        {
+            return false;
+        }
+        if(inFrame_)
+        {
+            push((spaceTicks_ != 0) ? spaceTicks_ : END_OF_FRAME);
+        }
+        push(toTicks(pulse.durationUs));
+        inFrame_ = true;
+        spaceTicks_ = 0;
+    }
+    else if(inFrame_) // spaces before the first mark of a frame are dropped
+    {
+        if((spaceTicks_ != 0) || (pulse.durationUs > MAX_DURATION_US)) // a lost mark or an idle signal ends the frame
+        {
+            return endFrame();
+        }
+        spaceTicks_ = toTicks(pulse.durationUs);
+    }
+    return true;
+}
+
+bool IrToyProtocol::endFrame()
+{
+    if(!sampling_ || !inFrame_)
+    {
+        return true;
+    }
+    if((sampleSize_ + sizeof(std::uint16_t)) > samples_.size())
+    {
+        return false;
+    }
+    push(END_OF_FRAME);
+    resetFrame();
+    return true;
+}
+
+etl::span<const std::uint8_t> IrToyProtocol::getPacket() const
+{
+    if(replySize_ > 0)
+    {
+        return etl::span<const std::uint8_t>{reply_.data(), replySize_};
+    }
+    return etl::span<const std::uint8_t>{samples_.data(), sampleSize_};
+}
+
+void IrToyProtocol::consumePacket()
+{
+    if(replySize_ > 0)
+    {
+        replySize_ = 0;
+    }
+    else
+    {
+        sampleSize_ = 0;
+    }
+}
+
+void IrToyProtocol::setReply(const char* reply)
+{
+    replySize_ = std::strlen(reply);
+    std::memcpy(reply_.data(), reply, replySize_);
+}
+
+void IrToyProtocol::push(std::uint16_t sample)
+{
+    samples_[sampleSize_++] = static_cast<std::uint8_t>(sample >> 8);
+    samples_[sampleSize_++] = static_cast<std::uint8_t>(sample & 0xFF);
+}
+
+void IrToyProtocol::resetFrame()
+{
+    inFrame_ = false;
+    spaceTicks_ = 0;
+}
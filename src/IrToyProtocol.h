@@ -0,0 +1,66 @@
+#pragma once
+#include <cstdint>
+#include "etl/array.h"
+#include "etl/span.h"
+#include "EdgeSourceInterface.h"
+
+/// Serial protocol of the USB Infrared Toy v2 in sample mode, as used by the Linux kernel driver ir_toy (rc-core then
+/// decodes the durations). The host resets the device with zero bytes, reads the version ('v' -> "V222": hardware 2,
+/// firmware 22) and enters the sample mode ('s' -> "S01"). Then every mark and space is sent as big endian uint16
+/// count of 21.33 µs ticks, each frame starts with a mark and ends with END_OF_FRAME in place of its trailing space.
+/// The driver takes every packet received while it waits for a reply as the reply and splits the others in samples,
+/// so getPacket() returns a reply alone and samples only in whole. Transmit commands are ignored (receive only).
+class IrToyProtocol
+{
+public:
+    static constexpr std::size_t PACKET_SIZE{64};       ///< Size of the bulk endpoints the driver expects
+    static constexpr std::uint16_t END_OF_FRAME{0xFFFF};
+    static constexpr std::uint16_t MAX_TICKS{0xFFFE};   ///< Longer marks are truncated, longer spaces end the frame
+
+    /// Process a byte received from the host
+    void receive(std::uint8_t byte);
+
+    /// Queue the sample of a pulse, false if the pulse was not taken because the samples wait for getPacket()
+    bool add(const IrPulse& pulse);
+
+    /// Queue the end of the frame (the signal is a space since the idle time), false if it was not taken
+    bool endFrame();
+
+    /// Next packet to send, a reply or the queued samples, empty if there is nothing to send
+    etl::span<const std::uint8_t> getPacket() const;
+
+    /// The packet of getPacket() was sent
+    void consumePacket();
+
+    /// True while a reply waits, the next command has to wait for it
+    bool hasReply() const { return replySize_ > 0; }
+
+    bool isSampling() const { return sampling_; }
+
+    static constexpr std::uint16_t toTicks(std::uint32_t durationUs)
+    {
+        const std::uint32_t ticks{(durationUs * 3 + 32) / 64}; // 21.33 µs = 64 / 3 µs, rounded
+        return static_cast<std::uint16_t>((ticks == 0) ? 1 : ((ticks > MAX_TICKS) ? MAX_TICKS : ticks));
+    }
+
+    static constexpr std::uint32_t toUs(std::uint16_t ticks)
+    {
+        return (static_cast<std::uint32_t>(ticks) * 64 + 1) / 3;
+    }
+
+private:
+    static constexpr std::uint32_t MAX_DURATION_US{(MAX_TICKS * 64u + 1) / 3}; // toUs(MAX_TICKS)
+    static constexpr std::size_t MAX_SAMPLES_SIZE{PACKET_SIZE - 2}; // a full packet would be followed by a zero length packet
+
+    etl::array<std::uint8_t, 4> reply_{};
+    std::size_t replySize_{0};
+    etl::array<std::uint8_t, MAX_SAMPLES_SIZE> samples_{};
+    std::size_t sampleSize_{0};
+    bool sampling_{false};
+    bool inFrame_{false};       ///< A mark was sent since the last end of frame
+    std::uint16_t spaceTicks_{0}; ///< Space after the last mark, sent with the next mark so the end of the frame can replace it
+
+    void setReply(const char* reply);
+    void push(std::uint16_t sample);
+    void resetFrame();
+};
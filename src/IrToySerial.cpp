@@ -0,0 +1,70 @@
+#include "IrToySerial.h"
+
+#include "tusb.h"
+
+void IrToySerial::add(etl::span<const IrPulse> pulses)
+{
+    if(!isEnabled())
+    {
+        return;
+    }
+
+    if(pulses.empty())
+    {
+        pulses_.push(END_OF_FRAME);
+    }
+    for(const IrPulse& pulse : pulses)
+    {
+        pulses_.push(pulse);
+    }
+}
+
+void IrToySerial::task()
+{
+    if(!isEnabled())
+    {
+        return;
+    }
+    if(!tud_mounted()) // nobody takes the samples, the host starts over with a reset when it enumerated the device
+    {
+        IrPulse pulse;
+        while(pulses_.pop(pulse)) {}
+        heldValid_ = false;
+        protocol_ = IrToyProtocol{};
+        return;
+    }
+
+    // the driver sends a command and waits for its reply, read on only once the reply is out
+    std::uint8_t command;
+    while(!protocol_.hasReply() && (tud_cdc_available() > 0) && (tud_cdc_read(&command, 1) == 1))
+    {
+        protocol_.receive(command);
+    }
+
+    while(true)
+    {
+        if(!heldValid_)
+        {
+            if(!pulses_.pop(held_))
+            {
+                break;
+            }
+            heldValid_ = true;
+        }
+
+        const bool taken{((held_.durationUs == 0) && !held_.mark) ? protocol_.endFrame() : protocol_.add(held_)};
+        if(!taken)
+        {
+            break;
+        }
+        heldValid_ = false;
+    }
+
+    const etl::span<const std::uint8_t> packet{protocol_.getPacket()};
+    if(!packet.empty() && (tud_cdc_write_available() == CFG_TUD_CDC_TX_BUFSIZE))
+    {
+        tud_cdc_write(packet.data(), static_cast<std::uint32_t>(packet.size()));
+        tud_cdc_write_flush();
+        protocol_.consumePacket();
+    }
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include "etl/span.h"
+#include "EdgeSourceInterface.h"
+#include "IrToyProtocol.h"
+#include "SpscQueue.h"
+
+/// CDC interface of the IR Toy personality (UsbPersonality::IR_TOY): takes the captured pulses in the capture context
+/// and exchanges the commands, replies and samples of the IrToyProtocol with the host in the USB context. A packet is
+/// only written to the CDC FIFO when it is empty, so every reply and every block of samples is a transfer of its own.
+class IrToySerial
+{
+public:
+    /// Capture side, queue the pulses if the personality is active, an empty span ends the frame
+    void add(etl::span<const IrPulse> pulses);
+
+    /// Process the commands of the host and send the next packet, call periodically
+    void task();
+
+    void setEnabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+    bool isEnabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    /// True while pulses or a packet wait to be sent
+    bool hasPending() const { return heldValid_ || !pulses_.empty() || !protocol_.getPacket().empty(); }
+
+private:
+    static constexpr std::size_t QUEUE_SIZE{256};
+    static constexpr IrPulse END_OF_FRAME{0, false}; ///< Queued for an empty span of the capture
+
+    std::atomic<bool> enabled_{false};
+    SpscQueue<IrPulse, QUEUE_SIZE> pulses_{};
+    IrPulse held_{};                ///< Pulse taken from the queue which did not fit in the samples
+    bool heldValid_{false};
+    IrToyProtocol protocol_{};
+};
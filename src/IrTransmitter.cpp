@@ -0,0 +1,162 @@
+#include "IrTransmitter.h"
+#include "ir_transmit.pio.h"
+
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+
+IrTransmitter* IrTransmitter::instance_{nullptr};
+
+void IrTransmitter::initialize()
+{
+    instance_ = this;
+
+    sm_ = static_cast<unsigned int>(pio_claim_unused_sm(pio_, true));
+    const uint offset{pio_add_program(pio_, &ir_transmit_program)};
+    ir_transmit_program_init(pio_, sm_, offset, pin_, static_cast<float>(carrierHz_));
+
+    dmaChannel_ = static_cast<unsigned int>(dma_claim_unused_channel(true));
+    dma_channel_config dmaConfig{dma_channel_get_default_config(dmaChannel_)};
+    channel_config_set_transfer_data_size(&dmaConfig, DMA_SIZE_32);
+    channel_config_set_read_increment(&dmaConfig, true);
+    channel_config_set_write_increment(&dmaConfig, false);
+    channel_config_set_dreq(&dmaConfig, pio_get_dreq(pio_, sm_, true));
+    dma_channel_configure(dmaChannel_, &dmaConfig, &pio_->txf[sm_], nullptr, 0, false);
+
+    // one interrupt per frame, when the last word was moved to the FIFO
+    dma_channel_set_irq1_enabled(dmaChannel_, true);
+    irq_set_exclusive_handler(DMA_IRQ_1, &IrTransmitter::dmaIrqHandler);
+    irq_set_enabled(DMA_IRQ_1, true);
+}
+
+bool IrTransmitter::send(etl::span<const IrPulse> frame, etl::span<const IrPulse> repeatFrame, std::uint8_t repeats, std::uint32_t periodUs, std::uint32_t carrierHz)
+{
+    if((frame.size() + repeatFrame.size()) > MAX_PULSES)
+    {
+        rejectedCount_++;
+        return false;
+    }
+
+    newJob_.carrierHz = carrierHz;
+    newJob_.repeats = repeats;
+    newJob_.frameWords = createWords(frame, periodUs, carrierHz, newJob_.words);
+    newJob_.repeatWords = createWords(repeatFrame, periodUs, carrierHz, etl::span<std::uint32_t>{newJob_.words}.subspan(newJob_.frameWords));
+    if((newJob_.frameWords == 0) || !jobs_.push(newJob_))
+    {
+        rejectedCount_++;
+        return false;
+    }
+
+    poll();
+    return true;
+}
+
+void IrTransmitter::poll()
+{
+    // the DMA interrupt uses the same state and runs on this core
+    const std::uint32_t interrupts{save_and_disable_interrupts()};
+    if(state_ == State::IDLE)
+    {
+        loadNext();
+    }
+    else if((state_ == State::CARRIER_CHANGE) && isPioIdle())
+    {
+        carrierHz_ = activeJob_.carrierHz;
+        pio_sm_set_clkdiv(pio_, sm_, ir_transmit_clock_divider(static_cast<float>(carrierHz_)));
+        startFrame(false);
+    }
+    restore_interrupts(interrupts);
+}
+
+std::uint16_t IrTransmitter::createWords(etl::span<const IrPulse> pulses, std::uint32_t periodUs, std::uint32_t carrierHz, etl::span<std::uint32_t> words)
+{
+    if(pulses.empty())
+    {
+        return 0;
+    }
+
+    std::size_t count{0};
+    std::uint32_t frameUs{0};
+    for(const IrPulse& pulse : pulses)
+    {
+        count = appendWord(pulse.mark, pulse.durationUs, carrierHz, words, count);
+        frameUs += pulse.durationUs;
+    }
+    // the period counts from the start of the frame, so the repeat frame (shorter than the frame) gets a longer gap
+    const std::uint32_t gapUs{(periodUs >= frameUs + MIN_GAP_US) ? periodUs - frameUs : MIN_GAP_US};
+    return static_cast<std::uint16_t>(appendWord(false, gapUs, carrierHz, words, count));
+}
+
+std::size_t IrTransmitter::appendWord(bool mark, std::uint32_t durationUs, std::uint32_t carrierHz, etl::span<std::uint32_t> words, std::size_t count)
+{
+    std::uint32_t periods{static_cast<std::uint32_t>((static_cast<std::uint64_t>(durationUs) * carrierHz + 500000) / 1000000)};
+    if((periods == 0) || ((count == 0) && !mark)) // nothing to send before the first mark
+    {
+        return count;
+    }
+
+    // consecutive pulses with the same level (e.g. the gap after a trailing space) are merged
+    if((count > 0) && (ir_transmit_word_is_mark(words[count - 1]) == mark))
+    {
+        periods += ir_transmit_word_periods(words[count - 1]);
+        count--;
+    }
+    if(count < words.size())
+    {
+        words[count++] = ir_transmit_word(mark, periods);
+    }
+    return count;
+}
+
+void IrTransmitter::loadNext()
+{
+    if(!jobs_.pop(activeJob_))
+    {
+        state_ = State::IDLE;
+        return;
+    }
+
+    repeatsLeft_ = activeJob_.repeats;
+    if(activeJob_.carrierHz != carrierHz_)
+    {
+        // the clock divider may only change after the last frame left the FIFO, poll() continues
+        pio_->fdebug = 1u << (PIO_FDEBUG_TXSTALL_LSB + sm_);
+        state_ = State::CARRIER_CHANGE;
+        return;
+    }
+    startFrame(false);
+}
+
+void IrTransmitter::startFrame(bool repeat)
+{
+    const bool separateRepeat{repeat && (activeJob_.repeatWords != 0)};
+    const std::uint32_t* const words{activeJob_.words.data() + (separateRepeat ? activeJob_.frameWords : 0)};
+    const std::uint32_t count{separateRepeat ? activeJob_.repeatWords : activeJob_.frameWords};
+
+    state_ = State::SENDING;
+    dma_channel_transfer_from_buffer_now(dmaChannel_, words, count);
+}
+
+bool IrTransmitter::isPioIdle() const
+{
+    return pio_sm_is_tx_fifo_empty(pio_, sm_) && ((pio_->fdebug & (1u << (PIO_FDEBUG_TXSTALL_LSB + sm_))) != 0);
+}
+
+void IrTransmitter::dmaIrqHandler()
+{
+    IrTransmitter* const transmitter{instance_};
+    if((transmitter == nullptr) || !dma_channel_get_irq1_status(transmitter->dmaChannel_))
+    {
+        return;
+    }
+    dma_channel_acknowledge_irq1(transmitter->dmaChannel_);
+
+    if(transmitter->repeatsLeft_ > 0)
+    {
+        transmitter->repeatsLeft_--;
+        transmitter->startFrame(true);
+        return;
+    }
+    transmitter->completedCount_++;
+    transmitter->loadNext();
+}
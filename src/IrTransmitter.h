@@ -0,0 +1,80 @@
+#pragma once
+#include <cstdint>
+#include "etl/array.h"
+#include "etl/span.h"
+#include "hardware/pio.h"
+#include "EdgeSourceInterface.h"
+#include "SpscQueue.h"
+
+/// Sends modulated IR frames without CPU timing: a PIO state machine generates the carrier and a DMA channel feeds
+/// it with the pulses of the current frame. Queued jobs follow each other directly, the DMA interrupt starts the
+/// next frame while the PIO FIFO still holds the end of the previous one, so the gaps between frames are exact.
+class IrTransmitter
+{
+public:
+    static constexpr std::size_t MAX_PULSES{256};          ///< Pulses of a job (frame and repeat frame together)
+    static constexpr std::uint32_t DEFAULT_CARRIER_HZ{38000};
+    static constexpr std::uint32_t MIN_GAP_US{10000};          ///< Space after a frame which is longer than its period
+
+    IrTransmitter(const unsigned int pin, const PIO pio = pio1) :
+    pin_{pin},
+    pio_{pio}
+    {}
+
+    /// The DMA interrupt is handled by the calling core, send() and poll() must be called from the same core
+    void initialize();
+
+    /// Queue a frame which is sent once and then the repeat frame (the frame again if empty) repeats times.
+    /// periodUs is the time from the start of a frame to the start of the next one, the space after every frame is
+    /// extended to it. Returns false if the queue is full or the job is too long.
+    bool send(etl::span<const IrPulse> frame, etl::span<const IrPulse> repeatFrame, std::uint8_t repeats, std::uint32_t periodUs, std::uint32_t carrierHz = DEFAULT_CARRIER_HZ);
+
+    /// Start queued jobs, needed while isWaiting() because a carrier change has to wait until the last frame is sent
+    void poll();
+
+    bool isWaiting() const { return state_ == State::CARRIER_CHANGE; }
+    bool isIdle() const { return (state_ == State::IDLE) && jobs_.empty(); }
+
+    std::uint32_t getCompletedCount() const { return completedCount_; }
+    std::uint32_t getRejectedCount() const { return rejectedCount_; }
+
+private:
+    enum class State
+    {
+        IDLE,          ///< Nothing to send
+        SENDING,       ///< The DMA feeds the PIO
+        CARRIER_CHANGE ///< Next job loaded, waiting until the PIO sent the previous frame
+    };
+
+    struct Job
+    {
+        std::uint32_t carrierHz;
+        std::uint16_t frameWords;  ///< Words of the frame, starting at index 0
+        std::uint16_t repeatWords; ///< Words of the repeat frame following the frame, 0 to repeat the frame
+        std::uint8_t repeats;
+        etl::array<std::uint32_t, MAX_PULSES + 2> words; ///< PIO words, + the gaps after the frames
+    };
+
+    static constexpr std::size_t QUEUE_SIZE{4};
+
+    const unsigned int pin_;
+    const PIO pio_;
+    unsigned int sm_{0};
+    unsigned int dmaChannel_{0};
+    volatile State state_{State::IDLE};
+    std::uint32_t carrierHz_{DEFAULT_CARRIER_HZ};
+    SpscQueue<Job, QUEUE_SIZE> jobs_{};
+    Job newJob_{};    ///< Job being created by send(), too large for the stack
+    Job activeJob_{}; ///< Job being sent
+    std::uint8_t repeatsLeft_{0};
+    std::uint32_t completedCount_{0};
+    std::uint32_t rejectedCount_{0};
+    static IrTransmitter* instance_;
+
+    static std::uint16_t createWords(etl::span<const IrPulse> pulses, std::uint32_t periodUs, std::uint32_t carrierHz, etl::span<std::uint32_t> words);
+    static std::size_t appendWord(bool mark, std::uint32_t durationUs, std::uint32_t carrierHz, etl::span<std::uint32_t> words, std::size_t count);
+    void loadNext();
+    void startFrame(bool repeat);
+    bool isPioIdle() const;
+    static void dmaIrqHandler();
+};
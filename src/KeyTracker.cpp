@@ -0,0 +1,112 @@
+#include "KeyTracker.h"
+
+void KeyTracker::add(const IrDecoder::Data& data)
+{
+    const bool sameKey{held_ && (data.protocol == protocol_) && (data.address == address_) && (data.command == command_)};
+    if(!sameKey || !data.repeated) // a new frame of the held key (e.g. RC5 with another toggle bit) is a new press
+    {
+        if(held_)
+        {
+            release();
+        }
+        press(data);
+        return;
+    }
+
+    frameIntervalUs_ = static_cast<std::uint32_t>(data.timestampUs - lastFrameUs_);
+    lastFrameUs_ = data.timestampUs;
+    if((settings_.intervalMs == 0) && (data.timestampUs >= pressUs_ + settings_.delayMs * 1000ull))
+    {
+        repeat(data.timestampUs);
+    }
+}
+
+void KeyTracker::task(std::uint64_t nowUs)
+{
+    if(!held_)
+    {
+        return;
+    }
+
+    // timed repeats only up to the time the next repeat code of the remote is due, the key may be released after it
+    const std::uint64_t dueUs{lastFrameUs_ + getIntervalUs()};
+    while((settings_.intervalMs != 0) && (nowUs >= nextRepeatUs_) && (nextRepeatUs_ <= dueUs))
+    {
+        repeat(nextRepeatUs_);
+        nextRepeatUs_ += repeatIntervalUs_;
+
+        // accelerate down to the minimum interval (at least 1 ms)
+        const std::uint32_t minIntervalUs{(settings_.minIntervalMs > 1) ? settings_.minIntervalMs * 1000u : 1000u};
+        const std::uint32_t accelerationUs{settings_.accelerationMs * 1000u};
+        if(repeatIntervalUs_ > minIntervalUs)
+        {
+            repeatIntervalUs_ = (repeatIntervalUs_ - minIntervalUs > accelerationUs) ? repeatIntervalUs_ - accelerationUs : minIntervalUs;
+        }
+    }
+
+    if(nowUs >= lastFrameUs_ + getIntervalUs() * 3 / 2)
+    {
+        release();
+    }
+}
+
+std::uint64_t KeyTracker::getWakeTimeUs() const
+{
+    if(!held_)
+    {
+        return UINT64_MAX;
+    }
+
+    // same conditions as task()
+    const std::uint64_t releaseUs{lastFrameUs_ + getIntervalUs() * 3 / 2};
+    if((settings_.intervalMs != 0) && (nextRepeatUs_ <= lastFrameUs_ + getIntervalUs()))
+    {
+        return nextRepeatUs_;
+    }
+    return releaseUs;
+}
+
+std::uint32_t KeyTracker::getIntervalUs() const
+{
+    // the first repeat code follows the frame earlier than the next ones (NEC), a slower remote extends the interval
+    const std::uint32_t nominalUs{getNominalIntervalUs(protocol_)};
+    return (frameIntervalUs_ > nominalUs) ? frameIntervalUs_ : nominalUs;
+}
+
+void KeyTracker::press(const IrDecoder::Data& data)
+{
+    held_ = true;
+    protocol_ = data.protocol;
+    address_ = data.address;
+    command_ = data.command;
+    repeatCount_ = 0;
+    pressUs_ = data.timestampUs;
+    lastFrameUs_ = data.timestampUs;
+    frameIntervalUs_ = 0;
+    repeatIntervalUs_ = settings_.intervalMs * 1000u;
+    nextRepeatUs_ = data.timestampUs + settings_.delayMs * 1000ull;
+    send(UsbKeyEventType::PRESS, data.timestampUs);
+}
+
+void KeyTracker::release()
+{
+    held_ = false;
+    send(UsbKeyEventType::RELEASE, lastFrameUs_ + getIntervalUs());
+}
+
+void KeyTracker::repeat(std::uint64_t timestampUs)
+{
+    if(repeatCount_ < UINT8_MAX)
+    {
+        repeatCount_++;
+    }
+    send(UsbKeyEventType::REPEAT, timestampUs);
+}
+
+void KeyTracker::send(UsbKeyEventType type, std::uint64_t timestampUs)
+{
+    if(eventHandler_.is_valid())
+    {
+        eventHandler_(Event{type, protocol_, address_, command_, repeatCount_, timestampUs});
+    }
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include <cstdint>
+#include "etl/delegate.h"
+#include "IrDecoder.h"
+#include "IrProtocol.h"
+#include "UsbReport.h"
+
+/// Press, hold and release of the codes, so the host gets events on state changes instead of one per repeat code and
+/// needs no timeouts of its own. A key is released when no repeat arrives within 1.5 repeat intervals of the remote
+/// (measured between the frames of the held key, at least the nominal interval of the protocol), the release is stamped
+/// with the time the missing repeat code was due.
+/// While a key is held, REPEAT events are throttled like the auto repeat of a keyboard: the first one after the delay,
+/// then one per interval which shrinks by the acceleration with every repeat down to the minimum interval.
+/// An interval of 0 reports every repeat code received after the delay instead.
+class KeyTracker
+{
+public:
+    struct Event
+    {
+        UsbKeyEventType type;
+        IrProtocolId protocol;
+        std::uint16_t address;
+        std::uint8_t command;
+        std::uint8_t repeatCount;  ///< REPEAT events of this press so far
+        std::uint64_t timestampUs; ///< Last edge of the frame, timed repeat: time of the repeat, release: time the next repeat code was due
+    };
+
+    struct RepeatSettings
+    {
+        std::uint16_t delayMs;
+        std::uint16_t intervalMs;
+        std::uint16_t minIntervalMs;
+        std::uint16_t accelerationMs;
+    };
+
+    using EventHandler = etl::delegate<void(const Event& event)>;
+
+    static constexpr RepeatSettings DEFAULT_REPEAT{500, 0, 0, 0};
+
+    void setEventHandler(EventHandler handler) { eventHandler_ = handler; }
+
+    void setRepeatSettings(const RepeatSettings& settings) { settings_ = settings; }
+
+    /// Track a decoded event
+    void add(const IrDecoder::Data& data);
+
+    /// Release a key without repeat and send the timed repeats, call periodically
+    void task(std::uint64_t nowUs);
+
+    /// True while a key is held, task() has to be called until it is released
+    bool isHeld() const { return held_; }
+
+    /// Time task() has to run for the next timed repeat or the release, UINT64_MAX if no key is held
+    std::uint64_t getWakeTimeUs() const;
+
+    /// Time of the last frame of the held (or last released) key
+    std::uint64_t getLastFrameUs() const { return lastFrameUs_; }
+
+private:
+    RepeatSettings settings_{DEFAULT_REPEAT};
+    EventHandler eventHandler_{};
+    bool held_{false};
+    IrProtocolId protocol_{};
+    std::uint16_t address_{0};
+    std::uint8_t command_{0};
+    std::uint8_t repeatCount_{0};
+    std::uint64_t pressUs_{0};
+    std::uint64_t lastFrameUs_{0};
+    std::uint32_t frameIntervalUs_{0}; ///< Time between the last two frames of the held key, 0 before the first repeat
+    std::uint64_t nextRepeatUs_{0};    ///< Time of the next timed repeat
+    std::uint32_t repeatIntervalUs_{0};
+
+    std::uint32_t getIntervalUs() const;
+    void press(const IrDecoder::Data& data);
+    void release();
+    void repeat(std::uint64_t timestampUs);
+    void send(UsbKeyEventType type, std::uint64_t timestampUs);
+
+    /// Time between the frames of a held key
+    static constexpr std::uint32_t getNominalIntervalUs(IrProtocolId protocol)
+    {
+        switch(protocol)
+        {
+        case IrProtocolId::SONY: return 45000;
+        case IrProtocolId::RC5:  return 114000;
+        default:                 return 108000; // NEC, Samsung, RC6
+        }
+    }
+};
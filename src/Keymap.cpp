@@ -0,0 +1,19 @@
+#include "Keymap.h"
+#include <algorithm>
+
+void Keymap::load(etl::span<const KeymapEntry> entries)
+{
+    entries_ = entries.first(std::min(entries.size(), MAX_ENTRIES));
+    index_.clear();
+    for(std::size_t i = 0; i < entries_.size(); i++)
+    {
+        // the first entry of a code wins
+        index_.insert(entries_[i].getKey(), i, [this](std::size_t entry) { return entries_[entry].getKey(); });
+    }
+}
+
+const KeymapEntry* Keymap::find(IrProtocolId protocol, std::uint16_t address, std::uint8_t command) const
+{
+    const std::size_t entry{index_.find(makeCodeKey(protocol, address, command), [this](std::size_t entry) { return entries_[entry].getKey(); })};
+    return (entry == Index::NOT_FOUND) ? nullptr : &entries_[entry];
+}
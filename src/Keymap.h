@@ -0,0 +1,91 @@
+#pragma once
+#include <cstdint>
+#include "etl/array.h"
+#include "etl/span.h"
+#include "tusb.h"
+#include "HashIndex.h"
+#include "IrProtocol.h"
+
+enum class HidUsagePage : std::uint8_t
+{
+    KEYBOARD = 0x07, ///< Keyboard keys (HID_KEY_*)
+    CONSUMER = 0x0C  ///< Media and volume keys (HID_USAGE_CONSUMER_*)
+};
+
+/// Translation of one IR code to a HID usage
+struct KeymapEntry
+{
+    IrProtocolId protocol;
+    std::uint8_t command;
+    std::uint16_t address;
+    std::uint16_t usage;
+    HidUsagePage page;
+
+    /// Lookup key of the code
+    constexpr std::uint32_t getKey() const
+    {
+        return makeCodeKey(protocol, address, command);
+    }
+};
+
+static_assert(sizeof(KeymapEntry) == 8, "the entries are stored as they are in the configuration");
+
+/// Lookup of the HID usage of a decoded code with a hash index (open addressing) over the table
+class Keymap
+{
+public:
+    static constexpr std::size_t MAX_ENTRIES{64};
+
+    explicit Keymap(etl::span<const KeymapEntry> entries)
+    {
+        load(entries);
+    }
+
+    /// Use another table (e.g. memory mapped from the configuration store), entries beyond MAX_ENTRIES are ignored.
+    /// The table must stay valid until the next load().
+    void load(etl::span<const KeymapEntry> entries);
+
+    /// Entry of the code, nullptr if the code is not mapped
+    const KeymapEntry* find(IrProtocolId protocol, std::uint16_t address, std::uint8_t command) const;
+
+private:
+    using Index = HashIndex<std::uint32_t, MAX_ENTRIES>;
+
+    etl::span<const KeymapEntry> entries_{};
+    Index index_{}; ///< Over the codes of the entries
+};
+
+namespace Keymaps
+{
+    /// Common 21 key NEC remote (address 0x00) and RC5 TV remote (address 0x00)
+    static constexpr etl::array<KeymapEntry, 27> DEFAULT
+    {
+        KeymapEntry{IrProtocolId::NEC, 0x07, 0x00, HID_USAGE_CONSUMER_VOLUME_DECREMENT, HidUsagePage::CONSUMER}, // VOL-
+        KeymapEntry{IrProtocolId::NEC, 0x08, 0x00, HID_KEY_4,                           HidUsagePage::KEYBOARD},
+        KeymapEntry{IrProtocolId::NEC, 0x09, 0x00, HID_USAGE_CONSUMER_MUTE,             HidUsagePage::CONSUMER}, // EQ
+        KeymapEntry{IrProtocolId::NEC, 0x0C, 0x00, HID_KEY_1,                           HidUsagePage::KEYBOARD},
+        KeymapEntry{IrProtocolId::NEC, 0x0D, 0x00, HID_KEY_ENTER,                       HidUsagePage::KEYBOARD}, // 200+
+        KeymapEntry{IrProtocolId::NEC, 0x15, 0x00, HID_USAGE_CONSUMER_VOLUME_INCREMENT, HidUsagePage::CONSUMER}, // VOL+
+        KeymapEntry{IrProtocolId::NEC, 0x16, 0x00, HID_KEY_0,                           HidUsagePage::KEYBOARD},
+        KeymapEntry{IrProtocolId::NEC, 0x18, 0x00, HID_KEY_2,                           HidUsagePage::KEYBOARD},
+        KeymapEntry{IrProtocolId::NEC, 0x19, 0x00, HID_KEY_ESCAPE,                      HidUsagePage::KEYBOARD}, // 100+
+        KeymapEntry{IrProtocolId::NEC, 0x1C, 0x00, HID_KEY_5,                           HidUsagePage::KEYBOARD},
+        KeymapEntry{IrProtocolId::NEC, 0x40, 0x00, HID_USAGE_CONSUMER_SCAN_NEXT,        HidUsagePage::CONSUMER}, // >>|
+        KeymapEntry{IrProtocolId::NEC, 0x42, 0x00, HID_KEY_7,                           HidUsagePage::KEYBOARD},
+        KeymapEntry{IrProtocolId::NEC, 0x43, 0x00, HID_USAGE_CONSUMER_PLAY_PAUSE,       HidUsagePage::CONSUMER}, // >||
+        KeymapEntry{IrProtocolId::NEC, 0x44, 0x00, HID_USAGE_CONSUMER_SCAN_PREVIOUS,    HidUsagePage::CONSUMER}, // |<<
+        KeymapEntry{IrProtocolId::NEC, 0x45, 0x00, HID_KEY_PAGE_DOWN,                   HidUsagePage::KEYBOARD}, // CH-
+        KeymapEntry{IrProtocolId::NEC, 0x46, 0x00, HID_KEY_HOME,                        HidUsagePage::KEYBOARD}, // CH
+        KeymapEntry{IrProtocolId::NEC, 0x47, 0x00, HID_KEY_PAGE_UP,                     HidUsagePage::KEYBOARD}, // CH+
+        KeymapEntry{IrProtocolId::NEC, 0x4A, 0x00, HID_KEY_9,                           HidUsagePage::KEYBOARD},
+        KeymapEntry{IrProtocolId::NEC, 0x52, 0x00, HID_KEY_8,                           HidUsagePage::KEYBOARD},
+        KeymapEntry{IrProtocolId::NEC, 0x5A, 0x00, HID_KEY_6,                           HidUsagePage::KEYBOARD},
+        KeymapEntry{IrProtocolId::NEC, 0x5E, 0x00, HID_KEY_3,                           HidUsagePage::KEYBOARD},
+        KeymapEntry{IrProtocolId::RC5, 0x0C, 0x00, HID_USAGE_CONSUMER_POWER,            HidUsagePage::CONSUMER}, // standby
+        KeymapEntry{IrProtocolId::RC5, 0x0D, 0x00, HID_USAGE_CONSUMER_MUTE,             HidUsagePage::CONSUMER},
+        KeymapEntry{IrProtocolId::RC5, 0x10, 0x00, HID_USAGE_CONSUMER_VOLUME_INCREMENT, HidUsagePage::CONSUMER},
+        KeymapEntry{IrProtocolId::RC5, 0x11, 0x00, HID_USAGE_CONSUMER_VOLUME_DECREMENT, HidUsagePage::CONSUMER},
+        KeymapEntry{IrProtocolId::RC5, 0x20, 0x00, HID_KEY_PAGE_UP,                     HidUsagePage::KEYBOARD}, // program +
+        KeymapEntry{IrProtocolId::RC5, 0x21, 0x00, HID_KEY_PAGE_DOWN,                   HidUsagePage::KEYBOARD}, // program -
+    };
+}
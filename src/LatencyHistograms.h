@@ -0,0 +1,20 @@
+#pragma once
+#include <cstdint>
+#include "Histogram.h"
+
+/// Timing of the path from the IR receiver to USB, retrievable with VendorRequest::GET_HISTOGRAMS
+struct LatencyHistograms
+{
+    static constexpr std::size_t BUCKETS{24};
+
+    Histogram<BUCKETS> isrCycles;      ///< CPU cycles (SysTick) spent per call of the pulse handler in the capture interrupt
+    Histogram<BUCKETS> edgeToReadyUs;  ///< Last edge of a frame until the decoder queued the event
+    Histogram<BUCKETS> readyToUsbUs;   ///< Event queued by the decoder until it was written to the USB endpoint
+
+    void reset()
+    {
+        isrCycles.reset();
+        edgeToReadyUs.reset();
+        readyToUsbUs.reset();
+    }
+};
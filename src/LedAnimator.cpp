@@ -0,0 +1,122 @@
+#include "LedAnimator.h"
+#include "hardware/timer.h"
+#include "pico/stdlib.h"
+
+LedAnimator* LedAnimator::instance_{nullptr};
+
+void LedAnimator::initialize()
+{
+    instance_ = this;
+    alarm_ = static_cast<unsigned int>(hardware_alarm_claim_unused(true));
+    hardware_alarm_set_callback(alarm_, &LedAnimator::alarmCallbackTrampoline);
+    led_.off();
+}
+
+void LedAnimator::setReceiveColor(std::uint8_t red, std::uint8_t green, std::uint8_t blue)
+{
+    receiveColor_.store((static_cast<std::uint32_t>(red) << 16) | (static_cast<std::uint32_t>(green) << 8) | blue, std::memory_order_relaxed);
+}
+
+void LedAnimator::post(IrDecoder::TraceEvent event, std::uint8_t value)
+{
+    Animation animation{Animation::NONE};
+    switch(event)
+    {
+    case IrDecoder::TraceEvent::STATE:
+        animation = (value == 1) ? Animation::RECEIVE : Animation::NONE; // 1: frame started
+        break;
+    case IrDecoder::TraceEvent::FRAME:
+        animation = Animation::FRAME;
+        break;
+    case IrDecoder::TraceEvent::REPEAT:
+        animation = Animation::REPEAT;
+        break;
+    case IrDecoder::TraceEvent::REJECT:
+        animation = Animation::REJECT;
+        break;
+    }
+
+    // the receive animation does not interrupt the result of the previous frame
+    if((animation == Animation::NONE) || ((animation == Animation::RECEIVE) && ((step_ != nullptr) || (pending_.load() != 0))))
+    {
+        return;
+    }
+    pending_.store(static_cast<std::uint16_t>((value << 8) | static_cast<std::uint8_t>(animation)));
+    hardware_alarm_force_irq(alarm_); // run the first step right after the decoder
+}
+
+void LedAnimator::alarmCallbackTrampoline(unsigned int)
+{
+    if(instance_ != nullptr)
+    {
+        instance_->alarmCallbackFunction();
+    }
+}
+
+void LedAnimator::alarmCallbackFunction()
+{
+    const std::uint16_t request{pending_.exchange(0)};
+    if(request != 0) // a new animation replaces the running one
+    {
+        step_ = getSteps(static_cast<Animation>(request & 0xFF));
+        protocol_ = static_cast<std::uint8_t>(request >> 8);
+    }
+    else if(step_ != nullptr)
+    {
+        step_++;
+    }
+
+    if(step_ == nullptr)
+    {
+        return;
+    }
+    show(*step_);
+    if(step_->durationMs == 0)
+    {
+        step_ = nullptr;
+        return;
+    }
+    hardware_alarm_set_target(alarm_, make_timeout_time_ms(step_->durationMs));
+}
+
+const LedAnimator::Step* LedAnimator::getSteps(Animation animation)
+{
+    switch(animation)
+    {
+    case Animation::RECEIVE:
+        return RECEIVE_STEPS;
+    case Animation::FRAME:
+        return FRAME_STEPS;
+    case Animation::REPEAT:
+        return REPEAT_STEPS;
+    case Animation::REJECT:
+        return REJECT_STEPS;
+    default:
+        return nullptr;
+    }
+}
+
+void LedAnimator::show(const Step& step)
+{
+    Color color{0, 0, 0};
+    switch(step.color)
+    {
+    case StepColor::RECEIVE:
+    {
+        const std::uint32_t receiveColor{receiveColor_.load(std::memory_order_relaxed)};
+        color = Color{static_cast<std::uint8_t>(receiveColor >> 16), static_cast<std::uint8_t>(receiveColor >> 8), static_cast<std::uint8_t>(receiveColor)};
+        break;
+    }
+    case StepColor::PROTOCOL:
+        color = (protocol_ < PROTOCOL_COLORS.size()) ? PROTOCOL_COLORS[protocol_] : ERROR_COLOR;
+        break;
+    case StepColor::ERROR:
+        color = ERROR_COLOR;
+        break;
+    default:
+        led_.off();
+        return;
+    }
+    led_.setColor(color.red, color.green, color.blue);
+    led_.on();
+}
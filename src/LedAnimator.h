@@ -0,0 +1,90 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include "etl/array.h"
+#include "IrDecoder.h"
+#include "IrProtocol.h"
+#include "LedInterface.h"
+
+/// Shows the decoder status on the LED with short animations: the receive color while a frame arrives, the color of the
+/// protocol after a frame, a blink for every repeat and a red flash for a rejected frame.
+/// The decoder only posts its status (no LED access in the capture interrupt), the steps run in the interrupt of a
+/// hardware alarm which is only armed while an animation runs.
+class LedAnimator
+{
+public:
+    explicit LedAnimator(LedInterface& led) :
+    led_{led}
+    {}
+
+    /// Claim the alarm, call on the core running the decoder (the alarm interrupt is handled by this core)
+    void initialize();
+
+    /// Color shown while a frame is received
+    void setReceiveColor(std::uint8_t red, std::uint8_t green, std::uint8_t blue);
+
+    /// Status notifier of the decoders (IrDecoder::StatusNotifier), never blocks
+    void post(IrDecoder::TraceEvent event, std::uint8_t value);
+
+private:
+    enum class Animation : std::uint8_t
+    {
+        NONE,
+        RECEIVE,
+        FRAME,
+        REPEAT,
+        REJECT
+    };
+
+    enum class StepColor : std::uint8_t
+    {
+        OFF,
+        RECEIVE,
+        PROTOCOL,
+        ERROR
+    };
+
+    struct Step
+    {
+        StepColor color;
+        std::uint16_t durationMs; ///< 0 ends the animation
+    };
+
+    struct Color
+    {
+        std::uint8_t red;
+        std::uint8_t green;
+        std::uint8_t blue;
+    };
+
+    static constexpr Step RECEIVE_STEPS[]{{StepColor::RECEIVE, 150}, {StepColor::OFF, 0}}; // the result of the frame replaces it
+    static constexpr Step FRAME_STEPS[]{{StepColor::PROTOCOL, 100}, {StepColor::OFF, 0}};
+    static constexpr Step REPEAT_STEPS[]{{StepColor::OFF, 20}, {StepColor::PROTOCOL, 60}, {StepColor::OFF, 0}};
+    static constexpr Step REJECT_STEPS[]{{StepColor::ERROR, 50}, {StepColor::OFF, 50}, {StepColor::ERROR, 50}, {StepColor::OFF, 0}};
+
+    /// Indexed by IrProtocolId
+    static constexpr etl::array<Color, 6> PROTOCOL_COLORS
+    {
+        Color{0, 127, 0},   // NEC
+        Color{0, 127, 64},  // NEC extended
+        Color{0, 0, 127},   // Samsung
+        Color{127, 64, 0},  // Sony
+        Color{0, 96, 127},  // RC5
+        Color{96, 0, 127},  // RC6
+    };
+    static constexpr Color ERROR_COLOR{127, 0, 0};
+
+    LedInterface& led_;
+    unsigned int alarm_{0};
+    std::atomic<std::uint32_t> receiveColor_{0x007F00};
+    std::atomic<std::uint16_t> pending_{0}; ///< Requested animation (low byte) and protocol (high byte), 0 if none
+    const Step* step_{nullptr};             ///< Current step, nullptr if no animation runs
+    std::uint8_t protocol_{0};
+
+    static LedAnimator* instance_;
+
+    void alarmCallbackFunction();
+    static void alarmCallbackTrampoline(unsigned int alarm);
+    static const Step* getSteps(Animation animation);
+    void show(const Step& step);
+};
@@ -3,7 +3,7 @@
 #include "LedInterface.h"
 #include "pico/stdlib.h"
 
-class LedGpio : public LedInterface
+class LedGpio final : public LedInterface
 {
 public:
     LedGpio(const unsigned int pin, const bool lowActive = false):
@@ -1,4 +1,5 @@
 #pragma once
+#include <cstdint>
 
 class LedInterface
 {
@@ -6,4 +7,7 @@ public:
     virtual void initialize() = 0;
     virtual void on() = 0;
     virtual void off() = 0;
+
+    /// Color of on(), ignored by single color LEDs
+    virtual void setColor(std::uint8_t, std::uint8_t, std::uint8_t) {}
 };
\ No newline at end of file
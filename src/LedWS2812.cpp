@@ -1,33 +1,58 @@
 #include "LedWS2812.h"
 #include "ws2812.pio.h"
 
+#include "hardware/dma.h"
 #include "hardware/pio.h"
 
 LedWS2812::LedWS2812(const unsigned int pin) :
-    pin_{pin}
+    pin_{pin},
+    color_{pack(0, 127, 0)}
 {
 }
 
 void LedWS2812::initialize()
 {
     const PIO pio{pio0};
-    const int sm{0};
+    sm_ = static_cast<unsigned int>(pio_claim_unused_sm(pio, true));
     const uint offset{pio_add_program(pio, &ws2812_program)};
-    ws2812_program_init(pio, sm, offset, pin_, 800000, false);
+    ws2812_program_init(pio, sm_, offset, pin_, 800000, false);
+
+    // one word per transfer, paced by the FIFO
+    dmaChannel_ = static_cast<unsigned int>(dma_claim_unused_channel(true));
+    dma_channel_config dmaConfig{dma_channel_get_default_config(dmaChannel_)};
+    channel_config_set_transfer_data_size(&dmaConfig, DMA_SIZE_32);
+    channel_config_set_read_increment(&dmaConfig, false);
+    channel_config_set_write_increment(&dmaConfig, false);
+    channel_config_set_dreq(&dmaConfig, pio_get_dreq(pio, sm_, true));
+    dma_channel_configure(dmaChannel_, &dmaConfig, &pio->txf[sm_], &pixel_, 1, false);
 }
 
 void LedWS2812::on()
 {
-    set(0, 127, 0);
+    show(color_.load(std::memory_order_relaxed));
 }
 
 void LedWS2812::off()
 {
-    set(0, 0, 0);
+    show(pack(0, 0, 0));
+}
+
+void LedWS2812::setColor(std::uint8_t r, std::uint8_t g, std::uint8_t b)
+{
+    color_.store(pack(r, g, b), std::memory_order_relaxed);
 }
 
-void LedWS2812::set(std::uint8_t r, std::uint8_t g, std::uint8_t b)
+void LedWS2812::show(std::uint32_t pixel)
 {
-    const std::uint32_t color{(static_cast<std::uint32_t>(r) << 24) | (static_cast<std::uint32_t>(g) << 16) | (static_cast<std::uint32_t>(b) << 8)};
-    pio_sm_put_blocking(pio0, 0, color);
-}
\ No newline at end of file
+    // a transfer still waiting for the FIFO sends the new value, otherwise a new one is started
+    pixel_ = pixel;
+    if(!dma_channel_is_busy(dmaChannel_))
+    {
+        dma_channel_transfer_from_buffer_now(dmaChannel_, const_cast<std::uint32_t*>(&pixel_), 1);
+    }
+}
+
+std::uint32_t LedWS2812::pack(std::uint8_t r, std::uint8_t g, std::uint8_t b)
+{
+    return (static_cast<std::uint32_t>(r) << 24) | (static_cast<std::uint32_t>(g) << 16) | (static_cast<std::uint32_t>(b) << 8);
+}
@@ -1,7 +1,10 @@
 #pragma once
+#include <atomic>
 #include <cstdint>
 #include "LedInterface.h"
 
+/// WS2812B LED fed by a PIO state machine. The color word is written to the FIFO by a DMA channel, so on() and off()
+/// never wait for the PIO and can be called from any interrupt.
 class LedWS2812 final : public LedInterface
 {
 public:
@@ -9,7 +12,13 @@ public:
     virtual void initialize() override;
     virtual void on() override;
     virtual void off() override;
+    virtual void setColor(std::uint8_t r, std::uint8_t g, std::uint8_t b) override;
 private:
     const unsigned int pin_;
-    void set(std::uint8_t r, std::uint8_t g, std::uint8_t b);
-};
\ No newline at end of file
+    unsigned int sm_{0};
+    unsigned int dmaChannel_{0};
+    std::atomic<std::uint32_t> color_;
+    volatile std::uint32_t pixel_{0}; // source of the DMA
+    void show(std::uint32_t pixel);
+    static std::uint32_t pack(std::uint8_t r, std::uint8_t g, std::uint8_t b);
+};
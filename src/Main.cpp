@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <iterator>
 #include <stdio.h>
 
 #include "pico/stdlib.h"
@@ -8,17 +10,278 @@
 #include "tusb.h"
 #include "tusb_config.h"
 
+#include "hardware/structs/systick.h"
+#include "hardware/sync.h"
+#include "hardware/timer.h"
+
+#include "Board.h"
+#include "ConfigStore.h"
+#include "Diagnostics.h"
+#include "EventReporter.h"
+#include "FlashRp2040.h"
+#include "GestureMatcher.h"
+#include "HidKeyboard.h"
 #include "IrDecoder.h"
-#include "LedGpio.h"
-#include "LedWS2812.h"
+#include "IrEventCombiner.h"
+#include "IrToySerial.h"
+#include "IrTransmitter.h"
+#include "Keymap.h"
+#include "KeyTracker.h"
+#include "LatencyHistograms.h"
+#include "LedAnimator.h"
+#include "RawReporter.h"
+#include "Settings.h"
+#include "TransmitController.h"
+#include "UsbClock.h"
+#include "UsbDescriptors.h"
+#include "VendorControl.h"
+
+namespace
+{
+    // the hardware of the board (see Board.h)
+    Board::Led led{Board::LED_PIN};
+
+    /// Capture and decoder of one IR receiver
+    struct Receiver
+    {
+        Board::EdgeSource edgeSource;
+        Board::Decoder decoder{edgeSource};
+
+        // pulse handler of the edge source, runs in the capture interrupt
+        void handlePulses(etl::span<const IrPulse> pulses, std::uint64_t endTimeUs);
+    };
+
+    // static storage, the capture ring buffer is too large for the stack.
+    // Add more receivers (e.g. facing other directions) here, a frame seen by several of them is reported once.
+    Receiver receivers[]{
+        {Board::EdgeSource{Board::RECEIVER_PIN, Board::RECEIVER_IDLE_HIGH}},
+    };
+    static_assert(std::size(receivers) <= Diagnostics::MAX_RECEIVERS, "too many receivers");
+
+    constexpr std::uint32_t SYSTICK_MASK{0x00FFFFFF}; // 24 bit down counter
+    constexpr std::size_t CONFIG_SECTORS{4};           // at the end of the flash, every sector is erased once per 4 compactions
+    constexpr std::uint64_t REENUMERATE_DELAY_US{50000}; // the status stage of the request changing the personality completes first
+    constexpr std::uint32_t DISCONNECT_TIME_MS{20};      // long enough for the host (and hubs) to see the disconnect
+    constexpr std::uint64_t CARRIER_POLL_US{1000};       // the end of the frame before a carrier change raises no interrupt
+
+    LedAnimator animator{led};
+    LatencyHistograms histograms;
+    IrEventCombiner combiner;
+    EventReporter reporter{&histograms};
+    RawReporter rawReporter;
+    IrToySerial irToy;
+    Keymap keymap{Keymaps::DEFAULT};
+    HidKeyboard keyboard{keymap};
+    KeyTracker keyTracker;
+    GestureMatcher gestureMatcher{keyTracker};
+    IrTransmitter transmitter{Board::TRANSMITTER_PIN};
+    TransmitController transmitController{transmitter};
+    Diagnostics diagnostics{reporter, histograms};
+    FlashRp2040 flash{CONFIG_SECTORS};
+    ConfigStore configStore{flash};
+    Settings settings{configStore};
+    UsbClock usbClock;
+    bool reportEvents{true};
+    bool reportKeys{false};
+    bool reportGestures{false};
+    std::uint64_t reenumerateUs{0}; ///< Time to re-enumerate with the changed personality, 0 if none is pending
+    unsigned int wakeAlarm{0};      ///< Wakes core1 at the next deadline of its tasks
+
+    void wakeCore1()
+    {
+        __sev();
+    }
 
-#define RP2040ONE
+    void Receiver::handlePulses(etl::span<const IrPulse> pulses, std::uint64_t endTimeUs)
+    {
+        const std::uint32_t startTicks{systick_hw->cvr};
+
+        if (rawReporter.isEnabled() && (this == &receivers[0])) // the raw durations of several receivers cannot be mixed
+        {
+            rawReporter.add(pulses);
+            wakeCore1();
+        }
+        if (irToy.isEnabled() && (this == &receivers[0]))
+        {
+            irToy.add(pulses);
+            wakeCore1();
+        }
+        decoder.decode(pulses, endTimeUs);
+
+        histograms.isrCycles.add((startTicks - systick_hw->cvr) & SYSTICK_MASK);
+    }
+
+    bool hasEvents()
+    {
+        for (const Receiver& receiver : receivers)
+        {
+            if (receiver.decoder.hasEvents())
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void handleWakeAlarm(unsigned int)
+    {
+        __sev();
+    }
+
+    /// Time the loop of core1 has to run again, nowUs if there is work already, UINT64_MAX if only an event
+    /// (decoder, capture or USB) creates new work
+    std::uint64_t getWakeTimeUs(std::uint64_t nowUs)
+    {
+        if (tud_task_event_ready() || hasEvents())
+        {
+            return nowUs;
+        }
+
+        std::uint64_t wakeUs{std::min({rawReporter.getFlushTimeUs(), keyTracker.getWakeTimeUs(), gestureMatcher.getWakeTimeUs()})};
+        if (transmitter.isWaiting())
+        {
+            wakeUs = std::min(wakeUs, nowUs + CARRIER_POLL_US);
+        }
+        if (reenumerateUs != 0)
+        {
+            wakeUs = std::min(wakeUs, reenumerateUs);
+        }
+        return wakeUs;
+    }
+
+    void setPersonality(UsbPersonality personality)
+    {
+        UsbDescriptors::setPersonality(personality);
+        irToy.setEnabled(personality == UsbPersonality::IR_TOY);
+    }
+
+    void applySettings(ConfigKey key)
+    {
+        if ((key == ConfigKey::USB_PERSONALITY) && (settings.getUsbPersonality() != UsbDescriptors::getPersonality()))
+        {
+            reenumerateUs = time_us_64() + REENUMERATE_DELAY_US;
+        }
+
+        keymap.load(settings.getKeymap());
+        keyTracker.setRepeatSettings(settings.getKeyRepeat());
+        gestureMatcher.load(settings.getGestures());
+        const Settings::LedColor color{settings.getLedColor()};
+        animator.setReceiveColor(color.red, color.green, color.blue);
+        for (Receiver& receiver : receivers)
+        {
+            receiver.decoder.setEnabledProtocols(settings.getEnabledProtocols());
+        }
+    }
+
+    void handleKey(const KeyTracker::Event& event)
+    {
+        if (reportKeys)
+        {
+            reporter.addKey(event);
+        }
+        keyboard.add(event);
+        gestureMatcher.add(event);
+    }
+
+    void handleGesture(const GestureMatcher::Event& event)
+    {
+        if (reportGestures)
+        {
+            reporter.addGesture(event);
+        }
+    }
+
+    bool handleSetMode(std::uint8_t rhport, std::uint8_t stage, const tusb_control_request_t& request)
+    {
+        if (stage == CONTROL_STAGE_SETUP)
+        {
+            reportEvents = (request.wValue & UsbReportMode::EVENTS) != 0;
+            rawReporter.setEnabled((request.wValue & UsbReportMode::RAW) != 0);
+            keyboard.setEnabled((request.wValue & UsbReportMode::KEYBOARD) != 0);
+            reportKeys = (request.wValue & UsbReportMode::KEYS) != 0;
+            reportGestures = (request.wValue & UsbReportMode::GESTURES) != 0;
+            return tud_control_status(rhport, &request);
+        }
+        return true;
+    }
+}
 
 void core1_loop()
 {
+    // USB and transmitter interrupts are handled by the core calling tusb_init() / initialize()
+    setPersonality(settings.getUsbPersonality());
+    tusb_init();
+    usbClock.initialize();
+    transmitter.initialize();
+    wakeAlarm = static_cast<unsigned int>(hardware_alarm_claim_unused(true));
+    hardware_alarm_set_callback(wakeAlarm, &handleWakeAlarm);
+    VendorControl::registerHandler(VendorRequest::GET_LATENCY, VendorControl::Handler::create<EventReporter, &EventReporter::handleLatencyRequest>(reporter));
+    VendorControl::registerHandler(VendorRequest::RESET_LATENCY, VendorControl::Handler::create<EventReporter, &EventReporter::handleLatencyRequest>(reporter));
+    VendorControl::registerHandler(VendorRequest::SET_MODE, VendorControl::Handler::create<&handleSetMode>());
+    VendorControl::registerHandler(VendorRequest::GET_STATISTICS, VendorControl::Handler::create<Diagnostics, &Diagnostics::handleRequest>(diagnostics));
+    VendorControl::registerHandler(VendorRequest::GET_TRACE, VendorControl::Handler::create<Diagnostics, &Diagnostics::handleRequest>(diagnostics));
+    VendorControl::registerHandler(VendorRequest::GET_HISTOGRAMS, VendorControl::Handler::create<Diagnostics, &Diagnostics::handleRequest>(diagnostics));
+    VendorControl::registerHandler(VendorRequest::RESET_HISTOGRAMS, VendorControl::Handler::create<Diagnostics, &Diagnostics::handleRequest>(diagnostics));
+    VendorControl::registerHandler(VendorRequest::GET_TRANSMIT_STATUS, VendorControl::Handler::create<TransmitController, &TransmitController::handleStatusRequest>(transmitController));
+    VendorControl::registerHandler(VendorRequest::GET_CONFIG, VendorControl::Handler::create<Settings, &Settings::handleRequest>(settings));
+    VendorControl::registerHandler(VendorRequest::SET_CONFIG, VendorControl::Handler::create<Settings, &Settings::handleRequest>(settings));
+    VendorControl::registerHandler(VendorRequest::GET_CLOCK, VendorControl::Handler::create<UsbClock, &UsbClock::handleRequest>(usbClock));
+    VendorControl::registerHandler(VendorRequest::SET_FILTER, VendorControl::Handler::create<EventReporter, &EventReporter::handleFilterRequest>(reporter));
+    settings.setChangeHandler(Settings::ChangeHandler::create<&applySettings>());
+    keyTracker.setEventHandler(KeyTracker::EventHandler::create<&handleKey>());
+    gestureMatcher.setEventHandler(GestureMatcher::EventHandler::create<&handleGesture>());
+
+    etl::array<IrDecoder::Data, 16> irEvents;
     while (true)
     {
         tud_task();
+
+        for (std::uint8_t receiver = 0; receiver < std::size(receivers); receiver++)
+        {
+            const std::size_t count{receivers[receiver].decoder.getEvents(irEvents)};
+            for (std::size_t i = 0; i < count; i++)
+            {
+                if (combiner.accept(irEvents[i], receiver))
+                {
+                    if (reportEvents)
+                    {
+                        reporter.add(irEvents[i]);
+                    }
+                    keyTracker.add(irEvents[i]);
+                }
+            }
+        }
+        const std::uint64_t nowUs{time_us_64()};
+        keyTracker.task(nowUs);
+        gestureMatcher.task(nowUs);
+        reporter.transmit();
+        rawReporter.transmit();
+        irToy.task();
+        keyboard.task();
+        transmitter.poll();
+
+        if ((reenumerateUs != 0) && (nowUs >= reenumerateUs)) // the host reads the descriptors of the new personality
+        {
+            reenumerateUs = 0;
+            tud_disconnect();
+            sleep_ms(DISCONNECT_TIME_MS);
+            setPersonality(settings.getUsbPersonality());
+            tud_connect();
+        }
+
+        // sleep until the decoder or the capture signals new data (SEV), an USB interrupt arrives or the alarm of the next
+        // deadline (raw flush, timed repeat or release of a key, end of a gesture, carrier change, re-enumeration) fires.
+        // An event signalled after the deadlines were taken is latched and lets WFE return immediately.
+        const std::uint64_t wakeUs{getWakeTimeUs(time_us_64())};
+        if (wakeUs == UINT64_MAX)
+        {
+            hardware_alarm_cancel(wakeAlarm);
+        }
+        else if (hardware_alarm_set_target(wakeAlarm, from_us_since_boot(wakeUs))) // the deadline already passed
+        {
+            __sev();
+        }
+        __wfe();
     }
 }
 
@@ -26,43 +289,36 @@ int main()
 {
     stdio_init_all();
 
-    // setup the hardware (board depended)
-    #ifdef RP2040ONE //RP2040-One board (receiver on pin 12, WS1812B LED on pin 16)
-    constexpr unsigned int irDecoderPin{12};
-    LedWS2812 led{16};
-    #else //Pi Pico Board (receiver on pin 22, normal LED on pin 25)
-    constexpr unsigned int irDecoderPin{22};
-    LedGpio led{25};
-    #endif
-    
-    IrDecoder decoder{irDecoderPin, true, &led};
+    // free running SysTick with the CPU clock on core0 to measure the capture interrupt
+    systick_hw->rvr = SYSTICK_MASK;
+    systick_hw->cvr = 0;
+    systick_hw->csr = M0PLUS_SYST_CSR_CLKSOURCE_BITS | M0PLUS_SYST_CSR_ENABLE_BITS;
+
+    // core1 writes the configuration, core0 is paused meanwhile because the flash cannot be read while it is written
+    multicore_lockout_victim_init();
+    configStore.initialize();
+    applySettings(ConfigKey::KEYMAP);
+
     led.initialize();
-    decoder.initialize();
-    IrDecoder::Data irData;
+    animator.initialize();
+    for (Receiver& receiver : receivers)
+    {
+        receiver.decoder.setEventNotifier(IrDecoder::EventNotifier::create<&wakeCore1>());
+        receiver.decoder.setStatusNotifier(IrDecoder::StatusNotifier::create<LedAnimator, &LedAnimator::post>(animator));
+        receiver.edgeSource.initialize(EdgeSourceInterface::PulseHandler::create<Receiver, &Receiver::handlePulses>(receiver));
+        diagnostics.addReceiver(receiver.edgeSource, receiver.decoder);
+    }
 
-    // start USB and execute on core1, just because I can
-    tusb_init();
+    // USB and the event reporting run on core1, the capture and decoder interrupts stay on core0
     multicore_launch_core1(core1_loop);
-    etl::array<std::uint8_t, 64> usbDataBuffer{};
-    usbDataBuffer.fill(0x00);
 
     while (true)
     {
-        if (decoder.getData(irData))
-        {
-            usbDataBuffer[0] = 0x00;
-            usbDataBuffer[1] = irData.address;
-            usbDataBuffer[2] = irData.command;
-            usbDataBuffer[3] = (irData.repeated) ? 1 : 0;
-            tud_vendor_write(usbDataBuffer.data(), usbDataBuffer.size());
-        }
+        __wfi();
     }
 }
 
-extern "C" void tud_vendor_rx_cb(std::uint8_t ift)
+extern "C" void tud_vendor_rx_cb(std::uint8_t)
 {
-    // Echo only for test of USB rx
-    std::uint8_t rxBuffer[CFG_TUD_VENDOR_RX_BUFSIZE];
-    tud_vendor_read(rxBuffer, sizeof(rxBuffer));
-    tud_vendor_n_write(ift, rxBuffer, sizeof(rxBuffer));
+    transmitController.receive();
 }
\ No newline at end of file
@@ -0,0 +1,124 @@
+#include "RawReporter.h"
+
+#include <cstring>
+
+#include "pico/stdlib.h"
+#include "tusb.h"
+
+void RawReporter::add(etl::span<const IrPulse> pulses)
+{
+    if(!isEnabled())
+    {
+        return;
+    }
+
+    for(const IrPulse& pulse : pulses)
+    {
+        pulses_.push(pulse);
+    }
+}
+
+std::size_t RawReporter::transmit()
+{
+    if(!tud_vendor_mounted())
+    {
+        return 0;
+    }
+
+    const std::uint64_t nowUs{time_us_64()};
+    bool full{false};
+    while(!full)
+    {
+        if(!heldValid_)
+        {
+            if(!pulses_.pop(held_))
+            {
+                break;
+            }
+            heldValid_ = true;
+            lastPulseUs_ = nowUs;
+        }
+
+        full = !encode(held_);
+        if(!full)
+        {
+            heldValid_ = false;
+        }
+    }
+
+    if((count_ == 0) || (!full && ((nowUs - lastPulseUs_) < FLUSH_DELAY_US)))
+    {
+        return 0;
+    }
+    if(tud_vendor_write_available() < size_)
+    {
+        return 0;
+    }
+
+    const std::uint32_t lostCount{pulses_.getOverflowCount()};
+    const UsbRawReportHeader header
+    {
+        .type = static_cast<std::uint8_t>(UsbReportType::RAW),
+        .count = count_,
+        .flags = static_cast<std::uint8_t>((firstIsMark_ ? UsbRawFlags::FIRST_IS_MARK : 0) | ((lostCount != lostCount_) ? UsbRawFlags::PULSES_LOST : 0)),
+        .sequence = sequence_++
+    };
+    lostCount_ = lostCount;
+    std::memcpy(report_.data(), &header, sizeof(header));
+
+    tud_vendor_write(report_.data(), static_cast<std::uint32_t>(size_));
+    tud_vendor_write_flush();
+
+    const std::size_t count{count_};
+    reset();
+    return count;
+}
+
+bool RawReporter::encode(const IrPulse& pulse)
+{
+    if(count_ == 0)
+    {
+        firstIsMark_ = pulse.mark;
+        previousUs_ = {0, 0};
+    }
+    // the levels are implicit, a pulse lost in the capture starts a new report
+    else if((pulse.mark == lastIsMark_) || (count_ == UINT8_MAX))
+    {
+        return false;
+    }
+
+    std::uint32_t& previousUs{previousUs_[pulse.mark ? 1 : 0]};
+    const std::int32_t delta{static_cast<std::int32_t>(pulse.durationUs - previousUs)};
+    std::uint32_t value{(static_cast<std::uint32_t>(delta) << 1) ^ static_cast<std::uint32_t>(delta >> 31)};
+
+    etl::array<std::uint8_t, MAX_VARINT_SIZE> varint;
+    std::size_t length{0};
+    do
+    {
+        varint[length] = static_cast<std::uint8_t>(value & 0x7F);
+        value >>= 7;
+        if(value != 0)
+        {
+            varint[length] |= 0x80;
+        }
+        length++;
+    } while(value != 0);
+
+    if((size_ + length) > report_.size())
+    {
+        return false;
+    }
+
+    std::memcpy(report_.data() + size_, varint.data(), length);
+    size_ += length;
+    previousUs = pulse.durationUs;
+    lastIsMark_ = pulse.mark;
+    count_++;
+    return true;
+}
+
+void RawReporter::reset()
+{
+    size_ = sizeof(UsbRawReportHeader);
+    count_ = 0;
+}
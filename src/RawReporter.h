@@ -0,0 +1,52 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include "etl/array.h"
+#include "etl/span.h"
+#include "EdgeSourceInterface.h"
+#include "SpscQueue.h"
+#include "UsbReport.h"
+
+/// Streams the captured mark / space durations unmodified ("learning" mode), e.g. to record remotes the decoder does not know.
+/// The pulses are taken in the capture context and encoded and sent by the USB context. Every duration is stored as
+/// difference to the previous duration of the same level (zigzag + LEB128 varint), so most pulses need one or two bytes
+/// and a whole frame fits in one or two reports of one USB packet each. Every report can be decoded on its own.
+class RawReporter
+{
+public:
+    /// Capture side, queue the pulses if the streaming is enabled
+    void add(etl::span<const IrPulse> pulses);
+
+    /// Encode the queued pulses and send a report if it is full or no pulse arrived for a while, returns the number of pulses sent
+    std::size_t transmit();
+
+    void setEnabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+    bool isEnabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    /// Time transmit() has to run to flush a report which is not full, UINT64_MAX if none waits (a full report is sent
+    /// when the USB buffer has space again, new pulses wake the USB core)
+    std::uint64_t getFlushTimeUs() const { return ((count_ > 0) && !heldValid_) ? lastPulseUs_ + FLUSH_DELAY_US : UINT64_MAX; }
+
+private:
+    static constexpr std::size_t QUEUE_SIZE{256};
+    static constexpr std::size_t MAX_REPORT_SIZE{64}; // one full speed bulk packet
+    static constexpr std::size_t MAX_VARINT_SIZE{5};
+    static constexpr std::uint64_t FLUSH_DELAY_US{10000}; // longer than the frame gap, so a frame is not split by pauses in the capture
+
+    std::atomic<bool> enabled_{false};
+    SpscQueue<IrPulse, QUEUE_SIZE> pulses_{};
+    IrPulse held_{};                      ///< Pulse taken from the queue which did not fit in the last report
+    bool heldValid_{false};
+    etl::array<std::uint8_t, MAX_REPORT_SIZE> report_{};
+    std::size_t size_{sizeof(UsbRawReportHeader)};
+    std::uint8_t count_{0};
+    bool firstIsMark_{false};
+    bool lastIsMark_{false};
+    etl::array<std::uint32_t, 2> previousUs_{}; ///< Previous space and mark duration of the report
+    std::uint8_t sequence_{0};
+    std::uint32_t lostCount_{0};          ///< Queue overflows already reported
+    std::uint64_t lastPulseUs_{0};        ///< Time the last pulse was taken from the queue
+
+    bool encode(const IrPulse& pulse);
+    void reset();
+};
@@ -0,0 +1,155 @@
+#include "Settings.h"
+
+#include <cstring>
+
+#include "IrDecoder.h"
+#include "VendorControl.h"
+
+etl::span<const KeymapEntry> Settings::getKeymap() const
+{
+    const etl::span<const std::uint8_t> value{store_.read(static_cast<std::uint16_t>(ConfigKey::KEYMAP))};
+    if(value.empty() || !isValid(static_cast<std::uint16_t>(ConfigKey::KEYMAP), value))
+    {
+        return Keymaps::DEFAULT;
+    }
+    // the records are 4 byte aligned, the entries can be used in place
+    return etl::span<const KeymapEntry>{reinterpret_cast<const KeymapEntry*>(value.data()), value.size() / sizeof(KeymapEntry)};
+}
+
+std::uint32_t Settings::getEnabledProtocols() const
+{
+    std::uint32_t mask{IrDecoder::ALL_PROTOCOLS};
+    if(const std::uint8_t* const value{read(ConfigKey::PROTOCOLS, sizeof(mask))})
+    {
+        std::memcpy(&mask, value, sizeof(mask));
+    }
+    return mask;
+}
+
+Settings::LedColor Settings::getLedColor() const
+{
+    LedColor color{0, 127, 0};
+    if(const std::uint8_t* const value{read(ConfigKey::LED_COLOR, sizeof(color))})
+    {
+        color = LedColor{value[0], value[1], value[2]};
+    }
+    return color;
+}
+
+KeyTracker::RepeatSettings Settings::getKeyRepeat() const
+{
+    KeyTracker::RepeatSettings settings{KeyTracker::DEFAULT_REPEAT};
+    if(const std::uint8_t* const value{read(ConfigKey::KEY_REPEAT, sizeof(settings))})
+    {
+        std::memcpy(&settings, value, sizeof(settings));
+    }
+    return settings;
+}
+
+etl::span<const GestureEntry> Settings::getGestures() const
+{
+    const etl::span<const std::uint8_t> value{store_.read(static_cast<std::uint16_t>(ConfigKey::GESTURES))};
+    if(value.empty() || !isValid(static_cast<std::uint16_t>(ConfigKey::GESTURES), value))
+    {
+        return {};
+    }
+    return etl::span<const GestureEntry>{reinterpret_cast<const GestureEntry*>(value.data()), value.size() / sizeof(GestureEntry)};
+}
+
+UsbPersonality Settings::getUsbPersonality() const
+{
+    UsbPersonality personality{UsbPersonality::VENDOR};
+    if(const std::uint8_t* const value{read(ConfigKey::USB_PERSONALITY, sizeof(personality))})
+    {
+        personality = static_cast<UsbPersonality>(value[0]);
+    }
+    return personality;
+}
+
+bool Settings::handleRequest(std::uint8_t rhport, std::uint8_t stage, const tusb_control_request_t& request)
+{
+    const std::uint16_t key{request.wValue};
+    if(key >= ConfigStore::MAX_KEYS)
+    {
+        return false;
+    }
+
+    switch(static_cast<VendorRequest>(request.bRequest))
+    {
+    case VendorRequest::GET_CONFIG:
+        if(stage == CONTROL_STAGE_SETUP)
+        {
+            const etl::span<const std::uint8_t> value{store_.read(key)};
+            const std::uint16_t size{static_cast<std::uint16_t>((value.size() < request.wLength) ? value.size() : request.wLength)};
+            return tud_control_xfer(rhport, &request, const_cast<std::uint8_t*>(value.data()), size);
+        }
+        return true;
+
+    case VendorRequest::SET_CONFIG:
+        if(stage == CONTROL_STAGE_SETUP)
+        {
+            if(request.wLength > buffer_.size())
+            {
+                return false;
+            }
+            if(request.wLength == 0) // no data stage, delete the value now
+            {
+                return write(key, {}) && tud_control_status(rhport, &request);
+            }
+            return tud_control_xfer(rhport, &request, buffer_.data(), request.wLength);
+        }
+        if(stage == CONTROL_STAGE_DATA)
+        {
+            return write(key, etl::span<const std::uint8_t>{buffer_.data(), request.wLength});
+        }
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+const std::uint8_t* Settings::read(ConfigKey key, std::size_t size) const
+{
+    const etl::span<const std::uint8_t> value{store_.read(static_cast<std::uint16_t>(key))};
+    return (value.size() == size) ? value.data() : nullptr;
+}
+
+bool Settings::isValid(std::uint16_t key, etl::span<const std::uint8_t> value)
+{
+    if(value.empty()) // back to the default
+    {
+        return true;
+    }
+
+    switch(static_cast<ConfigKey>(key))
+    {
+    case ConfigKey::KEYMAP:
+        return ((value.size() % sizeof(KeymapEntry)) == 0) && ((value.size() / sizeof(KeymapEntry)) <= Keymap::MAX_ENTRIES);
+    case ConfigKey::PROTOCOLS:
+        return value.size() == sizeof(std::uint32_t);
+    case ConfigKey::LED_COLOR:
+        return value.size() == sizeof(LedColor);
+    case ConfigKey::KEY_REPEAT:
+        return value.size() == sizeof(KeyTracker::RepeatSettings);
+    case ConfigKey::GESTURES:
+        return ((value.size() % sizeof(GestureEntry)) == 0) && ((value.size() / sizeof(GestureEntry)) <= GestureMatcher::MAX_GESTURES);
+    case ConfigKey::USB_PERSONALITY:
+        return (value.size() == sizeof(UsbPersonality)) && (value[0] <= static_cast<std::uint8_t>(UsbPersonality::IR_TOY));
+    default:
+        return true;
+    }
+}
+
+bool Settings::write(std::uint16_t key, etl::span<const std::uint8_t> value)
+{
+    if(!isValid(key, value) || !store_.write(key, value))
+    {
+        return false;
+    }
+    if(changeHandler_.is_valid())
+    {
+        changeHandler_(static_cast<ConfigKey>(key));
+    }
+    return true;
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <cstdint>
+#include "etl/array.h"
+#include "etl/delegate.h"
+#include "etl/span.h"
+#include "tusb.h"
+#include "ConfigStore.h"
+#include "GestureMatcher.h"
+#include "Keymap.h"
+#include "KeyTracker.h"
+#include "UsbReport.h"
+
+/// Typed view of the configuration in the store with the defaults of missing or invalid values, and the handler of
+/// the vendor requests reading and writing it. The flash is written in the USB task (the other core is paused meanwhile).
+class Settings
+{
+public:
+    /// Called after a value was changed by the host, e.g. to apply it
+    using ChangeHandler = etl::delegate<void(ConfigKey key)>;
+
+    struct LedColor
+    {
+        std::uint8_t red;
+        std::uint8_t green;
+        std::uint8_t blue;
+    };
+
+    explicit Settings(ConfigStore& store) :
+    store_{store}
+    {}
+
+    void setChangeHandler(ChangeHandler handler) { changeHandler_ = handler; }
+
+    /// Stored keymap (memory mapped, valid until the next change) or Keymaps::DEFAULT
+    etl::span<const KeymapEntry> getKeymap() const;
+
+    /// Mask of the decoded protocols, see IrDecoder::setEnabledProtocols()
+    std::uint32_t getEnabledProtocols() const;
+
+    LedColor getLedColor() const;
+
+    KeyTracker::RepeatSettings getKeyRepeat() const;
+
+    /// Stored gestures (memory mapped, valid until the next change), empty if none
+    etl::span<const GestureEntry> getGestures() const;
+
+    UsbPersonality getUsbPersonality() const;
+
+    /// Handler for VendorRequest::GET_CONFIG and SET_CONFIG
+    bool handleRequest(std::uint8_t rhport, std::uint8_t stage, const tusb_control_request_t& request);
+
+private:
+    ConfigStore& store_;
+    ChangeHandler changeHandler_{};
+    etl::array<std::uint8_t, ConfigStore::MAX_VALUE_SIZE> buffer_{}; ///< Data stage of SET_CONFIG
+
+    /// Value of a key if it has the expected size, nullptr otherwise
+    const std::uint8_t* read(ConfigKey key, std::size_t size) const;
+    static bool isValid(std::uint16_t key, etl::span<const std::uint8_t> value);
+    bool write(std::uint16_t key, etl::span<const std::uint8_t> value);
+};
@@ -0,0 +1,73 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "etl/array.h"
+#include "etl/span.h"
+
+/// Fixed size, lock free queue for exactly one producer (e.g. an interrupt) and one consumer (e.g. the main loop or the other core).
+/// Only plain loads and stores are used on the shared indices, so it also works on cores without atomic read-modify-write instructions.
+template<typename T, std::size_t SIZE>
+class SpscQueue
+{
+    static_assert((SIZE > 0) && ((SIZE & (SIZE - 1)) == 0), "SIZE must be a power of two");
+
+public:
+    /// Producer side, returns false (and counts the overflow) if the queue is full
+    bool push(const T& item)
+    {
+        const std::uint32_t write{writeIndex_.load(std::memory_order_relaxed)};
+        const std::uint32_t read{readIndex_.load(std::memory_order_acquire)}; // slot is free only after the consumer finished reading it
+        if((write - read) >= SIZE)
+        {
+            overflowCount_.store(overflowCount_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return false;
+        }
+
+        buffer_[write % SIZE] = item;
+        writeIndex_.store(write + 1, std::memory_order_release); // publish the item
+        return true;
+    }
+
+    /// Consumer side, takes all pending items (up to the size of the target), returns the number of items taken
+    std::size_t drain(etl::span<T> items)
+    {
+        const std::uint32_t read{readIndex_.load(std::memory_order_relaxed)};
+        const std::uint32_t write{writeIndex_.load(std::memory_order_acquire)};
+        std::size_t count{write - read};
+        if(count > items.size())
+        {
+            count = items.size();
+        }
+
+        for(std::size_t i = 0; i < count; i++)
+        {
+            items[i] = buffer_[(read + i) % SIZE];
+        }
+        readIndex_.store(read + static_cast<std::uint32_t>(count), std::memory_order_release); // hand the slots back
+        return count;
+    }
+
+    /// Consumer side, takes a single item
+    bool pop(T& item)
+    {
+        return drain(etl::span<T>{&item, 1}) != 0;
+    }
+
+    bool empty() const
+    {
+        return writeIndex_.load(std::memory_order_acquire) == readIndex_.load(std::memory_order_relaxed);
+    }
+
+    /// Number of items dropped because the queue was full
+    std::uint32_t getOverflowCount() const
+    {
+        return overflowCount_.load(std::memory_order_relaxed);
+    }
+
+private:
+    etl::array<T, SIZE> buffer_{};
+    std::atomic<std::uint32_t> writeIndex_{0}; ///< Written by the producer only
+    std::atomic<std::uint32_t> readIndex_{0};  ///< Written by the consumer only
+    std::atomic<std::uint32_t> overflowCount_{0}; ///< Written by the producer only
+};
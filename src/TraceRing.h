@@ -0,0 +1,60 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "etl/array.h"
+#include "etl/span.h"
+
+/// Fixed size ring for exactly one writer (e.g. an interrupt) which always overwrites the oldest entry, so the
+/// writer never waits. A reader (e.g. the other core) takes a snapshot of the newest entries, entries overwritten
+/// while they were copied are dropped from the snapshot. Only plain loads and stores are used on the shared index.
+template<typename T, std::size_t SIZE>
+class TraceRing
+{
+    static_assert((SIZE > 0) && ((SIZE & (SIZE - 1)) == 0), "SIZE must be a power of two");
+
+public:
+    /// Writer side
+    void write(const T& entry)
+    {
+        const std::uint32_t write{writeCount_.load(std::memory_order_relaxed)};
+        buffer_[write % SIZE] = entry;
+        writeCount_.store(write + 1, std::memory_order_release);
+    }
+
+    /// Reader side, copies the newest entries (up to the size of the target) oldest first, returns the number of entries copied.
+    /// writeCount is set to the number of entries written up to the newest copied one (wraps), so missed entries can be detected.
+    std::size_t snapshot(etl::span<T> entries, std::uint32_t& writeCount) const
+    {
+        const std::uint32_t write{writeCount_.load(std::memory_order_acquire)};
+        writeCount = write;
+        std::uint32_t count{write};
+        if(count > SIZE) count = SIZE;
+        if(count > entries.size()) count = static_cast<std::uint32_t>(entries.size());
+
+        const std::uint32_t first{write - count};
+        for(std::uint32_t i = 0; i < count; i++)
+        {
+            entries[i] = buffer_[(first + i) % SIZE];
+        }
+
+        // the writer may have overwritten the oldest copied entries in the meantime (+1 for a write in progress), drop them
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const std::uint32_t written{writeCount_.load(std::memory_order_relaxed) - write + 1};
+        const std::uint32_t free{static_cast<std::uint32_t>(SIZE) - count};
+        const std::uint32_t overwritten{(written > free) ? (written - free) : 0};
+        if(overwritten >= count)
+        {
+            return 0;
+        }
+        for(std::uint32_t i = overwritten; i < count; i++)
+        {
+            entries[i - overwritten] = entries[i];
+        }
+        return count - overwritten;
+    }
+
+private:
+    etl::array<T, SIZE> buffer_{};
+    std::atomic<std::uint32_t> writeCount_{0};
+};
@@ -0,0 +1,167 @@
+#include "TransmitController.h"
+
+#include <cstddef>
+#include <cstring>
+
+void TransmitController::receive()
+{
+    while(true)
+    {
+        const std::size_t needed{getCommandSize()};
+        if(needed == 0) // unknown command, try again with the next byte
+        {
+            rejectedCount_++;
+            size_ = 0;
+            continue;
+        }
+
+        if(size_ < needed)
+        {
+            const std::uint32_t count{tud_vendor_read(command_.data() + size_, static_cast<std::uint32_t>(needed - size_))};
+            if(count == 0)
+            {
+                return; // the rest of the command follows with the next packet
+            }
+            size_ += count;
+            continue;
+        }
+
+        if(!execute())
+        {
+            rejectedCount_++;
+        }
+        size_ = 0;
+    }
+}
+
+bool TransmitController::handleStatusRequest(std::uint8_t rhport, std::uint8_t stage, const tusb_control_request_t& request)
+{
+    if(stage != CONTROL_STAGE_SETUP)
+    {
+        return true;
+    }
+
+    statusReport_ = UsbTransmitStatusReport
+    {
+        .completedCount = transmitter_.getCompletedCount(),
+        .rejectedCount = rejectedCount_ + transmitter_.getRejectedCount(),
+        .idle = static_cast<std::uint8_t>(transmitter_.isIdle() ? 1 : 0),
+        .reserved = {0, 0, 0}
+    };
+    return tud_control_xfer(rhport, &request, &statusReport_, static_cast<std::uint16_t>(sizeof(statusReport_)));
+}
+
+std::size_t TransmitController::getCommandSize() const
+{
+    if(size_ == 0)
+    {
+        return 1; // the type selects the size
+    }
+
+    switch(static_cast<UsbCommandType>(command_[0]))
+    {
+    case UsbCommandType::TRANSMIT_CODE:
+        return sizeof(UsbTransmitCodeCommand);
+    case UsbCommandType::TRANSMIT_RAW:
+        return (size_ < sizeof(UsbTransmitRawCommand)) ? sizeof(UsbTransmitRawCommand) : sizeof(UsbTransmitRawCommand) + command_[offsetof(UsbTransmitRawCommand, size)];
+    default:
+        return 0;
+    }
+}
+
+bool TransmitController::execute()
+{
+    switch(static_cast<UsbCommandType>(command_[0]))
+    {
+    case UsbCommandType::TRANSMIT_CODE:
+    {
+        UsbTransmitCodeCommand command;
+        std::memcpy(&command, command_.data(), sizeof(command));
+        return transmitCode(command);
+    }
+
+    case UsbCommandType::TRANSMIT_RAW:
+    {
+        UsbTransmitRawCommand command;
+        std::memcpy(&command, command_.data(), sizeof(command));
+        return transmitRaw(command, command_.data() + sizeof(command));
+    }
+
+    default:
+        return false;
+    }
+}
+
+bool TransmitController::transmitCode(const UsbTransmitCodeCommand& command)
+{
+    if(command.protocol > static_cast<std::uint8_t>(IrProtocolId::RC6))
+    {
+        return false;
+    }
+
+    const IrProtocolId protocol{static_cast<IrProtocolId>(command.protocol)};
+    const bool toggle{(command.flags & UsbTransmitFlags::TOGGLE) != 0};
+    const std::size_t count{IrProtocolEncoder::encode(protocol, command.address, command.command, toggle, command.bits, pulses_)};
+    if(count == 0)
+    {
+        return false;
+    }
+    const std::size_t repeatCount{IrProtocolEncoder::encodeRepeat(protocol, repeatPulses_)};
+
+    return transmitter_.send(etl::span<const IrPulse>{pulses_.data(), count}, etl::span<const IrPulse>{repeatPulses_.data(), repeatCount},
+                             command.repeats, getPeriodUs(protocol, command.periodUs), getCarrierHz(command.carrierKHz));
+}
+
+bool TransmitController::transmitRaw(const UsbTransmitRawCommand& command, const std::uint8_t* data)
+{
+    if(command.count > pulses_.size())
+    {
+        return false;
+    }
+
+    // same encoding as the RAW report: zigzag varint of the difference to the previous duration of the same level
+    etl::array<std::uint32_t, 2> previousUs{0, 0};
+    bool mark{true};
+    std::size_t offset{0};
+    std::uint32_t frameUs{0}; // the gap of the command follows the frame, the transmitter takes the period
+    for(std::size_t i = 0; i < command.count; i++)
+    {
+        std::uint32_t value{0};
+        std::uint8_t shift{0};
+        std::uint8_t byte{0x80};
+        while((byte & 0x80) != 0)
+        {
+            if((offset >= command.size) || (shift > 28))
+            {
+                return false;
+            }
+            byte = data[offset++];
+            value |= static_cast<std::uint32_t>(byte & 0x7F) << shift;
+            shift += 7;
+        }
+
+        const std::uint32_t delta{(value >> 1) ^ (0u - (value & 1u))};
+        previousUs[mark ? 1 : 0] += delta;
+        pulses_[i] = IrPulse{previousUs[mark ? 1 : 0], mark};
+        frameUs += pulses_[i].durationUs;
+        mark = !mark;
+    }
+
+    return transmitter_.send(etl::span<const IrPulse>{pulses_.data(), command.count}, etl::span<const IrPulse>{},
+                             0, frameUs + getGapUs(command.gapUs), getCarrierHz(command.carrierKHz));
+}
+
+std::uint32_t TransmitController::getCarrierHz(std::uint8_t carrierKHz)
+{
+    return (carrierKHz == 0) ? IrTransmitter::DEFAULT_CARRIER_HZ : carrierKHz * 1000ul;
+}
+
+std::uint32_t TransmitController::getGapUs(std::uint32_t gapUs)
+{
+    return (gapUs == 0) ? DEFAULT_GAP_US : gapUs;
+}
+
+std::uint32_t TransmitController::getPeriodUs(IrProtocolId protocol, std::uint32_t periodUs)
+{
+    return (periodUs == 0) ? IrProtocolEncoder::getFramePeriodUs(protocol) : periodUs;
+}
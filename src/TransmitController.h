@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+#include "etl/array.h"
+#include "EdgeSourceInterface.h"
+#include "IrProtocolEncoder.h"
+#include "IrTransmitter.h"
+#include "tusb.h"
+#include "UsbReport.h"
+
+/// Reads the transmit commands from the vendor bulk OUT endpoint and queues them in the transmitter
+class TransmitController
+{
+public:
+    TransmitController(IrTransmitter& transmitter) :
+    transmitter_{transmitter}
+    {}
+
+    /// Process the received data, call from tud_vendor_rx_cb (same core as the transmitter)
+    void receive();
+
+    /// Handler for VendorRequest::GET_TRANSMIT_STATUS
+    bool handleStatusRequest(std::uint8_t rhport, std::uint8_t stage, const tusb_control_request_t& request);
+
+private:
+    static constexpr std::size_t MAX_COMMAND_SIZE{sizeof(UsbTransmitRawCommand) + UINT8_MAX};
+    static constexpr std::uint32_t DEFAULT_GAP_US{40000};
+
+    IrTransmitter& transmitter_;
+    etl::array<std::uint8_t, MAX_COMMAND_SIZE> command_{};
+    std::size_t size_{0};        ///< Bytes of the current command received so far
+    std::uint32_t rejectedCount_{0};
+    etl::array<IrPulse, IrTransmitter::MAX_PULSES> pulses_{};
+    etl::array<IrPulse, IrProtocolEncoder::MAX_PULSES> repeatPulses_{};
+    UsbTransmitStatusReport statusReport_{}; ///< Must stay valid until the control transfer is done
+
+    std::size_t getCommandSize() const;
+    bool execute();
+    bool transmitCode(const UsbTransmitCodeCommand& command);
+    bool transmitRaw(const UsbTransmitRawCommand& command, const std::uint8_t* data);
+
+    static std::uint32_t getCarrierHz(std::uint8_t carrierKHz);
+    static std::uint32_t getGapUs(std::uint32_t gapUs);
+    static std::uint32_t getPeriodUs(IrProtocolId protocol, std::uint32_t periodUs);
+};
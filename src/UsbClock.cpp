@@ -0,0 +1,81 @@
+#include "UsbClock.h"
+
+#include "hardware/irq.h"
+#include "hardware/structs/usb.h"
+#include "hardware/sync.h"
+#include "pico/stdlib.h"
+
+UsbClock* UsbClock::instance_{nullptr};
+
+void UsbClock::interruptTrampoline()
+{
+    if(instance_ != nullptr)
+    {
+        instance_->interruptHandler();
+    }
+}
+
+void UsbClock::initialize()
+{
+    instance_ = this;
+
+    // added after the handler of TinyUSB with the same order priority, so it runs first
+    irq_add_shared_handler(USBCTRL_IRQ, &UsbClock::interruptTrampoline, PICO_SHARED_IRQ_HANDLER_HIGHEST_ORDER_PRIORITY);
+    hw_set_bits(&usb_hw->inte, USB_INTS_DEV_SOF_BITS);
+}
+
+void UsbClock::interruptHandler()
+{
+    const std::uint32_t status{usb_hw->ints};
+    if((status & (USB_INTS_DEV_SOF_BITS | USB_INTS_SETUP_REQ_BITS)) == 0)
+    {
+        return;
+    }
+    const std::uint64_t nowUs{time_us_64()};
+
+    if((status & USB_INTS_DEV_SOF_BITS) != 0)
+    {
+        // reading the frame number clears the interrupt, TinyUSB does not use the SOF
+        sof_ = Sof{nowUs, static_cast<std::uint16_t>(usb_hw->sof_rd & USB_SOF_RD_BITS)};
+
+        const std::uint16_t frames{static_cast<std::uint16_t>((sof_.frame - periodStart_.frame) & FRAME_MASK)};
+        const std::uint64_t periodUs{nowUs - periodStart_.timeUs};
+        if((periodStart_.timeUs == 0) || (periodUs > MAX_PERIOD_US)) // first SOF or SOFs missed
+        {
+            periodStart_ = sof_;
+        }
+        else if(frames >= PERIOD_FRAMES)
+        {
+            framePeriodNs_ = static_cast<std::uint32_t>(periodUs * 1000 / frames);
+            periodStart_ = sof_;
+        }
+    }
+
+    // TinyUSB handles (and clears) the SETUP packet after this handler, the SOF of its frame is the latest one
+    if((status & USB_INTS_SETUP_REQ_BITS) != 0)
+    {
+        setupTimeUs_ = nowUs;
+        setupSof_ = sof_;
+    }
+}
+
+bool UsbClock::handleRequest(std::uint8_t rhport, std::uint8_t stage, const tusb_control_request_t& request)
+{
+    if(stage != CONTROL_STAGE_SETUP)
+    {
+        return true;
+    }
+
+    // the host cannot send the next SETUP packet before this request is done, so the latched one is the one of this request
+    const std::uint32_t interrupts{save_and_disable_interrupts()};
+    report_ = UsbClockReport
+    {
+        .setupTimeUs = setupTimeUs_,
+        .sofTimeUs = setupSof_.timeUs,
+        .framePeriodNs = framePeriodNs_,
+        .sofFrame = setupSof_.frame,
+        .reserved = 0
+    };
+    restore_interrupts(interrupts);
+    return tud_control_xfer(rhport, &request, &report_, static_cast<std::uint16_t>(sizeof(report_)));
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+#include "tusb.h"
+#include "UsbReport.h"
+
+/// Correlation of the device time (time_us_64) with the USB start of frames. The host sends a SOF every 1 ms from its
+/// own clock, a handler in front of the TinyUSB interrupt latches the device time of every SOF and SETUP packet, so the
+/// host can map the event time stamps (device time of the last edge of the frame) to its clock without the jitter of
+/// the USB transfers and of its scheduler (see UsbClockReport).
+class UsbClock
+{
+public:
+    /// Add the interrupt handler and enable the SOF interrupt, call once on the core running TinyUSB after tusb_init()
+    void initialize();
+
+    /// Handler for VendorRequest::GET_CLOCK
+    bool handleRequest(std::uint8_t rhport, std::uint8_t stage, const tusb_control_request_t& request);
+
+private:
+    struct Sof
+    {
+        std::uint64_t timeUs;
+        std::uint16_t frame;
+    };
+
+    static constexpr std::uint16_t FRAME_MASK{0x7FF};     // 11 bit frame number
+    static constexpr std::uint16_t PERIOD_FRAMES{1024};   // frames per measurement of the frame period
+    static constexpr std::uint64_t MAX_PERIOD_US{2000000}; // the frame number wraps after 2048 ms (e.g. suspended)
+
+    // written by the interrupt handler, read with the interrupts disabled
+    Sof sof_{0, 0};           ///< Latest SOF
+    Sof setupSof_{0, 0};      ///< SOF before the latest SETUP packet
+    Sof periodStart_{0, 0};   ///< First SOF of the running period measurement
+    std::uint64_t setupTimeUs_{0};
+    std::uint32_t framePeriodNs_{0};
+    UsbClockReport report_{}; ///< Must stay valid until the control transfer is done
+
+    static UsbClock* instance_;
+
+    void interruptHandler();
+    static void interruptTrampoline();
+};
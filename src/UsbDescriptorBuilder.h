@@ -0,0 +1,253 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+/// Builds USB descriptors at compile time. Every function returns the bytes of its descriptors as Bytes<SIZE>, the parts
+/// of a configuration or an MS OS 2.0 descriptor set are passed to the function of the enclosing descriptor, which
+/// computes the lengths and counts. So the layout of a composite device is written once as a nested expression and
+/// the result is a constant in flash, e.g.
+///
+///     constexpr auto CONFIGURATION{configuration(1, 0, 500, vendorInterface(0, 4, 0x01, 0x81, 64), hidInterface(...))};
+namespace UsbDescriptorBuilder
+{
+    /// Bytes of one or more descriptors (aligned, TinyUSB takes string descriptors as uint16_t array)
+    template<std::size_t SIZE>
+    struct alignas(4) Bytes
+    {
+        std::uint8_t data[SIZE];
+
+        static constexpr std::size_t size() { return SIZE; }
+        constexpr std::uint8_t operator[](std::size_t index) const { return data[index]; }
+    };
+
+    static constexpr std::uint8_t DESCRIPTOR_TYPE_DEVICE{0x01};
+    static constexpr std::uint8_t DESCRIPTOR_TYPE_CONFIGURATION{0x02};
+    static constexpr std::uint8_t DESCRIPTOR_TYPE_STRING{0x03};
+    static constexpr std::uint8_t DESCRIPTOR_TYPE_INTERFACE{0x04};
+    static constexpr std::uint8_t DESCRIPTOR_TYPE_ENDPOINT{0x05};
+    static constexpr std::uint8_t DESCRIPTOR_TYPE_BOS{0x0F};
+    static constexpr std::uint8_t DESCRIPTOR_TYPE_DEVICE_CAPABILITY{0x10};
+    static constexpr std::uint8_t DESCRIPTOR_TYPE_INTERFACE_ASSOCIATION{0x0B};
+    static constexpr std::uint8_t DESCRIPTOR_TYPE_HID{0x21};
+    static constexpr std::uint8_t DESCRIPTOR_TYPE_HID_REPORT{0x22};
+    static constexpr std::uint8_t DESCRIPTOR_TYPE_CS_INTERFACE{0x24};
+
+    static constexpr std::uint8_t TRANSFER_BULK{0x02};
+    static constexpr std::uint8_t TRANSFER_INTERRUPT{0x03};
+
+    static constexpr std::uint8_t CLASS_CDC{0x02};
+    static constexpr std::uint8_t CLASS_HID{0x03};
+    static constexpr std::uint8_t CLASS_CDC_DATA{0x0A};
+    static constexpr std::uint8_t CLASS_VENDOR{0xFF};
+
+    /// Index of the MS OS 2.0 descriptor set in wIndex of the vendor request
+    static constexpr std::uint16_t MS_OS_20_DESCRIPTOR_INDEX{0x07};
+
+    namespace Detail
+    {
+        template<std::size_t SIZE>
+        constexpr void append(std::uint8_t* target, std::size_t& offset, const Bytes<SIZE>& part)
+        {
+            for(std::size_t i = 0; i < SIZE; i++)
+            {
+                target[offset++] = part.data[i];
+            }
+        }
+
+        constexpr std::uint8_t low(std::uint32_t value) { return static_cast<std::uint8_t>(value & 0xFF); }
+        constexpr std::uint8_t high(std::uint32_t value) { return static_cast<std::uint8_t>((value >> 8) & 0xFF); }
+
+        /// Interfaces of the descriptors (alternate setting 0 of every interface)
+        template<std::size_t SIZE>
+        constexpr std::uint8_t countInterfaces(const Bytes<SIZE>& descriptors)
+        {
+            std::uint8_t count{0};
+            for(std::size_t offset = 0; offset < SIZE; offset += descriptors.data[offset])
+            {
+                if((descriptors.data[offset + 1] == DESCRIPTOR_TYPE_INTERFACE) && (descriptors.data[offset + 3] == 0))
+                {
+                    count++;
+                }
+            }
+            return count;
+        }
+    }
+
+    template<typename... Values>
+    constexpr Bytes<sizeof...(Values)> bytes(Values... values)
+    {
+        return Bytes<sizeof...(Values)>{{static_cast<std::uint8_t>(values)...}};
+    }
+
+    template<typename... Parts>
+    constexpr auto concat(const Parts&... parts)
+    {
+        Bytes<(Parts::size() + ...)> result{};
+        std::size_t offset{0};
+        (Detail::append(result.data, offset, parts), ...);
+        return result;
+    }
+
+    constexpr Bytes<18> device(std::uint16_t bcdUsb, std::uint8_t deviceClass, std::uint8_t subClass, std::uint8_t protocol, std::uint8_t maxPacketSize0,
+                               std::uint16_t vid, std::uint16_t pid, std::uint16_t bcdDevice, std::uint8_t manufacturer, std::uint8_t product, std::uint8_t serialNumber)
+    {
+        using namespace Detail;
+        return bytes(18, DESCRIPTOR_TYPE_DEVICE, low(bcdUsb), high(bcdUsb), deviceClass, subClass, protocol, maxPacketSize0, low(vid), high(vid), low(pid), high(pid),
+                     low(bcdDevice), high(bcdDevice), manufacturer, product, serialNumber, 1);
+    }
+
+    /// Configuration with its interfaces, the total length and the interface count are taken from the parts
+    template<typename... Parts>
+    constexpr auto configuration(std::uint8_t value, std::uint8_t attributes, std::uint16_t powerMa, const Parts&... parts)
+    {
+        using namespace Detail;
+        const auto interfaces{concat(parts...)};
+        const std::size_t length{9 + interfaces.size()};
+        return concat(bytes(9, DESCRIPTOR_TYPE_CONFIGURATION, low(length), high(length), countInterfaces(interfaces), value, 0, 0x80 | attributes, powerMa / 2), interfaces);
+    }
+
+    constexpr Bytes<9> interface(std::uint8_t number, std::uint8_t alternate, std::uint8_t endpoints, std::uint8_t interfaceClass, std::uint8_t subClass,
+                                 std::uint8_t protocol, std::uint8_t name)
+    {
+        return bytes(9, DESCRIPTOR_TYPE_INTERFACE, number, alternate, endpoints, interfaceClass, subClass, protocol, name);
+    }
+
+    constexpr Bytes<7> endpoint(std::uint8_t address, std::uint8_t transfer, std::uint16_t maxPacketSize, std::uint8_t interval)
+    {
+        using namespace Detail;
+        return bytes(7, DESCRIPTOR_TYPE_ENDPOINT, address, transfer, low(maxPacketSize), high(maxPacketSize), interval);
+    }
+
+    /// Vendor interface with a bulk OUT and IN endpoint
+    constexpr auto vendorInterface(std::uint8_t number, std::uint8_t name, std::uint8_t outEndpoint, std::uint8_t inEndpoint, std::uint16_t packetSize)
+    {
+        return concat(interface(number, 0, 2, CLASS_VENDOR, 0, 0, name), endpoint(outEndpoint, TRANSFER_BULK, packetSize, 0), endpoint(inEndpoint, TRANSFER_BULK, packetSize, 0));
+    }
+
+    /// HID interface (no boot subclass) with an interrupt IN endpoint
+    constexpr auto hidInterface(std::uint8_t number, std::uint8_t name, std::uint8_t protocol, std::uint16_t reportLength, std::uint8_t inEndpoint,
+                                std::uint16_t packetSize, std::uint8_t intervalMs)
+    {
+        using namespace Detail;
+        return concat(interface(number, 0, 1, CLASS_HID, 0, protocol, name),
+                      bytes(9, DESCRIPTOR_TYPE_HID, 0x11, 0x01, 0, 1, DESCRIPTOR_TYPE_HID_REPORT, low(reportLength), high(reportLength)), // HID 1.11, not localized, one report descriptor
+                      endpoint(inEndpoint, TRANSFER_INTERRUPT, packetSize, intervalMs));
+    }
+
+    /// CDC ACM function: interface association, communication interface with notification endpoint, data interface with bulk OUT and IN
+    constexpr auto cdcInterfaces(std::uint8_t number, std::uint8_t name, std::uint8_t notificationEndpoint, std::uint16_t notificationSize,
+                                 std::uint8_t outEndpoint, std::uint8_t inEndpoint, std::uint16_t packetSize)
+    {
+        constexpr std::uint8_t ACM{0x02};
+        constexpr std::uint8_t NOTIFICATION_INTERVAL_MS{16};
+        return concat(bytes(8, DESCRIPTOR_TYPE_INTERFACE_ASSOCIATION, number, 2, CLASS_CDC, ACM, 0, 0),
+                      interface(number, 0, 1, CLASS_CDC, ACM, 0, name),
+                      bytes(5, DESCRIPTOR_TYPE_CS_INTERFACE, 0x00, 0x20, 0x01),                // header, CDC 1.20
+                      bytes(5, DESCRIPTOR_TYPE_CS_INTERFACE, 0x01, 0x00, number + 1),          // call management by the host, data interface
+                      bytes(4, DESCRIPTOR_TYPE_CS_INTERFACE, 0x02, 0x02),                      // ACM: line coding and serial state
+                      bytes(5, DESCRIPTOR_TYPE_CS_INTERFACE, 0x06, number, number + 1),        // union of the communication and data interface
+                      endpoint(notificationEndpoint, TRANSFER_INTERRUPT, notificationSize, NOTIFICATION_INTERVAL_MS),
+                      interface(number + 1, 0, 2, CLASS_CDC_DATA, 0, 0, 0),
+                      endpoint(outEndpoint, TRANSFER_BULK, packetSize, 0),
+                      endpoint(inEndpoint, TRANSFER_BULK, packetSize, 0));
+    }
+
+    /// String descriptor of a UTF-16 literal, any length up to the 126 characters a descriptor can hold
+    template<std::size_t LENGTH>
+    constexpr auto string(const char16_t (&text)[LENGTH])
+    {
+        static_assert((LENGTH - 1) <= 126, "string too long for a descriptor");
+        Bytes<2 * LENGTH> result{}; // the terminator is not sent, its place holds the header
+        result.data[0] = static_cast<std::uint8_t>(2 * LENGTH);
+        result.data[1] = DESCRIPTOR_TYPE_STRING;
+        for(std::size_t i = 0; i < (LENGTH - 1); i++)
+        {
+            result.data[2 + 2 * i] = Detail::low(text[i]);
+            result.data[3 + 2 * i] = Detail::high(text[i]);
+        }
+        return result;
+    }
+
+    /// String descriptor 0 with the supported language
+    constexpr Bytes<4> language(std::uint16_t languageId)
+    {
+        return bytes(4, DESCRIPTOR_TYPE_STRING, Detail::low(languageId), Detail::high(languageId));
+    }
+
+    // MS OS 2.0 descriptors: the BOS descriptor tells Windows (8.1 and later) the vendor request code and the length of
+    // the descriptor set, which it reads with a single request during the enumeration.
+
+    /// BOS descriptor with the MS OS 2.0 platform capability
+    constexpr auto msOs20Bos(std::uint16_t setLength, std::uint8_t vendorCode)
+    {
+        using namespace Detail;
+        constexpr std::uint8_t PLATFORM{0x05};
+        constexpr std::uint8_t CAPABILITY_LENGTH{28};
+        return concat(bytes(5, DESCRIPTOR_TYPE_BOS, 5 + CAPABILITY_LENGTH, 0, 1),
+                      bytes(CAPABILITY_LENGTH, DESCRIPTOR_TYPE_DEVICE_CAPABILITY, PLATFORM, 0,
+                            0xDF, 0x60, 0xDD, 0xD8, 0x89, 0x45, 0xC7, 0x4C, 0x9C, 0xD2, 0x65, 0x9D, 0x9E, 0x64, 0x8A, 0x9F, // {D8DD60DF-4589-4CC7-9CD2-659D9E648A9F}
+                            0x00, 0x00, 0x03, 0x06, // Windows 8.1
+                            low(setLength), high(setLength), vendorCode, 0));
+    }
+
+    /// Descriptor set with the configuration subset
+    template<typename... Parts>
+    constexpr auto msOs20Set(const Parts&... parts)
+    {
+        using namespace Detail;
+        const auto subsets{concat(parts...)};
+        const std::size_t length{10 + subsets.size()};
+        return concat(bytes(10, 0, 0x00, 0, 0x00, 0x00, 0x03, 0x06, low(length), high(length)), subsets); // Windows 8.1
+    }
+
+    /// Configuration subset (configuration index 0) with the function subsets of a composite device
+    template<typename... Parts>
+    constexpr auto msOs20Configuration(const Parts&... parts)
+    {
+        using namespace Detail;
+        const auto functions{concat(parts...)};
+        const std::size_t length{8 + functions.size()};
+        return concat(bytes(8, 0, 0x01, 0, 0, 0, low(length), high(length)), functions);
+    }
+
+    /// Function subset of the interface with its features
+    template<typename... Parts>
+    constexpr auto msOs20Function(std::uint8_t firstInterface, const Parts&... parts)
+    {
+        using namespace Detail;
+        const auto features{concat(parts...)};
+        const std::size_t length{8 + features.size()};
+        return concat(bytes(8, 0, 0x02, 0, firstInterface, 0, low(length), high(length)), features);
+    }
+
+    /// Compatible ID "WINUSB", Windows loads WinUSB for the function without an INF file
+    constexpr Bytes<20> msOs20WinUsb()
+    {
+        return bytes(20, 0, 0x03, 0, 'W', 'I', 'N', 'U', 'S', 'B', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    }
+
+    /// Registry property DeviceInterfaceGUIDs (REG_MULTI_SZ) with one GUID "{XXXXXXXX-XXXX-XXXX-XXXX-XXXXXXXXXXXX}"
+    constexpr auto msOs20DeviceInterfaceGuid(const char16_t (&guid)[39])
+    {
+        using namespace Detail;
+        constexpr char16_t NAME[]{u"DeviceInterfaceGUIDs"};
+        constexpr std::size_t NAME_LENGTH{2 * sizeof(NAME) / sizeof(NAME[0])};
+        constexpr std::size_t DATA_LENGTH{2 * (39 + 1)}; // GUID, terminator and the empty string ending the list
+        constexpr std::size_t LENGTH{10 + NAME_LENGTH + DATA_LENGTH};
+        constexpr std::uint8_t REG_MULTI_SZ{7};
+
+        Bytes<LENGTH> result{};
+        std::size_t offset{0};
+        append(result.data, offset, bytes(low(LENGTH), high(LENGTH), 0x04, 0, REG_MULTI_SZ, 0, low(NAME_LENGTH), high(NAME_LENGTH)));
+        for(const char16_t c : NAME)
+        {
+            append(result.data, offset, bytes(low(c), high(c)));
+        }
+        append(result.data, offset, bytes(low(DATA_LENGTH), high(DATA_LENGTH)));
+        for(const char16_t c : guid)
+        {
+            append(result.data, offset, bytes(low(c), high(c)));
+        }
+        return result; // the final terminator is already zero
+    }
+}
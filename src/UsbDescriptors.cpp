@@ -1,175 +1,187 @@
 #include <cstdint>
-#include <cstring>
-
-#include "etl/string_view.h"
-#include "etl/array.h"
 
 #include "pico/unique_id.h"
 #include "tusb.h"
 
-// WCID implementation inspired by https://github.com/pbatard/libwdi/wiki/WCID-Devices 
+#include "EventEndpoint.h"
+#include "IrToyProtocol.h"
+#include "UsbDescriptorBuilder.h"
+#include "UsbDescriptors.h"
+#include "UsbReport.h"
+#include "VendorControl.h"
 
-//--------------------------------------------------------------------+
-// Device Descriptor
-//--------------------------------------------------------------------+
-static constexpr std::uint16_t VID {0xF055}; // obsolete USB IF VID
-static constexpr std::uint16_t PID {0xB195}; // some random number
-static constexpr std::uint8_t WCID_VENDOR_ID {0x4A};
+// All descriptors are built at compile time (see UsbDescriptorBuilder). Windows binds WinUSB to the vendor and the
+// event interface by the MS OS 2.0 descriptors: it reads the BOS descriptor and then the descriptor set with a single
+// vendor request.
 
-static constexpr tusb_desc_device_t DEVICE_DESCRIPTOR
-{
-    .bLength = sizeof(tusb_desc_device_t),
-    .bDescriptorType = TUSB_DESC_DEVICE,
-    .bcdUSB = 0x0200,
-    .bDeviceClass = TUSB_CLASS_VENDOR_SPECIFIC,
-    .bDeviceSubClass = 0xFF,
-    .bDeviceProtocol = 0xFF,
-    .bMaxPacketSize0 = CFG_TUD_ENDPOINT0_SIZE,
-    .idVendor = VID,
-    .idProduct = PID,
-    .bcdDevice = 0x0100,
-    .iManufacturer = 0x01,
-    .iProduct = 0x02,
-    .iSerialNumber = 0x03,
-    .bNumConfigurations = 0x01
-};
+using namespace UsbDescriptorBuilder;
 
+UsbPersonality UsbDescriptors::personality_{UsbPersonality::VENDOR};
 
 //--------------------------------------------------------------------+
-// Configuration Descriptor
+// String Descriptors
 //--------------------------------------------------------------------+
-static constexpr std::uint8_t LANGUAGE_STRING_DESCRIPTOR_INDEX {0};
-static constexpr std::uint8_t VENDOR_INTERFACE_STRING_DESCRIPTOR_INDEX {DEVICE_DESCRIPTOR.iSerialNumber + 1};
-
 
-static constexpr unsigned CONFIG_TOTAL_LEN {TUD_CONFIG_DESC_LEN + TUD_VENDOR_DESC_LEN};
-
-static constexpr std::uint8_t VENDOR_ENDPOINT {0x01};
-
-static constexpr std::uint8_t const DESCRIPTOR_CONFIGURATION[] =
+/// Index of the string descriptors, also the position in STRING_DESCRIPTORS
+namespace StringIndex
 {
-    // Config number, interface count, string index, total length, attribute, power in mA
-    TUD_CONFIG_DESCRIPTOR(1, 1, LANGUAGE_STRING_DESCRIPTOR_INDEX, CONFIG_TOTAL_LEN, 0x00, 500),
-
-    // Interface number, string index, EP Out & IN address, EP size
-    TUD_VENDOR_DESCRIPTOR(0, VENDOR_INTERFACE_STRING_DESCRIPTOR_INDEX, VENDOR_ENDPOINT, 0x80 | VENDOR_ENDPOINT, CFG_TUD_ENDPOINT0_SIZE)
-};
+    static constexpr std::uint8_t LANGUAGE{0};
+    static constexpr std::uint8_t MANUFACTURER{1};
+    static constexpr std::uint8_t PRODUCT{2};
+    static constexpr std::uint8_t SERIAL_NUMBER{3}; ///< Derived from the chip ID at runtime
+    static constexpr std::uint8_t VENDOR_INTERFACE{4};
+    static constexpr std::uint8_t HID_INTERFACE{5};
+    static constexpr std::uint8_t EVENT_INTERFACE{6};
+    static constexpr std::uint8_t IR_TOY_INTERFACE{7}; ///< CDC interface of the IR Toy personality
+    static constexpr std::uint8_t COUNT{8};
+}
 
+static constexpr auto LANGUAGE_STRING{language(0x0409)}; // US English
+static constexpr auto MANUFACTURER_STRING{string(u"https://github.com/julr")};
+static constexpr auto PRODUCT_STRING{string(u"USB IR Receiver")};
+static constexpr auto VENDOR_INTERFACE_STRING{string(u"Vendor Interface")};
+static constexpr auto HID_INTERFACE_STRING{string(u"Keyboard Interface")};
+static constexpr auto EVENT_INTERFACE_STRING{string(u"Event Interface")};
+static constexpr auto IR_TOY_INTERFACE_STRING{string(u"IR Toy Interface")};
 
-//--------------------------------------------------------------------+
-// String Descriptors
-//--------------------------------------------------------------------+
-static constexpr std::uint8_t MICROSOFT_OS_STRING_DESCRIPTOR_INDEX {0xEE};
-constexpr char16_t WCID_STRING[]{'M', 'S', 'F', 'T', '1', '0', '0', static_cast<char16_t>(WCID_VENDOR_ID), u'\0'};
-constexpr etl::array<etl::pair<std::uint8_t, etl::basic_string_view<char16_t>>, 5> STRING_DESCRIPTORS
+// complete descriptors in flash, returned as they are
+static constexpr const std::uint8_t* STRING_DESCRIPTORS[StringIndex::COUNT]
 {
-    etl::pair{LANGUAGE_STRING_DESCRIPTOR_INDEX,         etl::u16string_view{u"\u0409"}},                  // Language ID (US English)
-    etl::pair{DEVICE_DESCRIPTOR.iManufacturer,          etl::u16string_view{u"https://github.com/julr"}}, // Vendor 
-    etl::pair{DEVICE_DESCRIPTOR.iProduct,               etl::u16string_view{u"USB IR Receiver"}},         // Product
-    etl::pair{VENDOR_INTERFACE_STRING_DESCRIPTOR_INDEX, etl::u16string_view{u"Vendor Interface"}},        // Vendor interface name
-    etl::pair{MICROSOFT_OS_STRING_DESCRIPTOR_INDEX,     etl::u16string_view{WCID_STRING}}                 // WCID
+    LANGUAGE_STRING.data,
+    MANUFACTURER_STRING.data,
+    PRODUCT_STRING.data,
+    nullptr, // serial number, see getSerialNumberDescriptor()
+    VENDOR_INTERFACE_STRING.data,
+    HID_INTERFACE_STRING.data,
+    EVENT_INTERFACE_STRING.data,
+    IR_TOY_INTERFACE_STRING.data
 };
-static char16_t* getDeviceSerialNumber()
+
+static const std::uint16_t* getSerialNumberDescriptor()
 {
-    static char16_t serialUtf16[2*PICO_UNIQUE_BOARD_ID_SIZE_BYTES+1]{u'\0'};
+    static constexpr std::size_t LENGTH{2 * PICO_UNIQUE_BOARD_ID_SIZE_BYTES}; // hex digits
+    static std::uint16_t descriptor[1 + LENGTH]{0};
 
-    if(serialUtf16[0] == u'\0') // only read and convert the serial once
+    if(descriptor[0] == 0) // only read and convert the serial once
     {
-        char serialAscii[2*PICO_UNIQUE_BOARD_ID_SIZE_BYTES+1];
+        char serialAscii[LENGTH + 1];
         pico_get_unique_board_id_string(serialAscii, sizeof(serialAscii));
-        for(std::size_t i = 0; i < sizeof(serialAscii); i++)
+        descriptor[0] = static_cast<std::uint16_t>((DESCRIPTOR_TYPE_STRING << 8) | sizeof(descriptor));
+        for(std::size_t i = 0; i < LENGTH; i++)
         {
-            serialUtf16[i] = static_cast<char16_t>(serialAscii[i]);
+            descriptor[1 + i] = static_cast<std::uint16_t>(serialAscii[i]);
         }
     }
-
-    return serialUtf16;
+    return descriptor;
 }
 
 
 //--------------------------------------------------------------------+
-// Microsoft Compatible ID Feature Descriptor
+// Device Descriptor
 //--------------------------------------------------------------------+
-struct TU_ATTR_PACKED ExtendedCompatIdOSFeatureDescriptor
-{
-    std::uint32_t dwLength;              ///< The length, in bytes, of the complete extended compat ID descriptor
-    std::uint16_t bcdVersion;            ///< The descriptor’s version number, in binary coded decimal (BCD) format
-    std::uint16_t wIndex;                ///< An index that identifies the particular OS feature descriptor
-    std::uint8_t  bCount;                ///< The number of custom property sections
-    std::uint8_t  RESERVED_0[7];         ///< Reserved
-    std::uint8_t  bFirstInterfaceNumber; ///< The interface or function number
-    std::uint8_t  RESERVED_1;            ///< Reserved for system use. Set this value to 0x01
-    char          compatibleID[8];       ///< The function’s compatible ID
-    std::uint8_t  subCompatibleID[8];    ///< The function’s subcompatible ID
-    std::uint8_t  RESERVED_2[6];         ///< Reserved
-};
+static constexpr std::uint16_t VID {0xF055}; // obsolete USB IF VID
+static constexpr std::uint16_t PID {0xB195}; // some random number
+static constexpr std::uint16_t BCD_DEVICE {0x0100};
 
-static constexpr ExtendedCompatIdOSFeatureDescriptor MSFT_COMPATIBLE_ID_FEATURE_DESCRIPTOR
-{
-    .dwLength = sizeof(ExtendedCompatIdOSFeatureDescriptor),
-    .bcdVersion = 0x0100,
-    .wIndex = 4,
-    .bCount = 1,
-    .RESERVED_0{0},
-    .bFirstInterfaceNumber = 0,
-    .RESERVED_1 = 1,
-    .compatibleID{"WINUSB"},
-    .subCompatibleID{0},
-    .RESERVED_2{0}
-};
+// USB 2.1, so the host reads the BOS descriptor; composite device, the class is given by each interface
+static constexpr auto DEVICE_DESCRIPTOR{device(0x0210, 0x00, 0x00, 0x00, CFG_TUD_ENDPOINT0_SIZE, VID, PID, BCD_DEVICE,
+                                               StringIndex::MANUFACTURER, StringIndex::PRODUCT, StringIndex::SERIAL_NUMBER)};
+
+// IR Toy personality: the IDs of the USB Infrared Toy v2, the kernel driver ir_toy binds to them (cdc-acm ignores them),
+// the CDC interfaces are grouped by an interface association descriptor
+static constexpr std::uint16_t IR_TOY_VID {0x04D8};
+static constexpr std::uint16_t IR_TOY_PID {0xFD08};
+
+static constexpr auto IR_TOY_DEVICE_DESCRIPTOR{device(0x0200, TUSB_CLASS_MISC, MISC_SUBCLASS_COMMON, MISC_PROTOCOL_IAD, CFG_TUD_ENDPOINT0_SIZE,
+                                                      IR_TOY_VID, IR_TOY_PID, BCD_DEVICE,
+                                                      StringIndex::MANUFACTURER, StringIndex::PRODUCT, StringIndex::SERIAL_NUMBER)};
 
 
 //--------------------------------------------------------------------+
-// Microsoft Extended Properties Feature Descriptor
+// Configuration Descriptor
 //--------------------------------------------------------------------+
-template<typename Data> 
-struct TU_ATTR_PACKED ExtendedPropertiesOSFeatureDescriptor 
-{
-    std::uint32_t dwLength;              ///< The length, in bytes, of the complete extended properties descriptor
-    std::uint16_t bcdVersion;            ///< The descriptor’s version number, in binary coded decimal (BCD) format
-    std::uint16_t wIndex;                ///< The index for extended properties OS descriptors
-    std::uint16_t wCount;                ///< The number of custom property sections that follow the header section
-    Data          data;                  ///< The data that follows (one ore more property sections)
-};
+static constexpr std::uint8_t VENDOR_INTERFACE {0};
+static constexpr std::uint8_t HID_INTERFACE {1};
+static constexpr std::uint8_t EVENT_INTERFACE {EventEndpoint::INTERFACE};
 
-struct TU_ATTR_PACKED DeviceInterfaceGUIDPropertySection
+static constexpr std::uint8_t const DESCRIPTOR_HID_REPORT[] =
 {
-    std::uint32_t dwSize;                ///< The size of this custom properties section
-    std::uint32_t dwPropertyDataType;    ///< Property data format
-    std::uint16_t wPropertyNameLength;   ///< Property name length
-    char16_t      bPropertyName[20];     ///< The property name
-    std::uint32_t dwPropertyDataLength;  ///< Length of the buffer holding the property data
-    char16_t      bPropertyData[39];     ///< Property data
+    TUD_HID_REPORT_DESC_KEYBOARD(HID_REPORT_ID(HidReportId::KEYBOARD)),
+    TUD_HID_REPORT_DESC_CONSUMER(HID_REPORT_ID(HidReportId::CONSUMER))
 };
 
-using DeviceInterfaceGUIDDescriptor = ExtendedPropertiesOSFeatureDescriptor<DeviceInterfaceGUIDPropertySection>;
-static constexpr DeviceInterfaceGUIDDescriptor MSFT_EXTENDED_PROPERTIES_FEATURE_DESCRIPTOR
+static constexpr std::uint8_t VENDOR_ENDPOINT {0x01};
+static constexpr std::uint8_t HID_ENDPOINT {0x82};
+static constexpr std::uint8_t HID_POLL_INTERVAL_MS {1};
+static constexpr std::uint8_t EVENT_POLL_INTERVAL_MS {1}; // bInterval of the event endpoint, the host polls it every frame
+static constexpr std::uint16_t MAX_POWER_MA {500};
+static_assert(EventEndpoint::ENDPOINT != HID_ENDPOINT, "endpoint used twice");
+
+/// Event interface: alternate setting 0 without endpoint, alternate setting 1 with the interrupt IN endpoint
+static constexpr auto eventInterface(std::uint8_t number, std::uint8_t name, std::uint8_t inEndpoint, std::uint16_t packetSize, std::uint8_t intervalMs)
 {
-    .dwLength = sizeof(DeviceInterfaceGUIDDescriptor),
-    .bcdVersion = 0x0100,
-    .wIndex = 5,
-    .wCount = 1,
-    .data
-    {
-        .dwSize = sizeof(DeviceInterfaceGUIDPropertySection),
-        .dwPropertyDataType = 1, //1 = Unicode REG_SZ
-        .wPropertyNameLength = 40,
-        .bPropertyName{u"DeviceInterfaceGUID"},
-        .dwPropertyDataLength = 78,
-        .bPropertyData{u"{6E3DAB08-A465-4FA0-BA47-BA191F17F5E8}"}
-    }
-};
+    return concat(interface(number, 0, 0, CLASS_VENDOR, 0, 0, name),
+                  interface(number, 1, 1, CLASS_VENDOR, 0, 0, name),
+                  endpoint(inEndpoint, TRANSFER_INTERRUPT, packetSize, intervalMs));
+}
+
+static constexpr auto DESCRIPTOR_CONFIGURATION{configuration(1, 0x00, MAX_POWER_MA,
+    // Interface number, string index, EP Out & IN address, EP size
+    vendorInterface(VENDOR_INTERFACE, StringIndex::VENDOR_INTERFACE, VENDOR_ENDPOINT, 0x80 | VENDOR_ENDPOINT, CFG_TUD_ENDPOINT0_SIZE),
+
+    // Interface number, string index, boot protocol (none, the keyboard report has an ID), report descriptor length, EP IN address, EP size, polling interval
+    hidInterface(HID_INTERFACE, StringIndex::HID_INTERFACE, HID_ITF_PROTOCOL_NONE, sizeof(DESCRIPTOR_HID_REPORT), HID_ENDPOINT, CFG_TUD_HID_EP_BUFSIZE, HID_POLL_INTERVAL_MS),
+
+    // Interface number, string index, EP IN address, EP size, polling interval
+    eventInterface(EVENT_INTERFACE, StringIndex::EVENT_INTERFACE, EventEndpoint::ENDPOINT, EventEndpoint::MAX_PACKET_SIZE, EVENT_POLL_INTERVAL_MS))};
+
+// the class drivers of TinyUSB parse the same layout as their descriptor macros
+static_assert(DESCRIPTOR_CONFIGURATION.size() == TUD_CONFIG_DESC_LEN + TUD_VENDOR_DESC_LEN + TUD_HID_DESC_LEN + 9 + 9 + 7, "unexpected configuration length");
+static_assert(DESCRIPTOR_CONFIGURATION[4] == 3, "unexpected interface count");
+
+// IR Toy personality: only the CDC interfaces, the kernel decodes the keys itself (a HID keyboard would report them twice)
+static constexpr std::uint8_t IR_TOY_INTERFACE {0};
+static constexpr std::uint8_t IR_TOY_NOTIFICATION_ENDPOINT {0x81};
+static constexpr std::uint8_t IR_TOY_DATA_ENDPOINT {0x02};
+static constexpr std::uint8_t IR_TOY_NOTIFICATION_SIZE {8};
+
+static constexpr auto IR_TOY_DESCRIPTOR_CONFIGURATION{configuration(1, 0x00, MAX_POWER_MA,
+    // Interface number, string index, notification EP & size, data EP OUT & IN address, EP size (the driver only accepts 64 byte endpoints)
+    cdcInterfaces(IR_TOY_INTERFACE, StringIndex::IR_TOY_INTERFACE, IR_TOY_NOTIFICATION_ENDPOINT, IR_TOY_NOTIFICATION_SIZE,
+                  IR_TOY_DATA_ENDPOINT, 0x80 | IR_TOY_DATA_ENDPOINT, IrToyProtocol::PACKET_SIZE))};
+
+static_assert(IR_TOY_DESCRIPTOR_CONFIGURATION.size() == TUD_CONFIG_DESC_LEN + TUD_CDC_DESC_LEN, "unexpected configuration length");
+
+
+//--------------------------------------------------------------------+
+// MS OS 2.0 Descriptors
+//--------------------------------------------------------------------+
+static constexpr std::uint8_t MS_OS_20_VENDOR_CODE {0x4A}; // bRequest of the descriptor set request
+static_assert(MS_OS_20_VENDOR_CODE >= static_cast<std::uint8_t>(VendorRequest::COUNT), "vendor code used by a vendor request");
+
+// the vendor and the event interface both use WinUSB, the HID interface keeps the HID driver;
+// own GUID for the event interface, so it is opened separately from the vendor interface
+static constexpr auto MS_OS_20_DESCRIPTOR_SET{msOs20Set(msOs20Configuration(
+    msOs20Function(VENDOR_INTERFACE, msOs20WinUsb(), msOs20DeviceInterfaceGuid(u"{6E3DAB08-A465-4FA0-BA47-BA191F17F5E8}")),
+    msOs20Function(EVENT_INTERFACE, msOs20WinUsb(), msOs20DeviceInterfaceGuid(u"{6E3DAB08-A465-4FA0-BA47-BA191F17F5E9}"))))};
+
+static constexpr auto BOS_DESCRIPTOR{msOs20Bos(MS_OS_20_DESCRIPTOR_SET.size(), MS_OS_20_VENDOR_CODE)};
 
 
 //--------------------------------------------------------------------+
 // TinyUSB Callbacks
 //--------------------------------------------------------------------+
 
+static bool isIrToy()
+{
+    return UsbDescriptors::getPersonality() == UsbPersonality::IR_TOY;
+}
+
 // Invoked when received GET DEVICE DESCRIPTOR
 // Application return pointer to descriptor
 extern "C" std::uint8_t const * tud_descriptor_device_cb(void)
 {
-    return reinterpret_cast<std::uint8_t*>(const_cast<tusb_desc_device_t*>( &DEVICE_DESCRIPTOR ));
+    return isIrToy() ? IR_TOY_DEVICE_DESCRIPTOR.data : DEVICE_DESCRIPTOR.data;
 }
 
 // Invoked when received GET CONFIGURATION DESCRIPTOR
@@ -178,46 +190,34 @@ extern "C" std::uint8_t const * tud_descriptor_device_cb(void)
 extern "C" std::uint8_t const * tud_descriptor_configuration_cb(uint8_t index)
 {
     static_cast<void>(index); // for multiple configurations, not used here
-    return DESCRIPTOR_CONFIGURATION;
+    return isIrToy() ? IR_TOY_DESCRIPTOR_CONFIGURATION.data : DESCRIPTOR_CONFIGURATION.data;
+}
+
+// Invoked when received GET BOS DESCRIPTOR, the IR Toy personality is a USB 2.0 device without one
+extern "C" std::uint8_t const * tud_descriptor_bos_cb(void)
+{
+    return isIrToy() ? nullptr : BOS_DESCRIPTOR.data;
+}
+
+// Invoked when received GET HID REPORT DESCRIPTOR
+// Application return pointer to descriptor, whose contents must exist long enough for transfer to complete
+extern "C" std::uint8_t const * tud_hid_descriptor_report_cb(std::uint8_t instance)
+{
+    static_cast<void>(instance); // only one HID interface
+    return DESCRIPTOR_HID_REPORT;
 }
 
 // Invoked when received GET STRING DESCRIPTOR request
 // Application return pointer to descriptor, whose contents must exist long enough for transfer to complete
 extern "C" std::uint16_t const* tud_descriptor_string_cb(std::uint8_t index, std::uint16_t /* langid */)
-{    
-    static std::uint16_t descriptorString[32]; // make static, so it will be valid even after the function ended
-
-    const char16_t* sourceString{nullptr};
-    std::size_t length; // length in chars (one char = 2 byte)
-
-    // Special case: The Serial number is derived from chip ID and therefore not part of the (compile time created) string table
-    if(index == DEVICE_DESCRIPTOR.iSerialNumber)
-    {
-        sourceString = getDeviceSerialNumber();
-        length = 2*PICO_UNIQUE_BOARD_ID_SIZE_BYTES;
-    }
-    else
+{
+    if(index == StringIndex::SERIAL_NUMBER)
     {
-        for(const auto& entry : STRING_DESCRIPTORS)
-        {
-            if(entry.first == index)
-            {
-                sourceString = entry.second.data();
-                length = entry.second.length();
-                break;
-            }
-        }
+        return getSerialNumberDescriptor();
     }
-
-    // We must copy the string since the first "character" contains the metadata
-    if(sourceString != nullptr)
+    if(index < StringIndex::COUNT)
     {
-        if(length > 31) length = 31; //cap at 31 chars, we have 32 available -1 for metadata
-        // metadata: id + length in bytes
-        descriptorString[0] = (TUSB_DESC_STRING << 8) | (2*length + 2);
-        memcpy(&descriptorString[1], sourceString, length*2);
-        
-        return descriptorString;
+        return reinterpret_cast<const std::uint16_t*>(STRING_DESCRIPTORS[index]); // Bytes are aligned
     }
     return nullptr;
 }
@@ -226,24 +226,18 @@ extern "C" std::uint16_t const* tud_descriptor_string_cb(std::uint8_t index, std
 // Driver response accordingly to the request and the transfer stage (setup/data/ack)
 // return false to stall control endpoint (e.g unsupported request)
 extern "C" bool tud_vendor_control_xfer_cb(uint8_t rhport, uint8_t stage, const tusb_control_request_t* request)
-{ 
-    if (stage == CONTROL_STAGE_SETUP)
+{
+    if(request->bRequest != MS_OS_20_VENDOR_CODE) // application requests, unknown ones are stalled
     {
-        if ((request->wIndex == MSFT_COMPATIBLE_ID_FEATURE_DESCRIPTOR.wIndex) && (request->bRequest == WCID_VENDOR_ID)) // Microsoft Compatible ID Feature Descriptor requested
-        {
-            return tud_control_xfer(rhport, request, const_cast<ExtendedCompatIdOSFeatureDescriptor*>(&MSFT_COMPATIBLE_ID_FEATURE_DESCRIPTOR), static_cast<std::uint16_t>(sizeof(ExtendedCompatIdOSFeatureDescriptor)));
-        }
-        else if((request->wIndex == MSFT_EXTENDED_PROPERTIES_FEATURE_DESCRIPTOR.wIndex) && (request->bmRequestType == 0xC1)) // Microsoft Extended Properties Feature Descriptor requested
-        {
-            return tud_control_xfer(rhport, request, const_cast<DeviceInterfaceGUIDDescriptor*>(&MSFT_EXTENDED_PROPERTIES_FEATURE_DESCRIPTOR), static_cast<std::uint16_t>(sizeof(MSFT_EXTENDED_PROPERTIES_FEATURE_DESCRIPTOR)));
-        }
-        else // stall unknown requests
-        {
-            return false;
-        }
+        return VendorControl::handle(rhport, stage, *request);
     }
-    else // nothing to with DATA & ACK stage
+    if(stage != CONTROL_STAGE_SETUP) // nothing to do with DATA & ACK stage for the descriptor set
     {
         return true;
     }
-}
\ No newline at end of file
+    if((request->wIndex == MS_OS_20_DESCRIPTOR_INDEX) && !isIrToy())
+    {
+        return tud_control_xfer(rhport, request, const_cast<std::uint8_t*>(MS_OS_20_DESCRIPTOR_SET.data), static_cast<std::uint16_t>(MS_OS_20_DESCRIPTOR_SET.size()));
+    }
+    return false;
+}
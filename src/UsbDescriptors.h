@@ -0,0 +1,14 @@
+#pragma once
+#include "UsbReport.h"
+
+/// Selects the descriptors the device enumerates with
+class UsbDescriptors
+{
+public:
+    /// Change only before tusb_init() or while disconnected, the host reads the descriptors when it enumerates the device
+    static void setPersonality(UsbPersonality personality) { personality_ = personality; }
+    static UsbPersonality getPersonality() { return personality_; }
+
+private:
+    static UsbPersonality personality_;
+};
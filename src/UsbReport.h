@@ -0,0 +1,270 @@
+#pragma once
+#include <cstdint>
+
+// Packet formats of the vendor bulk IN endpoint (little endian)
+
+enum class UsbReportType : std::uint8_t
+{
+    EVENTS   = 0x01, ///< UsbEventReportHeader followed by UsbEventReportHeader::count UsbEventReportEntry
+    RAW      = 0x02, ///< UsbRawReportHeader followed by UsbRawReportHeader::count encoded durations
+    KEYS     = 0x03, ///< UsbEventReportHeader followed by UsbEventReportHeader::count UsbKeyEventEntry
+    GESTURES = 0x04  ///< UsbEventReportHeader followed by UsbEventReportHeader::count UsbGestureEntry
+};
+
+struct __attribute__((packed)) UsbEventReportHeader
+{
+    std::uint8_t  type;         ///< UsbReportType::EVENTS, UsbReportType::KEYS or UsbReportType::GESTURES
+    std::uint8_t  count;        ///< Number of events following the header
+    std::uint16_t droppedCount; ///< Number of events dropped so far because the host did not read fast enough (wraps)
+};
+
+struct __attribute__((packed)) UsbEventReportEntry
+{
+    std::uint16_t sequence;    ///< Incremented for every event (also for dropped ones), a gap means lost events
+    std::uint8_t  protocol;    ///< IrProtocolId
+    std::uint8_t  flags;       ///< See UsbEventFlags
+    std::uint32_t timestampUs; ///< Device time of the last edge of the frame (wraps)
+    std::uint32_t code;        ///< All bits of the frame
+    std::uint16_t address;
+    std::uint8_t  command;
+    std::uint8_t  reserved;
+};
+
+namespace UsbEventFlags
+{
+    static constexpr std::uint8_t REPEATED{0x01};
+}
+
+enum class UsbKeyEventType : std::uint8_t
+{
+    PRESS   = 0x01, ///< New frame of a code
+    REPEAT  = 0x02, ///< Key still held, throttled by the repeat settings (ConfigKey::KEY_REPEAT)
+    RELEASE = 0x03  ///< No repeat within 1.5 repeat intervals of the remote
+};
+
+/// State change of the key of a code, one per press and release instead of one event per repeat code
+struct __attribute__((packed)) UsbKeyEventEntry
+{
+    std::uint16_t sequence;    ///< Incremented for every key event (also for dropped ones), independent of the frame events
+    std::uint8_t  type;        ///< UsbKeyEventType
+    std::uint8_t  protocol;    ///< IrProtocolId
+    std::uint16_t address;
+    std::uint8_t  command;
+    std::uint8_t  repeatCount; ///< REPEAT events of this press so far (saturates at 255)
+    std::uint32_t timestampUs; ///< Device time of the last edge of the frame, timed repeat: of the repeat, release: when the next repeat code was due (wraps)
+};
+
+/// Completed gesture (see GestureEntry in GestureMatcher.h)
+struct __attribute__((packed)) UsbGestureEntry
+{
+    std::uint16_t sequence;    ///< Incremented for every gesture (also for dropped ones), independent of the other events
+    std::uint16_t id;          ///< GestureEntry::id
+    std::uint32_t timestampUs; ///< Device time of the end of the last step: release of a tap, frame reaching the hold time of a long press (wraps)
+};
+
+/// The levels alternate starting with the level given by UsbRawFlags::FIRST_IS_MARK. Every duration (µs) is encoded as
+/// difference to the previous duration of the same level in the report (0 for the first one), zigzag encoded
+/// ((d << 1) ^ (d >> 31)) and stored as LEB128 varint (7 bits per byte, least significant first, bit 7 set if more bytes follow).
+struct __attribute__((packed)) UsbRawReportHeader
+{
+    std::uint8_t type;     ///< UsbReportType::RAW
+    std::uint8_t count;    ///< Number of durations following the header
+    std::uint8_t flags;    ///< See UsbRawFlags
+    std::uint8_t sequence; ///< Incremented for every raw report (wraps)
+};
+
+namespace UsbRawFlags
+{
+    static constexpr std::uint8_t FIRST_IS_MARK{0x01};
+    static constexpr std::uint8_t PULSES_LOST{0x02}; ///< Pulses were lost before this report, the previous report was not followed directly
+}
+
+/// Bits of wValue of VendorRequest::SET_MODE
+namespace UsbReportMode
+{
+    static constexpr std::uint16_t EVENTS{0x01};   ///< Decoded events (default)
+    static constexpr std::uint16_t RAW{0x02};      ///< Raw durations of the capture
+    static constexpr std::uint16_t KEYBOARD{0x04}; ///< Mapped codes as keys on the HID interface (default)
+    static constexpr std::uint16_t KEYS{0x08};     ///< Press / repeat / release events of all codes (UsbReportType::KEYS)
+    static constexpr std::uint16_t GESTURES{0x10}; ///< Completed gestures (UsbReportType::GESTURES)
+}
+
+/// Report IDs of the HID interface
+namespace HidReportId
+{
+    static constexpr std::uint8_t KEYBOARD{0x01}; ///< Standard keyboard report (modifiers, 6 key codes)
+    static constexpr std::uint8_t CONSUMER{0x02}; ///< One 16 bit consumer control usage
+}
+
+static_assert(sizeof(UsbEventReportHeader) == 4, "unexpected padding");
+static_assert(sizeof(UsbRawReportHeader) == 4, "unexpected padding");
+static_assert(sizeof(UsbEventReportEntry) == 16, "unexpected padding");
+static_assert(sizeof(UsbKeyEventEntry) == 12, "unexpected padding");
+static_assert(sizeof(UsbGestureEntry) == 8, "unexpected padding");
+
+// Commands of the vendor bulk OUT endpoint (little endian), sent back to back without padding
+
+enum class UsbCommandType : std::uint8_t
+{
+    TRANSMIT_CODE = 0x10, ///< UsbTransmitCodeCommand
+    TRANSMIT_RAW  = 0x11  ///< UsbTransmitRawCommand followed by UsbTransmitRawCommand::size bytes of encoded durations
+};
+
+/// Send a frame of a supported protocol, followed by repeats repeat codes (or the same frame again if the protocol has none)
+struct __attribute__((packed)) UsbTransmitCodeCommand
+{
+    std::uint8_t  type;       ///< UsbCommandType::TRANSMIT_CODE
+    std::uint8_t  protocol;   ///< IrProtocolId
+    std::uint16_t address;
+    std::uint8_t  command;
+    std::uint8_t  repeats;
+    std::uint8_t  flags;      ///< See UsbTransmitFlags
+    std::uint8_t  carrierKHz; ///< 0 for the default of 38 kHz
+    std::uint32_t periodUs;   ///< Time from the start of a frame to the start of the next one, 0 for the period of the protocol
+    std::uint8_t  bits;       ///< Frame length of protocols with several variants (Sony: 12, 15 or 20), 0 for the shortest one
+};
+
+namespace UsbTransmitFlags
+{
+    static constexpr std::uint8_t TOGGLE{0x01}; ///< Toggle bit of RC5 / RC6, flip it for every new key press
+}
+
+/// Send a recorded frame, the durations are encoded like in a RAW report and start with a mark
+struct __attribute__((packed)) UsbTransmitRawCommand
+{
+    std::uint8_t  type;       ///< UsbCommandType::TRANSMIT_RAW
+    std::uint8_t  count;      ///< Number of durations
+    std::uint8_t  size;       ///< Number of bytes of the encoded durations following the command
+    std::uint8_t  carrierKHz; ///< 0 for the default of 38 kHz
+    std::uint32_t gapUs;      ///< Space after the frame, 0 for the default of 40 ms
+};
+
+/// bRequest codes of the vendor control requests (bmRequestType vendor, recipient device)
+enum class VendorRequest : std::uint8_t
+{
+    GET_LATENCY         = 0x01, ///< IN: UsbLatencyReport
+    RESET_LATENCY       = 0x02, ///< OUT, no data
+    SET_MODE            = 0x03, ///< OUT, no data, wValue: reports to send (UsbReportMode bits)
+    GET_STATISTICS      = 0x04, ///< IN: UsbStatisticsReport
+    GET_TRACE           = 0x05, ///< IN: UsbTraceReportHeader followed by the newest UsbTraceEntry (oldest first)
+    GET_HISTOGRAMS      = 0x06, ///< IN: UsbHistogramReportHeader followed by the histograms
+    RESET_HISTOGRAMS    = 0x07, ///< OUT, no data
+    GET_TRANSMIT_STATUS = 0x08, ///< IN: UsbTransmitStatusReport
+    GET_CONFIG          = 0x09, ///< IN: value of the ConfigKey in wValue, empty if not set
+    SET_CONFIG          = 0x0A, ///< OUT: new value of the ConfigKey in wValue, no data deletes the value
+    GET_CLOCK           = 0x0B, ///< IN: UsbClockReport
+    SET_FILTER          = 0x0C, ///< OUT: UsbFilterEntry array of the codes to report, no data reports all codes again
+    COUNT                       ///< Number of request codes, not a request
+};
+
+// Data stage of the vendor control requests (see VendorRequest)
+
+struct __attribute__((packed)) UsbLatencyReport
+{
+    std::uint32_t count;     ///< Number of events measured since the last reset
+    std::uint32_t minUs;     ///< Shortest time from the last edge of a frame until the event was queued for USB
+    std::uint32_t maxUs;     ///< Longest time from the last edge of a frame until the event was queued for USB
+    std::uint32_t averageUs;
+};
+
+struct __attribute__((packed)) UsbStatisticsReport
+{
+    std::uint32_t frames;          ///< Valid frames decoded
+    std::uint32_t repeats;         ///< Repeat codes and repeated frames decoded
+    std::uint32_t invalidHeader;   ///< Frames rejected because no protocol matched the header
+    std::uint32_t invalidBit;      ///< Frames rejected because of a bit length or frame length
+    std::uint32_t invalidChecksum; ///< Frames rejected because of the checksum
+    std::uint32_t eventOverflows;  ///< Events lost between the decoder and USB
+    std::uint32_t droppedEvents;   ///< Events dropped because the host did not read
+    std::uint32_t captureOverruns; ///< Pulses lost in the capture
+    std::uint32_t corrected;       ///< Valid frames which passed the checksum after flipping low confidence bits
+};
+
+struct __attribute__((packed)) UsbTraceReportHeader
+{
+    std::uint32_t writeCount; ///< Number of trace entries written up to the last one in the report (wraps), a host polling the trace can detect missed entries
+};
+
+struct __attribute__((packed)) UsbTraceEntry
+{
+    std::uint32_t timestampUs; ///< Signal time of the pulse which caused the entry (wraps)
+    std::uint8_t  event;       ///< IrDecoder::TraceEvent
+    std::uint8_t  value;       ///< Depends on the event, see IrDecoder::TraceEvent
+    std::uint16_t reserved;
+};
+
+/// Followed by histogramCount histograms of bucketCount uint32 each: CPU cycles per capture interrupt, last edge until
+/// the event was decoded (µs), decoded until written to USB (µs). Bucket 0 counts the value 0, bucket i the values
+/// [2^(i-1), 2^i) and the last bucket all larger values.
+struct __attribute__((packed)) UsbHistogramReportHeader
+{
+    std::uint8_t  histogramCount;
+    std::uint8_t  bucketCount;
+    std::uint16_t reserved;
+};
+
+struct __attribute__((packed)) UsbTransmitStatusReport
+{
+    std::uint32_t completedCount; ///< Transmit jobs sent completely
+    std::uint32_t rejectedCount;  ///< Commands rejected because they were invalid or the queue was full
+    std::uint8_t  idle;           ///< 1 if all jobs are sent
+    std::uint8_t  reserved[3];
+};
+
+/// Device time (µs since boot, the event time stamps are its lower 32 bit) of this request and of the USB start of frame
+/// before it, both latched in the USB interrupt. The SETUP packet arrives between the host times before and after the
+/// request, which bounds the offset between the clocks; the frame period measures the rate of the device clock against
+/// the SOFs of the host.
+struct __attribute__((packed)) UsbClockReport
+{
+    std::uint64_t setupTimeUs;   ///< Device time the SETUP packet of this request arrived
+    std::uint64_t sofTimeUs;     ///< Device time of the last SOF before the SETUP packet
+    std::uint32_t framePeriodNs; ///< Device time between two SOFs averaged over 1024 frames (1000000 if both clocks are exact), 0 until measured
+    std::uint16_t sofFrame;      ///< Frame number of that SOF (11 bit)
+    std::uint16_t reserved;
+};
+
+/// Code the host subscribes to with VendorRequest::SET_FILTER. While a filter is set the events and key events of other
+/// codes are dropped before they are queued for USB (their sequence numbers are not incremented); the HID keyboard, the
+/// gestures and the raw durations are not filtered. The filter is not stored, it is lost on a reset of the device.
+struct __attribute__((packed)) UsbFilterEntry
+{
+    std::uint8_t  protocol; ///< IrProtocolId or UsbFilterProtocol::ANY
+    std::uint8_t  command;
+    std::uint16_t address;
+};
+
+namespace UsbFilterProtocol
+{
+    static constexpr std::uint8_t ANY{0xFF}; ///< The code of every protocol with the address and command
+}
+
+/// Keys of the configuration (wValue of VendorRequest::GET_CONFIG / SET_CONFIG). The values are stored in flash and survive
+/// a reset, a missing or deleted (empty) value selects the default. Keys up to 31 without a meaning here are stored as they are.
+enum class ConfigKey : std::uint16_t
+{
+    KEYMAP          = 0x01, ///< Up to 64 KeymapEntry (8 bytes: protocol, command, address, usage, page, padding), default Keymaps::DEFAULT
+    PROTOCOLS       = 0x02, ///< uint32 mask of the decoded protocols, bit n = IrProtocolId n (NEC includes NEC extended), default all
+    // 0x03 was the hold time of the HID keys, they follow the press and release of the key events now
+    LED_COLOR       = 0x04, ///< 3 bytes red, green, blue of the LED while a frame is received, default 0, 127, 0
+    KEY_REPEAT      = 0x05, ///< 4 uint16 of the key events (ms): repeat delay, repeat interval (0: every repeat code), minimum interval, acceleration per repeat, default 500, 0, 0, 0
+    GESTURES        = 0x06, ///< Up to 32 GestureEntry (24 bytes: id, step count, long step bits, max gap, hold time, 4 keys), default none
+    USB_PERSONALITY = 0x07, ///< uint8 UsbPersonality the device enumerates as, default VENDOR (the device re-enumerates when it is changed)
+};
+
+/// Interfaces the device presents to the host (ConfigKey::USB_PERSONALITY)
+enum class UsbPersonality : std::uint8_t
+{
+    VENDOR = 0, ///< Vendor, HID keyboard and event interface (F055:B195)
+    IR_TOY = 1, ///< CDC interface of the USB Infrared Toy v2 (04D8:FD08) in sample mode for the Linux kernel driver ir_toy, receive only
+};
+
+static_assert(sizeof(UsbTransmitCodeCommand) == 13, "unexpected padding");
+static_assert(sizeof(UsbTransmitRawCommand) == 8, "unexpected padding");
+static_assert(sizeof(UsbTransmitStatusReport) == 12, "unexpected padding");
+static_assert(sizeof(UsbLatencyReport) == 16, "unexpected padding");
+static_assert(sizeof(UsbHistogramReportHeader) == 4, "unexpected padding");
+static_assert(sizeof(UsbStatisticsReport) == 36, "unexpected padding");
+static_assert(sizeof(UsbTraceEntry) == 8, "unexpected padding");
+static_assert(sizeof(UsbClockReport) == 24, "unexpected padding");
+static_assert(sizeof(UsbFilterEntry) == 4, "unexpected padding");
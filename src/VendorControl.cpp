@@ -0,0 +1,19 @@
+#include "VendorControl.h"
+
+etl::array<VendorControl::Handler, static_cast<std::size_t>(VendorRequest::COUNT)> VendorControl::handlers_{};
+
+void VendorControl::registerHandler(VendorRequest request, Handler handler)
+{
+    handlers_[static_cast<std::size_t>(request)] = handler;
+}
+
+bool VendorControl::handle(std::uint8_t rhport, std::uint8_t stage, const tusb_control_request_t& request)
+{
+    if((request.bmRequestType_bit.type != TUSB_REQ_TYPE_VENDOR) || (request.bRequest >= handlers_.size()))
+    {
+        return false;
+    }
+
+    const Handler& handler{handlers_[request.bRequest]};
+    return handler.is_valid() ? handler(rhport, stage, request) : false;
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include <cstdint>
+#include "etl/array.h"
+#include "etl/delegate.h"
+#include "tusb.h"
+#include "UsbReport.h"
+
+/// Dispatches the vendor control requests to the modules handling them
+class VendorControl
+{
+public:
+    /// Same semantic as tud_vendor_control_xfer_cb: return false to stall the request
+    using Handler = etl::delegate<bool(std::uint8_t rhport, std::uint8_t stage, const tusb_control_request_t& request)>;
+
+    static void registerHandler(VendorRequest request, Handler handler);
+
+    /// Called from tud_vendor_control_xfer_cb for all requests not handled by the descriptor code
+    static bool handle(std::uint8_t rhport, std::uint8_t stage, const tusb_control_request_t& request);
+
+private:
+    static etl::array<Handler, static_cast<std::size_t>(VendorRequest::COUNT)> handlers_;
+};
@@ -66,14 +66,20 @@ extern "C" {
 #endif
 
 //------------- CLASS -------------//
-#define CFG_TUD_CDC               0
+#define CFG_TUD_CDC               1 // IR Toy personality
 #define CFG_TUD_MSC               0
-#define CFG_TUD_HID               0
+#define CFG_TUD_HID               1
 #define CFG_TUD_MIDI              0
 #define CFG_TUD_VENDOR            1
 
 #define CFG_TUD_VENDOR_RX_BUFSIZE 64
-#define CFG_TUD_VENDOR_TX_BUFSIZE 64
+#define CFG_TUD_VENDOR_TX_BUFSIZE 256 // several event reports per transfer
+
+#define CFG_TUD_HID_EP_BUFSIZE    16
+
+#define CFG_TUD_CDC_RX_BUFSIZE    64
+#define CFG_TUD_CDC_TX_BUFSIZE    64 // one packet, IrToySerial only writes to the empty FIFO
+#define CFG_TUD_CDC_EP_BUFSIZE    64
 
 #ifdef __cplusplus
 }
@@ -1,3 +1,5 @@
+import struct
+
 try:
     from winusbcdc import *
 except:
@@ -6,6 +8,70 @@ except:
 
 DEVICE_VID = 0xF055
 DEVICE_PID = 0xB195
+PROTOCOLS = ['NEC', 'NEC extended', 'Samsung', 'Sony', 'RC5', 'RC6']
+REPORT_EVENTS = 0x01
+REPORT_RAW = 0x02
+REPORT_HEADER = struct.Struct('<BBH')
+REPORT_ENTRY = struct.Struct('<HBBIIHBx')
+RAW_FIRST_IS_MARK = 0x01
+RAW_PULSES_LOST = 0x02
+MAX_REPORT_SIZE = 4 + 255 * 5  # RAW report with 255 durations of 5 bytes
+
+
+def decode_raw(data, offset):
+    """Returns the (mark, duration in us) pairs of the RAW report at offset and its size, None if it is incomplete"""
+    _, count, flags, _ = struct.unpack_from('<BBBB', data, offset)
+    mark = (flags & RAW_FIRST_IS_MARK) != 0
+    previous = [0, 0]
+    pulses = []
+    end = offset + 4
+    for _ in range(count):
+        value = 0
+        shift = 0
+        while True:
+            if end >= len(data):
+                return None
+            byte = data[end]
+            end += 1
+            value |= (byte & 0x7F) << shift
+            shift += 7
+            if byte & 0x80 == 0:
+                break
+        delta = (value >> 1) ^ -(value & 1)
+        previous[mark] = (previous[mark] + delta) & 0xFFFFFFFF
+        pulses.append((mark, previous[mark]))
+        mark = not mark
+    return pulses, end - offset
+
+
+def print_events(data, offset):
+    """Prints the EVENTS report at offset, returns its size or 0 if it is incomplete"""
+    global expectedSequence
+    _, count, dropped = REPORT_HEADER.unpack_from(data, offset)
+    size = REPORT_HEADER.size + count * REPORT_ENTRY.size
+    if len(data) - offset < size:
+        return 0
+    for i in range(count):
+        sequence, protocol, flags, timestamp, code, address, command = REPORT_ENTRY.unpack_from(data, offset + REPORT_HEADER.size + i * REPORT_ENTRY.size)
+        if expectedSequence is not None and sequence != expectedSequence:
+            print(f'Lost {(sequence - expectedSequence) & 0xFFFF} event(s), {dropped} dropped in total')
+        expectedSequence = (sequence + 1) & 0xFFFF
+        protocol = PROTOCOLS[protocol] if protocol < len(PROTOCOLS) else 'unknown'
+        print(f'[{timestamp / 1e6:10.6f}] Got IR signal: protocol: {protocol}, address: 0x{address:02X}, command: 0x{command:02X}, code: 0x{code:08X}, repeating: {(flags & 1) == 1}')
+    return size
+
+
+def print_raw(data, offset):
+    """Prints the RAW report at offset, returns its size or 0 if it is incomplete"""
+    raw = decode_raw(data, offset)
+    if raw is None:
+        return 0
+    pulses, size = raw
+    if data[offset + 2] & RAW_PULSES_LOST:
+        print('Lost raw pulses')
+    print(' '.join(f'{"+" if mark else "-"}{duration}' for mark, duration in pulses))
+    return size
+
 
 api = WinUsbPy()
 if api.list_usb_devices(deviceinterface=True, present=True):
@@ -19,13 +85,29 @@ if api.list_usb_devices(deviceinterface=True, present=True):
         api.flush(read_pipe)
 
         print('Device opened, waiting for packets...')
+        expectedSequence = None
+        stream = bytearray()  # received data not parsed yet, a read can hold several reports and end inside one
         while True:
-            ret = api.read(read_pipe, 64)
-            if ret:
-                if ret.raw[0] == 0x00:
-                    print(f'Got IR signal: address: 0x{ret.raw[1]:02X}, command: 0x{ret.raw[2]:02X}, repeating: {ret.raw[3] == 1}')
+            ret = api.read(read_pipe, 256)
+            if not ret:
+                continue
+            stream += ret.raw
+            offset = 0
+            while len(stream) - offset >= REPORT_HEADER.size:
+                if stream[offset] == REPORT_EVENTS:
+                    size = print_events(stream, offset)
+                elif stream[offset] == REPORT_RAW:
+                    size = print_raw(stream, offset)
                 else:
-                    print(f'Got unknown packet: {ret.raw}')
+                    print(f'Got unknown byte: 0x{stream[offset]:02X}')
+                    size = 1
+                if size == 0 and len(stream) - offset > MAX_REPORT_SIZE:  # cannot be completed anymore
+                    print(f'Got invalid report: 0x{stream[offset]:02X}')
+                    size = 1
+                if size == 0:  # the rest follows with the next read
+                    break
+                offset += size
+            del stream[:offset]
     else:
         print('Unable to open device')
 else: